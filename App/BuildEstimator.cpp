@@ -0,0 +1,134 @@
+#include <cmath>
+
+#include "Parallel.h"
+#include "BuildEstimator.h"
+
+using namespace slm;
+
+BuildEstimator::BuildEstimator() : mLayerAdditionTime(0.0),
+                                   mLayerCoolingTime(0.0),
+                                   mNumThreads(0)
+{
+}
+
+BuildEstimator::~BuildEstimator()
+{
+}
+
+LayerEstimate BuildEstimator::estimateLayer(const Layer &layer, const BuildStyleResolver &resolver) const
+{
+    LayerEstimate est;
+    est.layerId = layer.getLayerId();
+    est.z = layer.getZ();
+
+    const GeometryMetrics *prev = nullptr;
+
+    for(const LayerGeometry::Ptr &geom : layer.geometry()) {
+
+        const GeometryMetrics &gm = geom->metrics();
+
+        if(gm.numPoints == 0)
+            continue;
+
+        const BuildStyle *bstyle = resolver.resolve(*geom);
+
+        if(!bstyle) {
+            est.numUnresolved++;
+            prev = &gm;
+            continue;
+        }
+
+        const double power = bstyle->laserPower;
+
+        // Jumps within the geometry and from the end of the previous geometry
+        double jumpLength = gm.jumpLength;
+        uint64_t numJumps = 0;
+
+        switch(geom->getType()) {
+            case LayerGeometry::HATCH: numJumps = gm.numSegments > 0 ? gm.numSegments - 1 : 0; break;
+            case LayerGeometry::PNTS:  numJumps = gm.numPoints - 1; break;
+            default: break;
+        }
+
+        if(prev) {
+            const double dx = double(gm.start[0]) - double(prev->end[0]);
+            const double dy = double(gm.start[1]) - double(prev->end[1]);
+            jumpLength += std::sqrt(dx * dx + dy * dy);
+            numJumps++;
+        }
+
+        if(bstyle->jumpSpeed > 0)
+            est.jumpTime += jumpLength / double(bstyle->jumpSpeed);
+
+        est.jumpTime += double(numJumps) * double(bstyle->jumpDelay) * 1e-6;
+
+        const double exposureTime = double(bstyle->pointExposureTime) * 1e-6;
+        const double pointTime = exposureTime + double(bstyle->pointDelay) * 1e-6;
+
+        if(geom->getType() == LayerGeometry::PNTS) {
+
+            est.pointTime += double(gm.numPoints) * pointTime;
+            est.energy += double(gm.numPoints) * exposureTime * power;
+
+        } else if(bstyle->laserMode == LaserMode::PULSE) {
+
+            // Each vector is exposed at both ends and at every point distance along its length
+            const double numExposures = (bstyle->pointDistance > 0) ? std::floor(gm.pathLength * 1e3 / double(bstyle->pointDistance)) : 0.0;
+            const double total = numExposures + double(gm.numSegments);
+
+            est.scanTime += total * pointTime;
+            est.energy += total * exposureTime * power;
+
+        } else if(bstyle->laserSpeed > 0.f) {
+
+            const double scanTime = gm.pathLength / double(bstyle->laserSpeed);
+
+            est.scanTime += scanTime;
+            est.energy += scanTime * power;
+        }
+
+        prev = &gm;
+    }
+
+    return est;
+}
+
+BuildEstimate BuildEstimator::estimate(const std::vector<Layer::Ptr> &layers,
+                                       const std::vector<Model::Ptr> &models,
+                                       bool perLayer) const
+{
+    const BuildStyleResolver resolver(models);
+
+    std::vector<LayerEstimate> estimates(layers.size());
+
+    // Layers assigned to a LayerCache are estimated serially, as their expansion may evict other layers
+    parallelFor(layers.size(), [&](size_t i) {
+        if(!layers[i]->cache())
+            estimates[i] = estimateLayer(*layers[i], resolver);
+    }, mNumThreads);
+
+    for(size_t i = 0; i < layers.size(); i++) {
+        if(layers[i]->cache())
+            estimates[i] = estimateLayer(*layers[i], resolver);
+    }
+
+    BuildEstimate build;
+
+    for(size_t i = 0; i < estimates.size(); i++) {
+
+        LayerEstimate &est = estimates[i];
+        est.recoatTime = mLayerCoolingTime + (i > 0 ? mLayerAdditionTime : 0.0);
+
+        build.scanTime += est.scanTime;
+        build.jumpTime += est.jumpTime;
+        build.pointTime += est.pointTime;
+        build.recoatTime += est.recoatTime;
+        build.energy += est.energy;
+        build.numUnresolved += est.numUnresolved;
+    }
+
+    if(perLayer)
+        build.layers = std::move(estimates);
+
+    return build;
+}
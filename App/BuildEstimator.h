@@ -0,0 +1,104 @@
+#ifndef SLM_BUILDESTIMATOR_H_HEADER_HAS_BEEN_INCLUDED
+#define SLM_BUILDESTIMATOR_H_HEADER_HAS_BEEN_INCLUDED
+
+#include "SLM_Export.h"
+
+#include <cstdint>
+#include <vector>
+
+#include "BuildStyleResolver.h"
+#include "Layer.h"
+#include "Model.h"
+
+namespace slm
+{
+
+/**
+ * @brief Estimated times (s) and delivered energy (J) of a layer
+ */
+struct LayerEstimate
+{
+    uint64_t layerId       = 0;
+    uint64_t z             = 0;
+
+    double   scanTime      = 0.0;  // Scanning of hatch and contour vectors
+    double   jumpTime      = 0.0;  // Jumps, including the jump delays
+    double   pointTime     = 0.0;  // Exposure of point geometry, including the point delays
+    double   recoatTime    = 0.0;  // Layer addition and cooling time
+    double   energy        = 0.0;
+
+    uint64_t numUnresolved = 0;    // Geometry without a build style, which is excluded from the estimate
+
+    double totalTime() const { return scanTime + jumpTime + pointTime + recoatTime; }
+};
+
+/**
+ * @brief Estimated times (s) and delivered energy (J) of a build, summed over its layers
+ */
+struct BuildEstimate
+{
+    double   scanTime      = 0.0;
+    double   jumpTime      = 0.0;
+    double   pointTime     = 0.0;
+    double   recoatTime    = 0.0;
+    double   energy        = 0.0;
+
+    uint64_t numUnresolved = 0;
+
+    // Per-layer breakdown, in the order of the layers given
+    std::vector<LayerEstimate> layers;
+
+    double totalTime() const { return scanTime + jumpTime + pointTime + recoatTime; }
+};
+
+/**
+ * @brief The BuildEstimator class estimates the build time and the energy delivered by the laser, from the
+ * parameters of the build style of each geometry. Each layer is estimated in parallel from the cached metrics of
+ * its geometry (see LayerGeometry::metrics), hence the coordinates are traversed at most once.
+ *
+ * The parameters of a BuildStyle are interpreted in the following units: laser power (W), laser and jump speed
+ * (mm/s), point distance (um), and point exposure time, point delay and jump delay (us). Vectors are scanned
+ * continuously in CW mode, whilst in pulsed mode they are exposed at points spaced by the point distance. Jumps are
+ * taken between consecutive hatch vectors and points, and into each geometry after the first of the layer, using
+ * the build style of the geometry jumped to. The recoat time of each layer is the layer cooling time, plus the
+ * layer addition time for every layer except the first.
+ */
+class SLM_EXPORT BuildEstimator
+{
+public:
+
+    BuildEstimator();
+    ~BuildEstimator();
+
+public:
+
+    BuildEstimate estimate(const std::vector<Layer::Ptr> &layers,
+                           const std::vector<Model::Ptr> &models,
+                           bool perLayer = true) const;
+
+    /**
+     * Estimates a single layer, excluding its recoat time
+     */
+    LayerEstimate estimateLayer(const Layer &layer, const BuildStyleResolver &resolver) const;
+
+    /**
+     * Time (s) to deposit each layer of powder and to wait before scanning each layer
+     */
+    double layerAdditionTime() const { return mLayerAdditionTime; }
+    void setLayerAdditionTime(double val) { mLayerAdditionTime = val; }
+
+    double layerCoolingTime() const { return mLayerCoolingTime; }
+    void setLayerCoolingTime(double val) { mLayerCoolingTime = val; }
+
+    unsigned int numThreads() const { return mNumThreads; }
+    void setNumThreads(unsigned int val) { mNumThreads = val; }
+
+private:
+    double mLayerAdditionTime;
+    double mLayerCoolingTime;
+    unsigned int mNumThreads;
+};
+
+} // End of Namespace slm
+
+#endif // SLM_BUILDESTIMATOR_H_HEADER_HAS_BEEN_INCLUDED
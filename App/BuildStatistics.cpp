@@ -0,0 +1,73 @@
+#include <algorithm>
+
+#include "Parallel.h"
+#include "BuildStatistics.h"
+
+using namespace slm;
+
+BuildStatistics BuildStatistics::compute(const std::vector<Layer::Ptr> &layers,
+                                         unsigned int numThreads,
+                                         bool perLayer)
+{
+    BuildStatistics stats;
+
+    std::vector<const LayerMetrics *> metrics(layers.size(), nullptr);
+    std::vector<size_t> cachedLayers;
+
+    for(size_t i = 0; i < layers.size(); i++) {
+        if(layers[i]->cache())
+            cachedLayers.push_back(i);
+    }
+
+    parallelFor(layers.size(), [&](size_t i) {
+        if(!layers[i]->cache())
+            metrics[i] = &layers[i]->metrics();
+    }, numThreads);
+
+    for(size_t i : cachedLayers)
+        metrics[i] = &layers[i]->metrics();
+
+    // Reduction of the cached layer metrics
+    if(perLayer)
+        stats.layers.reserve(layers.size());
+
+    for(size_t i = 0; i < layers.size(); i++) {
+
+        const Layer &layer = *layers[i];
+        const LayerMetrics &lm = *metrics[i];
+
+        if(i == 0) {
+            stats.zMin = stats.zMax = layer.getZ();
+        } else {
+            stats.zMin = std::min(stats.zMin, layer.getZ());
+            stats.zMax = std::max(stats.zMax, layer.getZ());
+        }
+
+        stats.numHatchGeoms += lm.numHatchGeoms;
+        stats.numContourGeoms += lm.numContourGeoms;
+        stats.numPntsGeoms += lm.numPntsGeoms;
+        stats.numPoints += lm.numPoints;
+        stats.numSegments += lm.numSegments;
+        stats.pathLength += lm.pathLength;
+        stats.jumpLength += lm.jumpLength;
+
+        if(lm.numPoints > 0) {
+            stats.bbox[0] = std::min(stats.bbox[0], lm.bbox[0]);
+            stats.bbox[1] = std::max(stats.bbox[1], lm.bbox[1]);
+            stats.bbox[2] = std::min(stats.bbox[2], lm.bbox[2]);
+            stats.bbox[3] = std::max(stats.bbox[3], lm.bbox[3]);
+        }
+
+        if(perLayer) {
+            LayerStatistics layerStats;
+            layerStats.layerId = layer.getLayerId();
+            layerStats.z = layer.getZ();
+            layerStats.metrics = lm;
+            stats.layers.push_back(layerStats);
+        }
+    }
+
+    stats.numLayers = layers.size();
+
+    return stats;
+}
@@ -0,0 +1,54 @@
+#ifndef SLM_BUILDSTATISTICS_H_HEADER_HAS_BEEN_INCLUDED
+#define SLM_BUILDSTATISTICS_H_HEADER_HAS_BEEN_INCLUDED
+
+#include "SLM_Export.h"
+
+#include <cstdint>
+#include <vector>
+
+#include "Layer.h"
+
+namespace slm
+{
+
+struct LayerStatistics
+{
+    uint64_t     layerId;
+    uint64_t     z;
+    LayerMetrics metrics;
+};
+
+/**
+ * @brief The BuildStatistics struct summarises a build in a single parallel pass over its layers. Each layer's
+ * metrics (see Layer::metrics) are computed concurrently, which remain cached within the layers, and are then
+ * reduced to the totals of the build. The bounding box is ordered (minX, maxX, minY, maxY). Layers assigned to a
+ * LayerCache are processed serially, as their expansion may evict other layers.
+ */
+struct SLM_EXPORT BuildStatistics
+{
+    uint64_t numLayers       = 0;
+    uint64_t numHatchGeoms   = 0;
+    uint64_t numContourGeoms = 0;
+    uint64_t numPntsGeoms    = 0;
+    uint64_t numPoints       = 0;
+    uint64_t numSegments     = 0;
+
+    double   pathLength      = 0.0;
+    double   jumpLength      = 0.0;
+
+    float    bbox[4]         = {1e9f, -1e9f, 1e9f, -1e9f};
+
+    uint64_t zMin            = 0;
+    uint64_t zMax            = 0;
+
+    // Per-layer breakdown, in the order of the layers given
+    std::vector<LayerStatistics> layers;
+
+    static BuildStatistics compute(const std::vector<Layer::Ptr> &layers,
+                                   unsigned int numThreads = 0,
+                                   bool perLayer = true);
+};
+
+} // End of Namespace slm
+
+#endif // SLM_BUILDSTATISTICS_H_HEADER_HAS_BEEN_INCLUDED
@@ -0,0 +1,104 @@
+#include "BuildStyleResolver.h"
+
+using namespace slm;
+
+BuildStyleResolver::BuildStyleResolver() : mMask(0)
+{
+}
+
+BuildStyleResolver::BuildStyleResolver(const std::vector<Model::Ptr> &models) : mMask(0)
+{
+    build(models);
+}
+
+BuildStyleResolver::~BuildStyleResolver()
+{
+}
+
+void BuildStyleResolver::clear()
+{
+    mSlots.clear();
+    mStyles.clear();
+    mMask = 0;
+}
+
+uint64_t BuildStyleResolver::hash(uint64_t mid, uint64_t bid)
+{
+    // Fibonacci hashing of the combined ids, mixed down so that the low bits select the slot
+    uint64_t h = (mid * 0x9E3779B97F4A7C15ull) ^ (bid + 0x632BE59BD9B4E019ull);
+    h *= 0xBF58476D1CE4E5B9ull;
+    return h ^ (h >> 31);
+}
+
+void BuildStyleResolver::build(const std::vector<Model::Ptr> &models)
+{
+    clear();
+
+    size_t numStyles = 0;
+
+    for(const Model::Ptr &model : models) {
+        if(model)
+            numStyles += model->getBuildStyles().size();
+    }
+
+    size_t capacity = 16;
+
+    while(capacity < 2 * numStyles)
+        capacity *= 2;
+
+    Slot empty;
+    empty.mid = 0;
+    empty.bid = 0;
+    empty.style = nullptr;
+
+    mSlots.assign(capacity, empty);
+    mStyles.reserve(numStyles);
+    mMask = capacity - 1;
+
+    for(const Model::Ptr &model : models) {
+
+        if(!model)
+            continue;
+
+        const uint64_t mid = model->getId();
+
+        for(const BuildStyle::Ptr &bstyle : model->getBuildStyles()) {
+
+            if(!bstyle)
+                continue;
+
+            uint64_t pos = hash(mid, bstyle->id) & mMask;
+
+            while(mSlots[pos].style && !(mSlots[pos].mid == mid && mSlots[pos].bid == bstyle->id))
+                pos = (pos + 1) & mMask;
+
+            // Consistent with Model::getBuildStyleById, the first model and build style with the ids takes precedence
+            if(mSlots[pos].style)
+                continue;
+
+            mSlots[pos].mid = mid;
+            mSlots[pos].bid = bstyle->id;
+            mSlots[pos].style = bstyle.get();
+
+            mStyles.push_back(bstyle);
+        }
+    }
+}
+
+const BuildStyle * BuildStyleResolver::resolve(uint64_t mid, uint64_t bid) const
+{
+    if(mSlots.empty())
+        return nullptr;
+
+    uint64_t pos = hash(mid, bid) & mMask;
+
+    while(mSlots[pos].style) {
+
+        if(mSlots[pos].mid == mid && mSlots[pos].bid == bid)
+            return mSlots[pos].style;
+
+        pos = (pos + 1) & mMask;
+    }
+
+    return nullptr;
+}
@@ -0,0 +1,60 @@
+#ifndef SLM_BUILDSTYLERESOLVER_H_HEADER_HAS_BEEN_INCLUDED
+#define SLM_BUILDSTYLERESOLVER_H_HEADER_HAS_BEEN_INCLUDED
+
+#include "SLM_Export.h"
+
+#include <cstdint>
+#include <vector>
+
+#include "Layer.h"
+#include "Model.h"
+
+namespace slm
+{
+
+/**
+ * @brief The BuildStyleResolver class resolves the (model id, build style id) pair of a geometry to its BuildStyle
+ * in constant time. It is built once from a list of models into a flat open-addressed hash table, so that passes
+ * over every geometry of a build (e.g. build time or energy estimates) avoid searching the models and their build
+ * styles. The resolver holds references to the build styles, but must be rebuilt if the models are changed.
+ */
+class SLM_EXPORT BuildStyleResolver
+{
+public:
+
+    BuildStyleResolver();
+    explicit BuildStyleResolver(const std::vector<Model::Ptr> &models);
+    ~BuildStyleResolver();
+
+public:
+
+    void build(const std::vector<Model::Ptr> &models);
+    void clear();
+
+    /**
+     * Returns the build style or a nullptr if the pair of ids cannot be resolved
+     */
+    const BuildStyle * resolve(uint64_t mid, uint64_t bid) const;
+    const BuildStyle * resolve(const LayerGeometry &geom) const { return resolve(geom.mid, geom.bid); }
+
+    size_t size() const { return mStyles.size(); }
+
+private:
+
+    struct Slot
+    {
+        uint64_t mid;
+        uint64_t bid;
+        const BuildStyle *style; // Empty slots are a nullptr
+    };
+
+    static uint64_t hash(uint64_t mid, uint64_t bid);
+
+    std::vector<Slot> mSlots; // Power of two capacity, at most half occupied
+    std::vector<BuildStyle::Ptr> mStyles;
+    uint64_t mMask;
+};
+
+} // End of Namespace slm
+
+#endif // SLM_BUILDSTYLERESOLVER_H_HEADER_HAS_BEEN_INCLUDED
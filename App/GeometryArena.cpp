@@ -0,0 +1,67 @@
+#include <cassert>
+#include <iostream>
+
+#include "GeometryArena.h"
+
+using namespace slm;
+
+GeometryArena::GeometryArena() : mSealed(false)
+{
+}
+
+GeometryArena::~GeometryArena()
+{
+}
+
+void GeometryArena::clear()
+{
+    mCoords.clear();
+    mEntries.clear();
+    mSealed = false;
+}
+
+void GeometryArena::reserve(size_t numGeoms, size_t numPoints)
+{
+    mEntries.reserve(numGeoms);
+    mCoords.reserve(2 * numPoints);
+}
+
+float * GeometryArena::addGeometry(LayerGeometry::TYPE type, uint32_t mid, uint32_t bid, uint32_t numPoints)
+{
+    if(mSealed) {
+        std::cerr << "Cannot add geometry to a sealed geometry arena" << std::endl;
+        return nullptr;
+    }
+
+    Entry entry;
+    entry.offset = mCoords.size();
+    entry.numPoints = numPoints;
+    entry.mid = mid;
+    entry.bid = bid;
+    entry.type = type;
+
+    mEntries.push_back(entry);
+    mCoords.resize(mCoords.size() + 2 * numPoints);
+
+    return mCoords.data() + entry.offset;
+}
+
+int64_t GeometryArena::addGeometry(LayerGeometry::TYPE type, uint32_t mid, uint32_t bid, const Eigen::Ref<const Eigen::MatrixXf> &coords)
+{
+    assert(coords.cols() == 2);
+
+    float *block = this->addGeometry(type, mid, bid, coords.rows());
+
+    if(!block)
+        return -1;
+
+    Eigen::Map<Eigen::MatrixXf>(block, coords.rows(), 2) = coords;
+
+    return mEntries.size() - 1;
+}
+
+Eigen::Map<const Eigen::MatrixXf> GeometryArena::coords(size_t idx) const
+{
+    const Entry &entry = mEntries[idx];
+    return Eigen::Map<const Eigen::MatrixXf>(mCoords.data() + entry.offset, entry.numPoints, 2);
+}
@@ -0,0 +1,84 @@
+#ifndef SLM_GEOMETRYARENA_H_HEADER_HAS_BEEN_INCLUDED
+#define SLM_GEOMETRYARENA_H_HEADER_HAS_BEEN_INCLUDED
+
+#include "SLM_Export.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <Eigen/Dense>
+
+#include "Layer.h"
+
+namespace slm
+{
+
+/**
+ * @brief The GeometryArena class stores the coordinates of all geometries within a layer in a single contiguous
+ * float buffer, alongside a side table describing each geometry (offset, number of points, type, model and build style).
+ * Each geometry occupies a column-major (N x 2) block so that it may be mapped directly by Eigen. Once adopted by a
+ * Layer using Layer::setGeometryArena, the arena is sealed and the LayerGeometry objects become views into the buffer.
+ */
+class SLM_EXPORT GeometryArena
+{
+public:
+
+    typedef std::shared_ptr<GeometryArena> Ptr;
+
+    struct Entry
+    {
+        uint64_t offset;    // Offset of the geometry within the coordinate buffer (floats)
+        uint32_t numPoints; // Number of points (rows) in the geometry
+        uint32_t mid;
+        uint32_t bid;
+        LayerGeometry::TYPE type;
+    };
+
+    GeometryArena();
+    ~GeometryArena();
+
+public:
+
+    void clear();
+    void reserve(size_t numGeoms, size_t numPoints);
+
+    /**
+     * Appends a geometry to the arena and returns a pointer to its uninitialised (N x 2) column-major coordinate
+     * block, which the caller fills directly. The pointer is only valid until the next geometry is added.
+     */
+    float * addGeometry(LayerGeometry::TYPE type, uint32_t mid, uint32_t bid, uint32_t numPoints);
+
+    /**
+     * Appends a geometry to the arena by copying an existing coordinate matrix. Returns the entry index.
+     */
+    int64_t addGeometry(LayerGeometry::TYPE type, uint32_t mid, uint32_t bid, const Eigen::Ref<const Eigen::MatrixXf> &coords);
+
+    /**
+     * Getters
+     */
+    size_t size() const { return mEntries.size(); }
+    size_t numPoints() const { return mCoords.size() / 2; }
+    bool isSealed() const { return mSealed; }
+
+    const Entry & entry(size_t idx) const { return mEntries[idx]; }
+    const std::vector<Entry> & entries() const { return mEntries; }
+
+    float * data() { return mCoords.data(); }
+    const float * data() const { return mCoords.data(); }
+
+    Eigen::Map<const Eigen::MatrixXf> coords(size_t idx) const;
+
+protected:
+    friend class Layer;
+    void seal() { mSealed = true; }
+
+private:
+    std::vector<float> mCoords;
+    std::vector<Entry> mEntries;
+    bool mSealed;
+};
+
+} // End of Namespace slm
+
+#endif // SLM_GEOMETRYARENA_H_HEADER_HAS_BEEN_INCLUDED
@@ -0,0 +1,212 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "GeometryKernels.h"
+
+/*
+ * Function multi-versioning generates AVX-512 and AVX2 clones of each kernel, which are dispatched on first use
+ * via the ifunc mechanism. The kernels are written as independent lanes and fixed size blocks, so that they are
+ * vectorized without relaxing floating point semantics. This file is compiled with -fno-math-errno (see
+ * CMakeLists.txt), as otherwise std::sqrt remains a scalar call which may set errno.
+ */
+#if defined(__x86_64__) && defined(__linux__) && \
+    ((defined(__clang__) && __clang_major__ >= 14) || (!defined(__clang__) && defined(__GNUC__) && __GNUC__ >= 6))
+#define SLM_KERNEL __attribute__((target_clones("avx512f", "avx2", "default")))
+#else
+#define SLM_KERNEL
+#endif
+
+namespace slm
+{
+
+namespace kernels
+{
+
+namespace {
+
+const size_t Lanes = 16;
+const size_t BlockSize = 256;
+
+struct LaneSum
+{
+    double lane[Lanes] = {};
+
+    inline void add(const float *vals, size_t n)
+    {
+        size_t i = 0;
+
+        for(; i + Lanes <= n; i += Lanes) {
+            for(size_t j = 0; j < Lanes; j++)
+                lane[j] += vals[i + j];
+        }
+
+        for(; i < n; i++)
+            lane[0] += vals[i];
+    }
+
+    inline double total() const
+    {
+        double sum = 0.0;
+
+        for(size_t j = 0; j < Lanes; j++)
+            sum += lane[j];
+
+        return sum;
+    }
+};
+
+} // End of anonymous namespace
+
+SLM_KERNEL
+void hatchLengths(const float *x, const float *y, size_t numPoints, float *lengths)
+{
+    const size_t numHatches = numPoints / 2;
+
+    for(size_t i = 0; i < numHatches; i++) {
+        const float dx = x[2 * i + 1] - x[2 * i];
+        const float dy = y[2 * i + 1] - y[2 * i];
+        lengths[i] = std::sqrt(dx * dx + dy * dy);
+    }
+}
+
+SLM_KERNEL
+double hatchLength(const float *x, const float *y, size_t numPoints)
+{
+    const size_t numHatches = numPoints / 2;
+
+    float block[BlockSize];
+    LaneSum sum;
+
+    for(size_t start = 0; start < numHatches; start += BlockSize) {
+
+        const size_t n = std::min(BlockSize, numHatches - start);
+        const float *bx = x + 2 * start;
+        const float *by = y + 2 * start;
+
+        for(size_t i = 0; i < n; i++) {
+            const float dx = bx[2 * i + 1] - bx[2 * i];
+            const float dy = by[2 * i + 1] - by[2 * i];
+            block[i] = std::sqrt(dx * dx + dy * dy);
+        }
+
+        sum.add(block, n);
+    }
+
+    return sum.total();
+}
+
+SLM_KERNEL
+double polylineLength(const float *x, const float *y, size_t numPoints)
+{
+    if(numPoints < 2)
+        return 0.0;
+
+    const size_t numSegments = numPoints - 1;
+
+    float block[BlockSize];
+    LaneSum sum;
+
+    for(size_t start = 0; start < numSegments; start += BlockSize) {
+
+        const size_t n = std::min(BlockSize, numSegments - start);
+        const float *bx = x + start;
+        const float *by = y + start;
+
+        for(size_t i = 0; i < n; i++) {
+            const float dx = bx[i + 1] - bx[i];
+            const float dy = by[i + 1] - by[i];
+            block[i] = std::sqrt(dx * dx + dy * dy);
+        }
+
+        sum.add(block, n);
+    }
+
+    return sum.total();
+}
+
+SLM_KERNEL
+void boundingBox(const float *x, const float *y, size_t numPoints, float *bbox)
+{
+    float minX[Lanes], maxX[Lanes], minY[Lanes], maxY[Lanes];
+
+    for(size_t j = 0; j < Lanes; j++) {
+        minX[j] = minY[j] =  std::numeric_limits<float>::max();
+        maxX[j] = maxY[j] = -std::numeric_limits<float>::max();
+    }
+
+    size_t i = 0;
+
+    for(; i + Lanes <= numPoints; i += Lanes) {
+        for(size_t j = 0; j < Lanes; j++) {
+            minX[j] = x[i + j] < minX[j] ? x[i + j] : minX[j];
+            maxX[j] = x[i + j] > maxX[j] ? x[i + j] : maxX[j];
+            minY[j] = y[i + j] < minY[j] ? y[i + j] : minY[j];
+            maxY[j] = y[i + j] > maxY[j] ? y[i + j] : maxY[j];
+        }
+    }
+
+    for(; i < numPoints; i++) {
+        minX[0] = std::min(minX[0], x[i]);
+        maxX[0] = std::max(maxX[0], x[i]);
+        minY[0] = std::min(minY[0], y[i]);
+        maxY[0] = std::max(maxY[0], y[i]);
+    }
+
+    bbox[0] = *std::min_element(minX, minX + Lanes);
+    bbox[1] = *std::max_element(maxX, maxX + Lanes);
+    bbox[2] = *std::min_element(minY, minY + Lanes);
+    bbox[3] = *std::max_element(maxY, maxY + Lanes);
+}
+
+SLM_KERNEL
+void centroid(const float *x, const float *y, size_t numPoints, float *pos)
+{
+    if(numPoints == 0) {
+        pos[0] = pos[1] = 0.f;
+        return;
+    }
+
+    LaneSum sumX, sumY;
+    sumX.add(x, numPoints);
+    sumY.add(y, numPoints);
+
+    pos[0] = float(sumX.total() / double(numPoints));
+    pos[1] = float(sumY.total() / double(numPoints));
+}
+
+SLM_KERNEL
+void transform(const float *x, const float *y, size_t numPoints, const float *m, float *xOut, float *yOut)
+{
+    const float m0 = m[0], m1 = m[1], m2 = m[2];
+    const float m3 = m[3], m4 = m[4], m5 = m[5];
+
+    for(size_t i = 0; i < numPoints; i++) {
+        const float px = x[i];
+        const float py = y[i];
+
+        xOut[i] = m0 * px + m1 * py + m2;
+        yOut[i] = m3 * px + m4 * py + m5;
+    }
+}
+
+SLM_KERNEL
+size_t pointsInBox(const float *x, const float *y, size_t numPoints, const float *bbox, uint8_t *mask)
+{
+    const float minX = bbox[0], maxX = bbox[1];
+    const float minY = bbox[2], maxY = bbox[3];
+
+    size_t count = 0;
+
+    for(size_t i = 0; i < numPoints; i++) {
+        const uint8_t inside = uint8_t((x[i] >= minX) & (x[i] <= maxX) & (y[i] >= minY) & (y[i] <= maxY));
+        mask[i] = inside;
+        count += inside;
+    }
+
+    return count;
+}
+
+} // End of Namespace kernels
+
+} // End of Namespace slm
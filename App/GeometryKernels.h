@@ -0,0 +1,62 @@
+#ifndef SLM_GEOMETRYKERNELS_H_HEADER_HAS_BEEN_INCLUDED
+#define SLM_GEOMETRYKERNELS_H_HEADER_HAS_BEEN_INCLUDED
+
+#include "SLM_Export.h"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace slm
+{
+
+/**
+ * Vectorized kernels over contiguous x and y coordinate arrays of numPoints points, matching the column-major
+ * layout of LayerGeometry::coords (i.e. x = coords.data() and y = coords.data() + coords.rows()). Lengths are
+ * accumulated in double precision across independent lanes. On x86-64 platforms supporting function
+ * multi-versioning, AVX-512 and AVX2 versions are selected at runtime, with a portable version otherwise.
+ */
+namespace kernels
+{
+
+/**
+ * Lengths of the hatch vectors formed by consecutive pairs of points. lengths must hold numPoints / 2 values.
+ */
+SLM_EXPORT void hatchLengths(const float *x, const float *y, size_t numPoints, float *lengths);
+
+/**
+ * Total length of the hatch vectors formed by consecutive pairs of points
+ */
+SLM_EXPORT double hatchLength(const float *x, const float *y, size_t numPoints);
+
+/**
+ * Total length of the polyline passing through the points in order
+ */
+SLM_EXPORT double polylineLength(const float *x, const float *y, size_t numPoints);
+
+/**
+ * Bounding box ordered as (minX, maxX, minY, maxY). An empty set of points gives an inverted box.
+ */
+SLM_EXPORT void boundingBox(const float *x, const float *y, size_t numPoints, float *bbox);
+
+/**
+ * Mean position of the points
+ */
+SLM_EXPORT void centroid(const float *x, const float *y, size_t numPoints, float *pos);
+
+/**
+ * Applies the affine transform (x', y') = (m[0] x + m[1] y + m[2], m[3] x + m[4] y + m[5]). The output arrays may
+ * be the same as the input arrays.
+ */
+SLM_EXPORT void transform(const float *x, const float *y, size_t numPoints, const float *m, float *xOut, float *yOut);
+
+/**
+ * Sets mask[i] to one for points within the closed box (minX, maxX, minY, maxY), or zero otherwise. Returns the
+ * number of points within the box.
+ */
+SLM_EXPORT size_t pointsInBox(const float *x, const float *y, size_t numPoints, const float *bbox, uint8_t *mask);
+
+} // End of Namespace kernels
+
+} // End of Namespace slm
+
+#endif // SLM_GEOMETRYKERNELS_H_HEADER_HAS_BEEN_INCLUDED
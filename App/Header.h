@@ -8,6 +8,23 @@ namespace slm {
 
 // Forward declaration
 
+/**
+ * @brief Quantization describes the mapping between integer machine coordinates and floating point coordinates,
+ * i.e. x = offsetX + scale * qx. This is analogous to the zUnit used for layer positions.
+ */
+struct Quantization
+{
+    double scale   = 1.0;
+    double offsetX = 0.0;
+    double offsetY = 0.0;
+
+    bool operator==(const Quantization &other) const {
+        return scale == other.scale && offsetX == other.offsetX && offsetY == other.offsetY;
+    }
+
+    bool operator!=(const Quantization &other) const { return !(*this == other); }
+};
+
 struct Header
 {
     std::string fileName;
@@ -19,6 +36,9 @@ struct Header
     int vMajor;
     int vMinor;
     int zUnit;
+
+    // Quantization of the integer (x,y) coordinates used by the build
+    Quantization quantization;
 };
 
 } //SLM_HEADER_H_HEADER_HAS_BEEN_INCLUDED
@@ -0,0 +1,135 @@
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define SLM_POSIX_IO
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "InputBuffer.h"
+
+using namespace slm;
+
+InputBuffer::InputBuffer() : mData(nullptr),
+                             mSize(0),
+                             mIsOpen(false)
+{
+}
+
+InputBuffer::~InputBuffer()
+{
+    close();
+}
+
+int InputBuffer::open(const std::string &path, MappedFile::Advice advice, bool allowMapping)
+{
+    close();
+
+    if(allowMapping && MappedFile::isSupported() && mMapping.mapForRead(path, advice) == 0) {
+        mData = mMapping.constData();
+        mSize = mMapping.size();
+        mIsOpen = true;
+        return 0;
+    }
+
+    // The file is otherwise read into memory
+    if(readFile(path) != 0)
+        return -1;
+
+    mData = mBuffer.data();
+    mSize = mBuffer.size();
+    mIsOpen = true;
+
+    return 0;
+}
+
+void InputBuffer::close()
+{
+    mMapping.close();
+
+    std::vector<uint8_t>().swap(mBuffer);
+    mData = nullptr;
+    mSize = 0;
+    mIsOpen = false;
+}
+
+int InputBuffer::advise(MappedFile::Advice advice, uint64_t offset, uint64_t size)
+{
+    if(!mMapping.isOpen())
+        return -1;
+
+    return mMapping.advise(advice, offset, size);
+}
+
+int InputBuffer::readFile(const std::string &path)
+{
+#ifdef SLM_POSIX_IO
+    const int fd = ::open(path.c_str(), O_RDONLY);
+
+    if(fd < 0) {
+        std::cerr << "File '" << path << "' could not be open for reading - " << std::strerror(errno) << std::endl;
+        return -1;
+    }
+
+    struct stat info;
+
+    if(fstat(fd, &info) != 0) {
+        std::cerr << "Cannot read the size of file '" << path << "' - " << std::strerror(errno) << std::endl;
+        ::close(fd);
+        return -1;
+    }
+
+    mBuffer.resize(size_t(info.st_size));
+
+    size_t pos = 0;
+
+    while(pos < mBuffer.size()) {
+        const ssize_t num = ::read(fd, mBuffer.data() + pos, mBuffer.size() - pos);
+
+        if(num < 0 && errno == EINTR)
+            continue;
+
+        if(num <= 0) {
+            std::cerr << "Cannot read file '" << path << "'" << std::endl;
+            ::close(fd);
+            return -1;
+        }
+
+        pos += size_t(num);
+    }
+
+    ::close(fd);
+#else
+    FILE *file = std::fopen(path.c_str(), "rb");
+
+    if(!file) {
+        std::cerr << "File '" << path << "' could not be open for reading" << std::endl;
+        return -1;
+    }
+
+    // Read in blocks, as the size of the file may not fit within a long
+    const size_t blockSize = 1 << 20;
+    size_t num = 0;
+
+    do {
+        const size_t pos = mBuffer.size();
+        mBuffer.resize(pos + blockSize);
+        num = std::fread(mBuffer.data() + pos, 1, blockSize, file);
+        mBuffer.resize(pos + num);
+    } while(num == blockSize);
+
+    const bool failed = std::ferror(file) != 0;
+    std::fclose(file);
+
+    if(failed) {
+        std::cerr << "Cannot read file '" << path << "'" << std::endl;
+        return -1;
+    }
+#endif
+
+    return 0;
+}
@@ -0,0 +1,201 @@
+#ifndef SLM_INPUTBUFFER_H_HEADER_HAS_BEEN_INCLUDED
+#define SLM_INPUTBUFFER_H_HEADER_HAS_BEEN_INCLUDED
+
+#include "SLM_Export.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "MappedFile.h"
+
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+#define SLM_BIG_ENDIAN_HOST
+#endif
+
+namespace slm
+{
+
+/**
+ * @brief The ByteSpan class is a non-owning view of a contiguous range of bytes (e.g. within an InputBuffer).
+ * Access is bounds-checked, and values are decoded from little-endian byte order irrespective of their alignment.
+ */
+class SLM_EXPORT ByteSpan
+{
+public:
+
+    ByteSpan() : mData(nullptr), mSize(0) {}
+    ByteSpan(const uint8_t *data, size_t size) : mData(data), mSize(size) {}
+
+public:
+
+    const uint8_t * data() const { return mData; }
+    size_t size() const { return mSize; }
+    bool empty() const { return mSize == 0; }
+
+    bool contains(uint64_t offset, uint64_t size) const { return offset <= mSize && size <= mSize - offset; }
+
+    /**
+     * Returns the range [offset, offset + size), or an empty span if it lies outside of this span
+     */
+    ByteSpan subspan(uint64_t offset, uint64_t size) const
+    {
+        return contains(offset, size) ? ByteSpan(mData + offset, size_t(size)) : ByteSpan();
+    }
+
+    /**
+     * Decodes a little-endian value at the offset. Returns zero or -1 if the value lies outside of the span.
+     */
+    template <class T>
+    int read(uint64_t offset, T &val) const
+    {
+        static_assert(std::is_arithmetic<T>::value, "Only arithmetic values may be decoded");
+
+        if(!contains(offset, sizeof(T)))
+            return -1;
+
+        val = decode<T>(mData + offset);
+        return 0;
+    }
+
+    /**
+     * Decodes a little-endian value, which the caller has checked lies within the span (see contains)
+     */
+    template <class T>
+    static T decode(const uint8_t *src)
+    {
+        T val;
+
+#ifdef SLM_BIG_ENDIAN_HOST
+        uint8_t bytes[sizeof(T)];
+        std::reverse_copy(src, src + sizeof(T), bytes);
+        std::memcpy(&val, bytes, sizeof(T));
+#else
+        std::memcpy(&val, src, sizeof(T));
+#endif
+        return val;
+    }
+
+private:
+    const uint8_t *mData;
+    size_t mSize;
+};
+
+/**
+ * @brief The ByteCursor class decodes values sequentially from a ByteSpan. Reading beyond the end of the span
+ * fails and leaves the position unchanged.
+ */
+class SLM_EXPORT ByteCursor
+{
+public:
+
+    ByteCursor() : mPos(0) {}
+    explicit ByteCursor(const ByteSpan &span, uint64_t pos = 0) : mSpan(span), mPos(pos) {}
+
+public:
+
+    template <class T>
+    int read(T &val)
+    {
+        if(mSpan.read(mPos, val) != 0)
+            return -1;
+
+        mPos += sizeof(T);
+        return 0;
+    }
+
+    /**
+     * Returns the next size bytes without copying, or an empty span if fewer remain
+     */
+    ByteSpan take(uint64_t size)
+    {
+        if(!mSpan.contains(mPos, size))
+            return ByteSpan();
+
+        const ByteSpan span = mSpan.subspan(mPos, size);
+        mPos += size;
+        return span;
+    }
+
+    int skip(uint64_t size)
+    {
+        if(!mSpan.contains(mPos, size))
+            return -1;
+
+        mPos += size;
+        return 0;
+    }
+
+    int seek(uint64_t pos)
+    {
+        if(pos > mSpan.size())
+            return -1;
+
+        mPos = pos;
+        return 0;
+    }
+
+    uint64_t position() const { return mPos; }
+    uint64_t remaining() const { return mSpan.size() - mPos; }
+    const ByteSpan & span() const { return mSpan; }
+
+private:
+    ByteSpan mSpan;
+    uint64_t mPos;
+};
+
+/**
+ * @brief The InputBuffer class provides the contents of a file as a contiguous range of bytes, so that translators
+ * may decode directly from it without copying through stream buffers. The file is memory mapped where supported,
+ * with the access pattern advised to the kernel, otherwise, or if mapping is disabled, the file is read into memory
+ * in its entirety.
+ */
+class SLM_EXPORT InputBuffer
+{
+public:
+
+    InputBuffer();
+    ~InputBuffer();
+
+    InputBuffer(const InputBuffer &) = delete;
+    InputBuffer & operator=(const InputBuffer &) = delete;
+
+public:
+
+    int open(const std::string &path, MappedFile::Advice advice = MappedFile::SEQUENTIAL, bool allowMapping = true);
+    void close();
+
+    bool isOpen() const { return mIsOpen; }
+    bool isMapped() const { return mMapping.isOpen(); }
+
+    const uint8_t * data() const { return mData; }
+    uint64_t size() const { return mSize; }
+
+    ByteSpan span() const { return ByteSpan(mData, size_t(mSize)); }
+    ByteSpan span(uint64_t offset, uint64_t size) const { return span().subspan(offset, size); }
+
+    template <class T>
+    int read(uint64_t offset, T &val) const { return span().read(offset, val); }
+
+    /**
+     * Advises the access pattern of a region of the file. This has no effect unless the file is mapped.
+     */
+    int advise(MappedFile::Advice advice, uint64_t offset, uint64_t size);
+
+private:
+    int readFile(const std::string &path);
+
+    MappedFile mMapping;
+    std::vector<uint8_t> mBuffer;
+
+    const uint8_t *mData;
+    uint64_t mSize;
+    bool mIsOpen;
+};
+
+} // End of Namespace slm
+
+#endif // SLM_INPUTBUFFER_H_HEADER_HAS_BEEN_INCLUDED
@@ -0,0 +1,278 @@
+#include <cstring>
+#include <unordered_map>
+
+#include "Instancing.h"
+
+namespace slm
+{
+
+namespace {
+
+/*
+ * The payload of a geometry is its coordinates relative to its first point, rotated by the quarter turns which
+ * bring its first segment into the canonical quadrant (x > 0, y >= 0), so that copies of a part rotated by a
+ * multiple of a quarter turn share the payload. Quarter turns only swap and negate coordinates, hence are exact.
+ */
+struct Placement
+{
+    Eigen::Vector2f origin;
+    int turns;
+};
+
+struct Candidate
+{
+    LayerGeometry::Payload payload;         // Created once a duplicate is found, or the first geometry is evicted
+    std::weak_ptr<LayerGeometry> first;     // First geometry with the payload, folded once a duplicate is found
+    Layer *firstLayer;
+    Placement firstPlacement;
+    bool isShared;
+};
+
+inline Eigen::Vector2f rotateQuarterTurns(const Eigen::Vector2f &pnt, int turns)
+{
+    switch(turns) {
+        case 1:  return Eigen::Vector2f(-pnt.y(), pnt.x());
+        case 2:  return Eigen::Vector2f(-pnt.x(), -pnt.y());
+        case 3:  return Eigen::Vector2f(pnt.y(), -pnt.x());
+        default: return pnt;
+    }
+}
+
+inline Eigen::Vector2f payloadPoint(const LayerGeometry::ConstCoordsMap &coords, Eigen::Index row,
+                                    const Placement &placement)
+{
+    return rotateQuarterTurns(coords.row(row).transpose() - placement.origin, placement.turns);
+}
+
+Placement canonicalPlacement(const LayerGeometry::ConstCoordsMap &coords)
+{
+    Placement placement;
+    placement.origin = coords.row(0).transpose();
+    placement.turns = 0;
+
+    for(Eigen::Index i = 1; i < coords.rows(); i++) {
+
+        const Eigen::Vector2f dir = coords.row(i).transpose() - placement.origin;
+
+        if(dir.isZero(0.f))
+            continue;
+
+        for(int turns = 0; turns < 4; turns++) {
+            const Eigen::Vector2f rotated = rotateQuarterTurns(dir, turns);
+
+            if(rotated.x() > 0.f && rotated.y() >= 0.f) {
+                placement.turns = turns;
+                break;
+            }
+        }
+
+        break;
+    }
+
+    return placement;
+}
+
+// An instance reproduces the original coordinates exactly only if the translation is reversible
+bool isExactPlacement(const LayerGeometry::ConstCoordsMap &coords, const Placement &placement)
+{
+    const Eigen::RowVector2f origin = placement.origin.transpose();
+    return (((coords.rowwise() - origin).rowwise() + origin).array() == coords.array()).all();
+}
+
+uint64_t hashPayload(const LayerGeometry::ConstCoordsMap &coords, const Placement &placement)
+{
+    // FNV-1a over the bit patterns of the payload coordinates
+    uint64_t hash = 14695981039346656037ull;
+
+    auto mix = [&hash](uint32_t val) {
+        hash ^= val;
+        hash *= 1099511628211ull;
+    };
+
+    mix(uint32_t(coords.rows()));
+
+    for(Eigen::Index i = 0; i < coords.rows(); i++) {
+        const Eigen::Vector2f pnt = payloadPoint(coords, i, placement);
+
+        for(int j = 0; j < 2; j++) {
+            // Negative zeros (from rotating) compare equal to zero, so are hashed as zero
+            const float val = pnt[j] + 0.f;
+
+            uint32_t bits;
+            std::memcpy(&bits, &val, sizeof(bits));
+            mix(bits);
+        }
+    }
+
+    return hash;
+}
+
+bool equalPayloads(const LayerGeometry::ConstCoordsMap &a, const Placement &placementA,
+                   const LayerGeometry::ConstCoordsMap &b, const Placement &placementB)
+{
+    if(a.rows() != b.rows() || b.cols() != 2)
+        return false;
+
+    for(Eigen::Index i = 0; i < a.rows(); i++) {
+        if(payloadPoint(a, i, placementA) != payloadPoint(b, i, placementB))
+            return false;
+    }
+
+    return true;
+}
+
+bool equalPayloads(const LayerGeometry::ConstCoordsMap &coords, const Placement &placement,
+                   const Eigen::MatrixXf &payload)
+{
+    if(coords.rows() != payload.rows())
+        return false;
+
+    for(Eigen::Index i = 0; i < coords.rows(); i++) {
+        if(payloadPoint(coords, i, placement) != payload.row(i).transpose())
+            return false;
+    }
+
+    return true;
+}
+
+LayerGeometry::Payload makePayload(const LayerGeometry::ConstCoordsMap &coords, const Placement &placement)
+{
+    Eigen::MatrixXf payload(coords.rows(), 2);
+
+    for(Eigen::Index i = 0; i < coords.rows(); i++)
+        payload.row(i) = payloadPoint(coords, i, placement).transpose();
+
+    return std::make_shared<const Eigen::MatrixXf>(std::move(payload));
+}
+
+// The instance undoes the rotation applied to the payload
+void setInstance(LayerGeometry &geom, const LayerGeometry::Payload &payload, const Placement &placement)
+{
+    geom.setInstance(payload, placement.origin, LayerGeometry::quarterTurns((4 - placement.turns) % 4));
+}
+
+} // End of anonymous namespace
+
+InstancingResult deduplicateGeometry(const std::vector<Layer::Ptr> &layers)
+{
+    InstancingResult result;
+
+    std::unordered_map<uint64_t, std::vector<Candidate> > candidates;
+
+    for(const Layer::Ptr &layer : layers) {
+
+        bool isModified = false;
+
+        for(const LayerGeometry::Ptr &geom : layer->geometry()) {
+
+            if(geom->isQuantized() || geom->isInstanced() || geom->numPoints() == 0)
+                continue;
+
+            const LayerGeometry::ConstCoordsMap coords = geom->coordinates();
+
+            if(coords.cols() != 2)
+                continue;
+
+            result.numCandidates++;
+
+            const Placement placement = canonicalPlacement(coords);
+
+            // Only fold when the instance reproduces the original coordinates exactly
+            if(!isExactPlacement(coords, placement))
+                continue;
+
+            std::vector<Candidate> &bucket = candidates[hashPayload(coords, placement)];
+
+            Candidate *match = nullptr;
+            Candidate *stale = nullptr;
+
+            for(Candidate &candidate : bucket) {
+
+                if(candidate.payload) {
+                    if(equalPayloads(coords, placement, *candidate.payload)) {
+                        match = &candidate;
+                        break;
+                    }
+
+                    continue;
+                }
+
+                /*
+                 * Without a payload, the coordinates of the first geometry are compared, which are only available
+                 * whilst its layer remains resident - once evicted by a LayerCache its coordinates are held
+                 * compressed, or the layer is unloaded (releasing the geometry) and any later load creates new
+                 * geometry.
+                 */
+                const LayerGeometry::Ptr first = candidate.first.lock();
+
+                if(!first || candidate.firstLayer->isCompressed() || candidate.firstLayer->isDeferred()) {
+                    stale = &candidate;
+                    continue;
+                }
+
+                if(equalPayloads(coords, placement, first->coordinates(), candidate.firstPlacement)) {
+                    match = &candidate;
+                    break;
+                }
+            }
+
+            if(!match) {
+
+                // A candidate whose first geometry was evicted is replaced, retaining a copy of the payload to compare
+                Candidate replacement;
+                replacement.payload = stale ? makePayload(coords, placement) : LayerGeometry::Payload();
+                replacement.first = geom;
+                replacement.firstLayer = layer.get();
+                replacement.firstPlacement = placement;
+                replacement.isShared = false;
+
+                if(stale)
+                    *stale = replacement;
+                else
+                    bucket.push_back(replacement);
+
+                continue;
+            }
+
+            if(!match->isShared) {
+                match->isShared = true;
+                result.numPayloads++;
+
+                const LayerGeometry::Ptr first = match->first.lock();
+                const bool isResident = first && !match->firstLayer->isCompressed() && !match->firstLayer->isDeferred();
+
+                if(!match->payload)
+                    match->payload = makePayload(first->coordinates(), match->firstPlacement);
+
+                if(isResident) {
+                    setInstance(*first, match->payload, match->firstPlacement);
+                    match->firstLayer->markModified();
+                    result.numInstanced++;
+                }
+
+                match->first.reset();
+                match->firstLayer = nullptr;
+            }
+
+            setInstance(*geom, match->payload, placement);
+            result.numInstanced++;
+            isModified = true;
+        }
+
+        if(isModified)
+            layer->markModified();
+    }
+
+    // Each payload remains stored once
+    for(const auto &bucket : candidates) {
+        for(const Candidate &candidate : bucket.second) {
+            // Held once by the candidate, and by every instance
+            if(candidate.isShared && candidate.payload.use_count() > 2)
+                result.bytesSaved += (candidate.payload.use_count() - 2) * candidate.payload->size() * sizeof(float);
+        }
+    }
+
+    return result;
+}
+
+} // End of Namespace slm
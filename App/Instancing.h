@@ -0,0 +1,34 @@
+#ifndef SLM_INSTANCING_H_HEADER_HAS_BEEN_INCLUDED
+#define SLM_INSTANCING_H_HEADER_HAS_BEEN_INCLUDED
+
+#include "SLM_Export.h"
+
+#include <cstdint>
+#include <vector>
+
+#include "Layer.h"
+
+namespace slm {
+
+struct InstancingResult
+{
+    uint64_t numCandidates = 0;  // Geometries considered for folding
+    uint64_t numInstanced  = 0;  // Geometries converted to reference a shared payload
+    uint64_t numPayloads   = 0;  // Unique shared payloads created
+    uint64_t bytesSaved    = 0;  // Approximate coordinate storage saved
+};
+
+/**
+ * Detects geometries with identical coordinates up to a translation and a rotation by a multiple of a quarter turn
+ * across the layers of a build and folds them into a single shared payload, with each geometry becoming an instance
+ * placed by its first point. Payloads are matched by hash followed by an exact comparison against the coordinates
+ * of the first geometry found, and are only copied once a duplicate is found. A geometry is only folded when its
+ * resolved coordinates reproduce the original coordinates exactly, and layers with folded geometry are marked as
+ * modified. Quantized and already instanced geometry is left unchanged, as is the first geometry of a payload when
+ * its layer has since been evicted by a LayerCache.
+ */
+SLM_EXPORT InstancingResult deduplicateGeometry(const std::vector<Layer::Ptr> &layers);
+
+} // End of Namespace slm
+
+#endif // SLM_INSTANCING_H_HEADER_HAS_BEEN_INCLUDED
@@ -257,7 +257,8 @@ LayerGeometry * LayerGeomIterator::value() const
 LaserScanIterator::LaserScanIterator(Slm *val) : LayerGeomIterator(val)
 {
     this->_curLayerGeom = LayerGeomIterator::value();
-    this->_pntIt = this->_curLayerGeom->coords.cbegin();
+    this->_curCoords = this->_curLayerGeom->floatCoords();
+    this->_pntIdx = 0;
 }
 
 LaserScanIterator::~LaserScanIterator()
@@ -272,11 +273,11 @@ bool LaserScanIterator::more() const
     } else {
 
         if(this->_curLayerGeom->getType() == LayerGeometry::HATCH) {
-            return this->_pntIt + 2 != this->_curLayerGeom->coords.cend();
+            return this->_pntIdx + 2 != this->_curCoords.rows();
         } else if(this->_curLayerGeom->getType() == LayerGeometry::POLYGON) {
-            return this->_pntIt + 1 != this->_curLayerGeom->coords.cend();
+            return this->_pntIdx + 1 != this->_curCoords.rows();
         } else {
-            return this->_pntIt + 1 != this->_curLayerGeom->coords.cend();
+            return this->_pntIdx + 1 != this->_curCoords.rows();
         }
     }
 }
@@ -291,13 +292,13 @@ LaserScan LaserScanIterator::value() const
     scan.tEnd   = this->getCurrentTime() + this->calcScanTime();
 
     if(scan.type == LayerGeometry::HATCH) {
-        scan.start = *(this->_pntIt); // Return value
-        scan.end   = *(this->_pntIt + 1);
+        scan.start = this->_curCoords.row(this->_pntIdx).transpose(); // Return value
+        scan.end   = this->_curCoords.row(this->_pntIdx + 1).transpose();
     } else if(scan.type == LayerGeometry::POLYGON) {
-        scan.start = *(this->_pntIt ); // Return value
-        scan.end   = *(this->_pntIt+1);
+        scan.start = this->_curCoords.row(this->_pntIdx).transpose(); // Return value
+        scan.end   = this->_curCoords.row(this->_pntIdx + 1).transpose();
     } else {
-        scan.start = *(this->_pntIt); // Return value
+        scan.start = this->_curCoords.row(this->_pntIdx).transpose(); // Return value
         scan.end = scan.start;
     }
 
@@ -336,13 +337,8 @@ double LaserScanIterator::calcScanTime() const
     switch(geom->getType()) {
         case LayerGeometry::HATCH:
         case LayerGeometry::POLYGON: {
-           QPointF start, end;
-
-            start = *(this->_pntIt); // Return value
-            end   = *(this->_pntIt + 1);
-
-            QPointF delta = end-start;
-            double dist = sqrt(pow(delta.x(),2) + pow(delta.y(),2));
+            const Eigen::Vector2f delta = (this->_curCoords.row(this->_pntIdx + 1) - this->_curCoords.row(this->_pntIdx)).transpose();
+            double dist = delta.norm();
             scanTime = dist / bstyle->laserSpeed;
         } break;
         default:
@@ -360,15 +356,14 @@ void LaserScanIterator::next()
     this->_relTime += this->calcScanTime();
 
     if(this->_curLayerGeom->getType() == LayerGeometry::HATCH) {
-        this->_pntIt++; // Advance once since coords are in pairs
-        this->_pntIt++;
-        newLayerGeom = this->_pntIt == this->_curLayerGeom->coords.cend();
+        this->_pntIdx += 2; // Advance twice since coords are in pairs
+        newLayerGeom = this->_pntIdx == this->_curCoords.rows();
     } else if(this->_curLayerGeom->getType() == LayerGeometry::POLYGON) {
-        this->_pntIt++;
-        newLayerGeom = this->_pntIt == this->_curLayerGeom->coords.cend() - 1;
+        this->_pntIdx++;
+        newLayerGeom = this->_pntIdx == this->_curCoords.rows() - 1;
     } else {
-        this->_pntIt++;
-        newLayerGeom = this->_pntIt == this->_curLayerGeom->coords.cend();
+        this->_pntIdx++;
+        newLayerGeom = this->_pntIdx == this->_curCoords.rows();
     }
 
     if(newLayerGeom) {
@@ -378,7 +373,8 @@ void LaserScanIterator::next()
 
             this->_relTime = 0; // Reset relative time for current layer geometry
             this->_curLayerGeom = LayerGeomIterator::value();
-            this->_pntIt = this->_curLayerGeom->coords.cbegin();
+            this->_curCoords = this->_curLayerGeom->floatCoords();
+            this->_pntIdx = 0;
             this->_layerGeomTime = LayerGeomIterator::getCurrentTime();
         }
     }
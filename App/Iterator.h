@@ -138,7 +138,8 @@ private:
 
     LayerGeometry _curLayerGeom;
 
-    QVector<QPointF>::const_iterator _pntIt; // Laser Point Iterator
+    Eigen::MatrixXf _curCoords;  // Coordinates of the current geometry, resolved from its storage
+    Eigen::Index    _pntIdx;     // Laser Point Index
 };
 
 } // End of namespace SLM
@@ -1,11 +1,33 @@
 #include <cassert>
 #include <algorithm>
+#include <cmath>
 #include <exception>
-
+#include <iostream>
+#include <limits>
+
+#include "GeometryArena.h"
+#include "GeometryKernels.h"
+#include "LayerCache.h"
+#include "LayerCompression.h"
+#include "SpatialIndex.h"
 #include "Layer.h"
 
 using namespace slm;
 
+namespace {
+
+LayerGeometry::Ptr makeGeometry(LayerGeometry::TYPE type, uint32_t mid, uint32_t bid)
+{
+    switch(type) {
+        case LayerGeometry::HATCH:   return std::make_shared<HatchGeometry>(mid, bid);
+        case LayerGeometry::POLYGON: return std::make_shared<ContourGeometry>(mid, bid);
+        case LayerGeometry::PNTS:    return std::make_shared<PntsGeometry>(mid, bid);
+        default:                     return std::make_shared<LayerGeometry>(mid, bid);
+    }
+}
+
+} // End of anonymous namespace
+
 LayerGeometry::LayerGeometry() : mid(0),
                                  bid(0)
 {
@@ -16,26 +38,370 @@ LayerGeometry::LayerGeometry(uint32_t modelId, uint32_t buildStyleId ) : mid(mod
 {
 }
 
+LayerGeometry::LayerGeometry(const LayerGeometry &other) : coords(other.coords),
+                                                           modelId(other.modelId),
+                                                           buildId(other.buildId),
+                                                           mView(other.mView),
+                                                           mViewRows(other.mViewRows),
+                                                           mid(other.mid),
+                                                           bid(other.bid)
+{
+    if(other.mExt)
+        mExt.reset(new Extension(*other.mExt));
+}
+
+LayerGeometry & LayerGeometry::operator=(const LayerGeometry &other)
+{
+    if(this == &other)
+        return *this;
+
+    coords = other.coords;
+    modelId = other.modelId;
+    buildId = other.buildId;
+    mView = other.mView;
+    mViewRows = other.mViewRows;
+    mExt.reset(other.mExt ? new Extension(*other.mExt) : nullptr);
+    mMetricsValid = false;
+
+    mid = other.mid;
+    bid = other.bid;
+
+    return *this;
+}
+
 LayerGeometry::~LayerGeometry()
 {
 }
 
+LayerGeometry::Extension & LayerGeometry::extension()
+{
+    if(!mExt)
+        mExt.reset(new Extension());
+
+    return *mExt;
+}
+
+Eigen::Index LayerGeometry::numPoints() const
+{
+    if(isQuantized())
+        return mExt->qcoords.rows();
+
+    if(isInstanced())
+        return mExt->payload->rows();
+
+    return mView ? mViewRows : coords.rows();
+}
+
+const LayerGeometry::QuantizedCoords & LayerGeometry::quantizedCoords() const
+{
+    static const QuantizedCoords empty;
+    return mExt ? mExt->qcoords : empty;
+}
+
+LayerGeometry::QuantizedCoords & LayerGeometry::quantizedCoordsRef()
+{
+    mMetricsValid = false;
+    return extension().qcoords;
+}
+
+const Quantization & LayerGeometry::quantization() const
+{
+    static const Quantization none;
+    return mExt ? mExt->quantization : none;
+}
+
+const LayerGeometry::Payload & LayerGeometry::payload() const
+{
+    static const Payload none;
+    return mExt ? mExt->payload : none;
+}
+
+const Eigen::Vector2f & LayerGeometry::translation() const
+{
+    static const Eigen::Vector2f origin = Eigen::Vector2f::Zero();
+    return mExt ? mExt->translation : origin;
+}
+
+LayerGeometry::ConstCoordsMap LayerGeometry::coordinates() const
+{
+    if(isQuantized() || isInstanced())
+        return ConstCoordsMap(nullptr, 0, 2);
+
+    if(mView)
+        return ConstCoordsMap(mView.get(), mViewRows, 2);
+
+    return ConstCoordsMap(coords.data(), coords.rows(), coords.cols());
+}
+
+LayerGeometry::CoordsMap LayerGeometry::mutableCoordinates()
+{
+    mMetricsValid = false;
+
+    if(isQuantized() || isInstanced())
+        return CoordsMap(nullptr, 0, 2);
+
+    if(mView)
+        return CoordsMap(mView.get(), mViewRows, 2);
+
+    return CoordsMap(coords.data(), coords.rows(), coords.cols());
+}
+
+void LayerGeometry::setCoords(const Eigen::MatrixXf &val)
+{
+    mExt.reset();
+    mView.reset();
+    mViewRows = 0;
+    mMetricsValid = false;
+    coords = val;
+}
+
+void LayerGeometry::setView(const std::shared_ptr<float> &data, Eigen::Index numPoints)
+{
+    mExt.reset();
+    coords.resize(0, 0);
+    mView = data;
+    mViewRows = numPoints;
+    mMetricsValid = false;
+}
+
+void LayerGeometry::detach()
+{
+    if(isInstanced()) {
+        Eigen::MatrixXf resolved;
+        resolve(resolved);
+        coords.swap(resolved);
+        mExt.reset();
+        return;
+    }
+
+    if(!mView)
+        return;
+
+    coords = ConstCoordsMap(mView.get(), mViewRows, 2);
+    mView.reset();
+    mViewRows = 0;
+}
+
+LayerGeometry::ConstCoordsMap LayerGeometry::resolve(Eigen::MatrixXf &scratch) const
+{
+    if(!isQuantized() && !isInstanced())
+        return coordinates();
+
+    const Extension &ext = *mExt;
+
+    if(ext.payload) {
+        int turns = 0;
+
+        while(turns < 4 && ext.rotation != quarterTurns(turns))
+            turns++;
+
+        if(turns < 4) {
+            scratch.resize(ext.payload->rows(), ext.payload->cols());
+
+            const Eigen::Index x = (turns % 2) ? 1 : 0;
+            const float signX = (turns == 1 || turns == 2) ? -1.f : 1.f;
+            const float signY = (turns == 2 || turns == 3) ? -1.f : 1.f;
+
+            // Quarter turns swap and negate the payload coordinates, so that these are placed exactly
+            scratch.col(0) = (signX * ext.payload->col(x)).array() + ext.translation.x();
+            scratch.col(1) = (signY * ext.payload->col(1 - x)).array() + ext.translation.y();
+        } else {
+            const Eigen::Rotation2Df rot(ext.rotation);
+            scratch = (*ext.payload * rot.toRotationMatrix().transpose()).rowwise() + ext.translation.transpose();
+        }
+
+        return ConstCoordsMap(scratch.data(), scratch.rows(), scratch.cols());
+    }
+
+    scratch.resize(ext.qcoords.rows(), ext.qcoords.cols());
+
+    for(Eigen::Index col = 0; col < ext.qcoords.cols(); col++) {
+        const Quantization &quant = ext.quantization;
+        const double offset = (col == 0) ? quant.offsetX : (col == 1) ? quant.offsetY : 0.0;
+        scratch.col(col) = (ext.qcoords.col(col).cast<double>().array() * quant.scale + offset).cast<float>();
+    }
+
+    return ConstCoordsMap(scratch.data(), scratch.rows(), scratch.cols());
+}
+
+float LayerGeometry::quarterTurns(int turns)
+{
+    return float(double(turns) * 1.5707963267948966);
+}
+
+Eigen::MatrixXf LayerGeometry::floatCoords() const
+{
+    Eigen::MatrixXf scratch;
+    return resolve(scratch);
+}
+
+void LayerGeometry::setQuantizedCoords(const QuantizedCoords &val, const Quantization &quant)
+{
+    coords.resize(0, 0);
+    mView.reset();
+    mViewRows = 0;
+
+    mExt.reset(new Extension());
+    mExt->qcoords = val;
+    mExt->quantization = quant;
+    mExt->isQuantized = true;
+    mMetricsValid = false;
+}
+
+int LayerGeometry::quantize(const Quantization &quant)
+{
+    if(isQuantized() && mExt->quantization == quant)
+        return 0;
+
+    if(!std::isfinite(quant.scale) || quant.scale <= 0.0 ||
+       !std::isfinite(quant.offsetX) || !std::isfinite(quant.offsetY)) {
+        std::cerr << "Geometry cannot be quantized with a non-positive or non-finite quantization" << std::endl;
+        return -1;
+    }
+
+    Eigen::MatrixXf scratch;
+    const ConstCoordsMap fcoords = resolve(scratch);
+
+    // Non-finite coordinates have no integer representation (the conversion is undefined), so are rejected
+    if(!fcoords.allFinite()) {
+        std::cerr << "Geometry with non-finite coordinates cannot be quantized" << std::endl;
+        return -1;
+    }
+
+    const double qMin = std::numeric_limits<int32_t>::min();
+    const double qMax = std::numeric_limits<int32_t>::max();
+
+    QuantizedCoords qcoords(fcoords.rows(), fcoords.cols());
+
+    for(Eigen::Index col = 0; col < fcoords.cols(); col++) {
+        const double offset = (col == 0) ? quant.offsetX : (col == 1) ? quant.offsetY : 0.0;
+        qcoords.col(col) = ((fcoords.col(col).cast<double>().array() - offset) / quant.scale).round().max(qMin).min(qMax).cast<int32_t>();
+    }
+
+    setQuantizedCoords(QuantizedCoords(), quant);
+    mExt->qcoords.swap(qcoords);
+
+    return 0;
+}
+
+void LayerGeometry::setInstance(const Payload &payload, const Eigen::Vector2f &translation, float rotation)
+{
+    coords.resize(0, 0);
+    mView.reset();
+    mViewRows = 0;
+
+    mExt.reset(new Extension());
+    mExt->payload = payload;
+    mExt->translation = translation;
+    mExt->rotation = rotation;
+    mMetricsValid = false;
+}
+
+void LayerGeometry::dequantize()
+{
+    if(!isQuantized())
+        return;
+
+    coords = floatCoords();
+    mExt.reset();
+}
+
+const GeometryMetrics & LayerGeometry::metrics() const
+{
+    if(mMetricsValid)
+        return *mMetrics;
+
+    if(!mMetrics)
+        mMetrics.reset(new GeometryMetrics());
+
+    Eigen::MatrixXf scratch;
+    const ConstCoordsMap pts = resolve(scratch);
+
+    const Eigen::Index n = (pts.cols() >= 2) ? pts.rows() : 0;
+
+    GeometryMetrics &m = *mMetrics;
+
+    m.bbox[0] = m.bbox[2] =  std::numeric_limits<float>::max();
+    m.bbox[1] = m.bbox[3] = -std::numeric_limits<float>::max();
+    m.start[0] = m.start[1] = m.end[0] = m.end[1] = 0.f;
+    m.pathLength = 0.0;
+    m.jumpLength = 0.0;
+    m.numSegments = 0;
+    m.numPoints = uint64_t(n);
+
+    if(n > 0) {
+        const float *x = pts.col(0).data();
+        const float *y = pts.col(1).data();
+
+        kernels::boundingBox(x, y, size_t(n), m.bbox);
+
+        m.start[0] = x[0];
+        m.start[1] = y[0];
+        m.end[0] = x[n - 1];
+        m.end[1] = y[n - 1];
+
+        switch(getType()) {
+            case HATCH:
+                // Jumps join the end of each hatch vector to the start of the next, i.e. the pairs offset by a point
+                m.pathLength = kernels::hatchLength(x, y, size_t(n));
+                m.jumpLength = kernels::hatchLength(x + 1, y + 1, size_t(n - 1));
+                m.numSegments = uint64_t(n / 2);
+                break;
+            case POLYGON:
+                m.pathLength = kernels::polylineLength(x, y, size_t(n));
+                m.numSegments = uint64_t(n - 1);
+                break;
+            default:
+                m.jumpLength = kernels::polylineLength(x, y, size_t(n));
+                m.numSegments = uint64_t(n);
+                break;
+        }
+    }
+
+    mMetricsValid = true;
+
+    return *mMetrics;
+}
+
 Layer::Layer() : lid(0),
                  z(0),
                  mLayerPos(0),
-                 mIsLoaded(false)
+                 mIsDeferred(false),
+                 mIsLoading(false),
+                 mIsCompressed(false),
+                 mIsLoaded(false),
+                 mIsModified(false),
+                 mNumPins(0),
+                 mTypeIndexDirty(false),
+                 mScanOrderValid{false, false, false},
+                 mMetricsValid(false),
+                 mResidentBytes(0),
+                 mResidentBytesValid(false)
 {
 }
 
 Layer::Layer(uint64_t id, uint64_t zVal) :  lid(id),
                                             z(zVal),
                                             mLayerPos(0),
-                                            mIsLoaded(false)
+                                            mIsDeferred(false),
+                                            mIsLoading(false),
+                                            mIsCompressed(false),
+                                            mIsLoaded(false),
+                                            mIsModified(false),
+                                            mNumPins(0),
+                                            mTypeIndexDirty(false),
+                                            mScanOrderValid{false, false, false},
+                                            mMetricsValid(false),
+                                            mResidentBytes(0),
+                                            mResidentBytesValid(false)
 {
 }
 
 Layer::~Layer()
 {
+    if(mCache)
+        mCache->remove(this);
+
     mGeometry.clear();
 }
 
@@ -56,16 +422,404 @@ void Layer::setZ(const uint64_t &val)
 
 void Layer::clear()
 {
+    discardCompressed();
     mGeometry.clear();
+    mArena.reset();
+
+    for(std::vector<uint32_t> &typeIndex : mTypeIndex)
+        typeIndex.clear();
+
+    mTypeIndexDirty = false;
+    mIsDeferred = false;
+    markModified();
 }
 
 void Layer::setIsLoaded(const bool &isLoaded)
 {
     mIsLoaded = isLoaded;
+    mIsDeferred = (mLoader && !mIsLoaded);
 }
 
 void Layer::setGeometry(const std::vector<LayerGeometry::Ptr> &geoms) {
+    discardCompressed();
     mGeometry = geoms;
+    mTypeIndexDirty = true;
+    markModified();
+}
+
+void Layer::setGeometry(std::vector<LayerGeometry::Ptr> &&geoms) {
+    discardCompressed();
+    mGeometry = std::move(geoms);
+    mTypeIndexDirty = true;
+    markModified();
+}
+
+std::vector<LayerGeometry::Ptr> & Layer::geometryRef()
+{
+    ensureResident();
+    mTypeIndexDirty = true;
+    markModified();
+
+    return mGeometry;
+}
+
+void Layer::compress()
+{
+    if(mIsCompressed)
+        return;
+
+    if(mCache)
+        mCache->remove(this);
+
+    encodeLayerGeometry(mGeometry, mCompressed, &mQuantization);
+
+    // Arena backed views have been released by the encoder
+    mArena.reset();
+    mIsCompressed = true;
+}
+
+void Layer::evict()
+{
+    // Loaded layers are released, as they can be loaded again from the file, unless modified since
+    if(mLoader && mIsLoaded && !mIsModified)
+        unload();
+    else
+        compress();
+}
+
+void Layer::setLoader(const Loader &loader)
+{
+    mLoader = loader;
+    mIsDeferred = (mLoader && !mIsLoaded);
+}
+
+int Layer::load()
+{
+    if(!mLoader)
+        return 0;
+
+    if(!mIsLoaded)
+        mIsDeferred = true;
+
+    return (makeResident() == 0 && mIsLoaded) ? 0 : -1;
+}
+
+int Layer::unload()
+{
+    if(!mLoader)
+        return -1;
+
+    if(mIsModified) {
+        std::cerr << "Layer (" << lid << ") has been modified since loaded and cannot be unloaded" << std::endl;
+        return -1;
+    }
+
+    if(mCache)
+        mCache->remove(this);
+
+    releaseGeometry();
+
+    mIsLoaded = false;
+    mIsDeferred = true;
+
+    return 0;
+}
+
+void Layer::releaseGeometry()
+{
+    discardCompressed();
+    mGeometry.clear();
+    mArena.reset();
+
+    // The loader assigns a new arena when loaded again, so that the memory of the geometry is released
+    mMemoryArena.reset();
+
+    for(std::vector<uint32_t> &typeIndex : mTypeIndex)
+        typeIndex.clear();
+
+    for(bool &valid : mScanOrderValid)
+        valid = false;
+
+    mSpatialIndex.reset();
+    mTypeIndexDirty = false;
+    mResidentBytesValid = false;
+}
+
+size_t Layer::residentBytes() const
+{
+    if(mResidentBytesValid)
+        return mResidentBytes;
+
+    size_t bytes = mGeometry.capacity() * sizeof(LayerGeometry::Ptr);
+
+    for(const LayerGeometry::Ptr &geom : mGeometry)
+        bytes += sizeof(LayerGeometryT<LayerGeometry::HATCH>) + size_t(geom->numPoints()) * 2 * sizeof(float);
+
+    mResidentBytes = bytes;
+    mResidentBytesValid = true;
+
+    return bytes;
+}
+
+int Layer::makeResident() const
+{
+    if(mIsDeferred) {
+
+        // Geometry added by the loader must not load the layer again
+        mIsDeferred = false;
+        mIsLoading = true;
+
+        Layer *layer = const_cast<Layer *>(this);
+
+        if(mLoader(*layer) == 0) {
+            layer->mIsLoaded = true;
+            layer->mIsModified = false;
+        } else {
+            // Any partially loaded geometry is released and the layer remains deferred, so that it is retried
+            std::cerr << "Layer (" << lid << ") could not be loaded" << std::endl;
+            layer->releaseGeometry();
+            mIsDeferred = true;
+        }
+
+        mIsLoading = false;
+    }
+
+    if(mIsCompressed) {
+
+        // The compressed data is retained upon failure, leaving the layer compressed (and its geometry empty)
+        if(!decodeLayerGeometry(mCompressed, mGeometry)) {
+            std::cerr << "Layer (" << lid << ") could not be expanded - corrupt compressed data" << std::endl;
+            return -1;
+        }
+
+        mCompressed.clear();
+        mCompressed.shrink_to_fit();
+        mIsCompressed = false;
+        mResidentBytesValid = false;
+    }
+
+    // The layer is added to the cache once loaded, so that its size is known
+    if(mCache && !mIsLoading && !mIsDeferred)
+        mCache->touch(const_cast<Layer *>(this));
+
+    return mIsDeferred ? -1 : 0;
+}
+
+void Layer::discardCompressed()
+{
+    mCompressed.clear();
+    mCompressed.shrink_to_fit();
+    mIsCompressed = false;
+}
+
+void Layer::setCache(const std::shared_ptr<LayerCache> &cache)
+{
+    if(mCache)
+        mCache->remove(this);
+
+    mCache = cache;
+
+    // Compressed and deferred layers are added to the cache once resident
+    if(mCache && !mIsCompressed && !mIsDeferred)
+        mCache->touch(this);
+}
+
+int Layer::pin() const
+{
+    // Pinned before being made resident, so that the layer cannot be evicted in between
+    mNumPins++;
+
+    if(ensureResident() != 0) {
+        unpin();
+        return -1;
+    }
+
+    return 0;
+}
+
+void Layer::unpin() const
+{
+    if(mNumPins == 0)
+        return;
+
+    // Layers retained over the cache's budget whilst pinned are evicted once unpinned
+    if(--mNumPins == 0 && mCache)
+        mCache->evictToBudget();
+}
+
+void Layer::markModified()
+{
+    for(bool &valid : mScanOrderValid)
+        valid = false;
+
+    mSpatialIndex.reset();
+    mMetricsValid = false;
+    mResidentBytesValid = false;
+
+    if(mIsLoaded)
+        mIsModified = true;
+}
+
+const LayerMetrics & Layer::metrics() const
+{
+    if(mMetricsValid)
+        return mMetrics;
+
+    ensureResident();
+
+    LayerMetrics &m = mMetrics;
+
+    m.bbox[0] = m.bbox[2] =  std::numeric_limits<float>::max();
+    m.bbox[1] = m.bbox[3] = -std::numeric_limits<float>::max();
+    m.pathLength = 0.0;
+    m.jumpLength = 0.0;
+    m.numSegments = 0;
+    m.numPoints = 0;
+    m.numHatchGeoms = 0;
+    m.numContourGeoms = 0;
+    m.numPntsGeoms = 0;
+
+    const GeometryMetrics *prev = nullptr;
+
+    for(const LayerGeometry::Ptr &geom : mGeometry) {
+
+        switch(geom->getType()) {
+            case LayerGeometry::HATCH:   m.numHatchGeoms++;   break;
+            case LayerGeometry::POLYGON: m.numContourGeoms++; break;
+            case LayerGeometry::PNTS:    m.numPntsGeoms++;    break;
+            default: break;
+        }
+
+        const GeometryMetrics &gm = geom->metrics();
+
+        if(gm.numPoints == 0)
+            continue;
+
+        m.bbox[0] = std::min(m.bbox[0], gm.bbox[0]);
+        m.bbox[1] = std::max(m.bbox[1], gm.bbox[1]);
+        m.bbox[2] = std::min(m.bbox[2], gm.bbox[2]);
+        m.bbox[3] = std::max(m.bbox[3], gm.bbox[3]);
+
+        m.pathLength += gm.pathLength;
+        m.jumpLength += gm.jumpLength;
+        m.numSegments += gm.numSegments;
+        m.numPoints += gm.numPoints;
+
+        // Jump from the end of the previous geometry
+        if(prev) {
+            const double dx = double(gm.start[0]) - double(prev->end[0]);
+            const double dy = double(gm.start[1]) - double(prev->end[1]);
+            m.jumpLength += std::sqrt(dx * dx + dy * dy);
+        }
+
+        prev = &gm;
+    }
+
+    mMetricsValid = true;
+
+    return mMetrics;
+}
+
+const SpatialIndex & Layer::spatialIndex() const
+{
+    ensureResident();
+
+    if(!mSpatialIndex) {
+        auto index = std::make_shared<SpatialIndex>();
+        index->build(mGeometry);
+        mSpatialIndex = index;
+    }
+
+    return *mSpatialIndex;
+}
+
+std::vector<uint32_t> Layer::queryGeometry(float minX, float minY, float maxX, float maxY) const
+{
+    return spatialIndex().queryGeometry(minX, minY, maxX, maxY);
+}
+
+int Layer::quantize()
+{
+    ensureResident();
+
+    int status = 0;
+
+    for(const LayerGeometry::Ptr &geom : mGeometry) {
+        if(geom->quantize(mQuantization) != 0)
+            status = -1;
+    }
+
+    markModified();
+
+    return status;
+}
+
+void Layer::dequantize()
+{
+    ensureResident();
+
+    for(const LayerGeometry::Ptr &geom : mGeometry)
+        geom->dequantize();
+
+    markModified();
+}
+
+void Layer::setGeometryArena(std::shared_ptr<GeometryArena> arena)
+{
+    discardCompressed();
+    mGeometry.clear();
+    mArena = arena;
+    mTypeIndexDirty = true;
+    markModified();
+
+    if(!arena)
+        return;
+
+    arena->seal();
+    mGeometry.reserve(arena->size());
+
+    for(const GeometryArena::Entry &entry : arena->entries()) {
+        LayerGeometry::Ptr geom = makeGeometry(entry.type, entry.mid, entry.bid);
+
+        // The aliasing constructor shares ownership of the arena with each view
+        geom->setView(std::shared_ptr<float>(arena, arena->data() + entry.offset), entry.numPoints);
+        mGeometry.push_back(geom);
+    }
+}
+
+void Layer::compact()
+{
+    ensureResident();
+
+    size_t numPoints = 0;
+
+    for(const LayerGeometry::Ptr &geom : mGeometry)
+        numPoints += geom->numPoints();
+
+    auto arena = std::make_shared<GeometryArena>();
+    arena->reserve(mGeometry.size(), numPoints);
+
+    // Quantized and instanced geometry is left in its existing storage
+    std::vector<LayerGeometry *> packed;
+    packed.reserve(mGeometry.size());
+
+    for(const LayerGeometry::Ptr &geom : mGeometry) {
+        if(geom->isQuantized() || geom->isInstanced())
+            continue;
+
+        arena->addGeometry(geom->getType(), geom->mid, geom->bid, geom->coordinates());
+        packed.push_back(geom.get());
+    }
+
+    arena->seal();
+
+    // Re-bind the existing geometry objects so that any external references remain valid
+    for(size_t i = 0; i < packed.size(); i++) {
+        const GeometryArena::Entry &entry = arena->entry(i);
+        packed[i]->setView(std::shared_ptr<float>(arena, arena->data() + entry.offset), entry.numPoints);
+    }
+
+    mArena = arena;
 }
 
 
@@ -74,7 +828,9 @@ void Layer::appendGeometry(LayerGeometry::Ptr geom)
     if(!geom)
         return;
 
-    mGeometry.push_back(geom);
+    ensureResident();
+    mGeometry.push_back(std::move(geom));
+    indexGeometry(mGeometry.size() - 1);
 }
 
 int64_t Layer::addContourGeometry(LayerGeometry::Ptr geom)
@@ -84,7 +840,9 @@ int64_t Layer::addContourGeometry(LayerGeometry::Ptr geom)
 
     assert(geom->getType() == LayerGeometry::POLYGON);
 
-    mGeometry.push_back(geom);
+    ensureResident();
+    mGeometry.push_back(std::move(geom));
+    indexGeometry(mGeometry.size() - 1);
 
     return mGeometry.size();
 }
@@ -96,7 +854,9 @@ int64_t Layer::addHatchGeometry(LayerGeometry::Ptr geom)
 
     assert(geom->getType() == LayerGeometry::HATCH);
 
-    mGeometry.push_back(geom);
+    ensureResident();
+    mGeometry.push_back(std::move(geom));
+    indexGeometry(mGeometry.size() - 1);
 
     return mGeometry.size();
 }
@@ -108,83 +868,129 @@ int64_t Layer::addPntsGeometry(LayerGeometry::Ptr geom)
 
     assert(geom->getType() == LayerGeometry::PNTS);
 
-    mGeometry.push_back(geom);
+    ensureResident();
+    mGeometry.push_back(std::move(geom));
+    indexGeometry(mGeometry.size() - 1);
+
     return mGeometry.size(); // Return updated size
 }
 
 
-std::vector<LayerGeometry::Ptr > Layer::getContourGeometry() const
+void Layer::indexGeometry(size_t idx)
 {
-    std::vector<LayerGeometry::Ptr> contourGeomList;
+    // Whilst parsing there is no derived data to invalidate, so that appending geometry remains cheap
+    const bool hasDerivedData = mMetricsValid || mResidentBytesValid || mSpatialIndex ||
+                                mScanOrderValid[0] || mScanOrderValid[1] || mScanOrderValid[2];
 
-    for(auto geom : mGeometry) {
-        if (geom->getType() == LayerGeometry::POLYGON)
-            contourGeomList.push_back(geom);
-    }
+    if(hasDerivedData || (mIsLoaded && !mIsModified))
+        markModified();
+
+    // A dirty index is regenerated in full upon next access
+    if(mTypeIndexDirty)
+        return;
 
-    return contourGeomList;
+    const LayerGeometry::TYPE type = mGeometry[idx]->getType();
+
+    if(type >= 0 && type < 4)
+        mTypeIndex[type].push_back(uint32_t(idx));
 }
 
-std::vector<LayerGeometry::Ptr > Layer::getHatchGeometry() const
+void Layer::updateTypeIndex() const
 {
-    std::vector<LayerGeometry::Ptr> geomList;
+    if(!mTypeIndexDirty)
+        return;
+
+    for(std::vector<uint32_t> &typeIndex : mTypeIndex)
+        typeIndex.clear();
+
+    for(size_t i = 0; i < mGeometry.size(); i++) {
+        const LayerGeometry::TYPE type = mGeometry[i]->getType();
 
-    for(auto geom : mGeometry) {
-        if (geom->getType() == LayerGeometry::HATCH)
-            geomList.push_back(geom);
+        if(type >= 0 && type < 4)
+            mTypeIndex[type].push_back(uint32_t(i));
     }
 
-    return geomList;
+    mTypeIndexDirty = false;
 }
 
-std::vector<LayerGeometry::Ptr > Layer::getPntsGeometry() const
+GeometryView Layer::geometryOfType(LayerGeometry::TYPE type) const
 {
-    std::vector<LayerGeometry::Ptr> geomList;
+    if(type < 0 || type >= 4)
+        return GeometryView();
 
-    for(auto geom : mGeometry) {
-        if (geom->getType() == LayerGeometry::PNTS)
-            geomList.push_back(geom);
-    }
+    ensureResident();
+    updateTypeIndex();
 
-    return geomList;
+    const std::vector<uint32_t> &idx = mTypeIndex[type];
+    return GeometryView(mGeometry.data(), idx.data(), idx.data() + idx.size());
 }
 
-std::vector<LayerGeometry::Ptr > Layer::getGeometry(ScanMode mode) const
+std::vector<LayerGeometry::Ptr > Layer::getContourGeometry() const
 {
+    return contourGeometry().toVector();
+}
 
-    if(mode == HATCH_FIRST ||
-       mode == CONTOUR_FIRST) {
+std::vector<LayerGeometry::Ptr > Layer::getHatchGeometry() const
+{
+    return hatchGeometry().toVector();
+}
 
-        std::vector<LayerGeometry::Ptr > hatch;
-        std::vector<LayerGeometry::Ptr > contour;
-        std::vector<LayerGeometry::Ptr > points;
-
-        for(auto it = mGeometry.cbegin(); it != mGeometry.cend(); ++it) {
-           if((*it)->getType() == LayerGeometry::PNTS) {
-               points.push_back(*it);
-           } else if((*it)->getType() == LayerGeometry::POLYGON) {
-               contour.push_back(*it);
-           } else if((*it)->getType() == LayerGeometry::HATCH) {
-               hatch.push_back(*it);
-           }
-        }
+std::vector<LayerGeometry::Ptr > Layer::getPntsGeometry() const
+{
+    return pntsGeometry().toVector();
+}
+
+GeometryView Layer::orderedGeometry(ScanMode mode) const
+{
+    if(mode < NONE || mode > HATCH_FIRST)
+        mode = NONE;
+
+    ensureResident();
+
+    std::vector<uint32_t> &order = mScanOrder[mode];
+
+    if(!mScanOrderValid[mode]) {
+
+        order.clear();
+        order.reserve(mGeometry.size());
 
-        std::vector<LayerGeometry::Ptr >list;
+        if(mode == HATCH_FIRST ||
+           mode == CONTOUR_FIRST) {
+
+            updateTypeIndex();
+
+            const std::vector<uint32_t> &hatch   = mTypeIndex[LayerGeometry::HATCH];
+            const std::vector<uint32_t> &contour = mTypeIndex[LayerGeometry::POLYGON];
+            const std::vector<uint32_t> &points  = mTypeIndex[LayerGeometry::PNTS];
+
+            if(mode == HATCH_FIRST) {
+                order.insert(order.end(), hatch.begin(), hatch.end());
+                order.insert(order.end(), contour.begin(), contour.end());
+            } else {
+                order.insert(order.end(), contour.begin(), contour.end());
+                order.insert(order.end(), hatch.begin(), hatch.end());
+            }
+
+            order.insert(order.end(), points.begin(), points.end());
 
-        if(mode == HATCH_FIRST) {
-            list.insert(list.end(), hatch.begin(), hatch.end());
-            list.insert(list.end(), contour.begin(), contour.end());
         } else {
-            list.insert(list.end(), contour.begin(), contour.end());
-            list.insert(list.end(), hatch.begin(), hatch.end());
+            for(size_t i = 0; i < mGeometry.size(); i++)
+                order.push_back(uint32_t(i));
         }
 
-        list.insert(list.end(), points.begin(), points.end());
+        mScanOrderValid[mode] = true;
+    }
 
-        return list;
+    return GeometryView(mGeometry.data(), order.data(), order.data() + order.size());
+}
 
+std::vector<LayerGeometry::Ptr > Layer::getGeometry(ScanMode mode) const
+{
+    if(mode == HATCH_FIRST ||
+       mode == CONTOUR_FIRST) {
+        return orderedGeometry(mode).toVector();
     } else {
-        return mGeometry;
+        return geometry();
     }
 }
 
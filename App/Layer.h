@@ -3,21 +3,63 @@
 
 #include "SLM_Export.h"
 
+#include <cstddef>
 #include <cstdint>
+#include <functional>
+#include <iterator>
 #include <vector>
 #include <memory>
 
 #include <Eigen/Dense>
 
+#include "Header.h"
+#include "MemoryArena.h"
+
 namespace slm
 {
 
+class GeometryArena;
+class LayerCache;
+class SpatialIndex;
+
 enum ScanMode {
     NONE          = 0,
     CONTOUR_FIRST = 1,
     HATCH_FIRST   = 2
 };
 
+/**
+ * @brief Derived metrics of a geometry. The bounding box is ordered (minX, maxX, minY, maxY), consistent with
+ * Writer::getBoundingBox. The path length is the total length scanned with the laser and the jump length the
+ * distance travelled between consecutive hatch vectors or points within the geometry.
+ */
+struct GeometryMetrics
+{
+    float    bbox[4];
+    float    start[2];     // First point of the geometry
+    float    end[2];       // Last point of the geometry
+    double   pathLength;
+    double   jumpLength;
+    uint64_t numSegments;
+    uint64_t numPoints;
+};
+
+/**
+ * @brief Aggregated metrics of a layer. The jump length additionally includes the jumps between consecutive
+ * geometries, in the order they are stored within the layer.
+ */
+struct LayerMetrics
+{
+    float    bbox[4];
+    double   pathLength;
+    double   jumpLength;
+    uint64_t numSegments;
+    uint64_t numPoints;
+    uint64_t numHatchGeoms;
+    uint64_t numContourGeoms;
+    uint64_t numPntsGeoms;
+};
+
 /**
  * @brief The LayerGeometry base class describes geometry information for each layer
  */
@@ -26,10 +68,18 @@ class SLM_EXPORT LayerGeometry
 public:
 
     typedef std::shared_ptr<LayerGeometry> Ptr;
+    typedef Eigen::Map<Eigen::MatrixXf> CoordsMap;
+    typedef Eigen::Map<const Eigen::MatrixXf> ConstCoordsMap;
+    typedef Eigen::Matrix<int32_t, Eigen::Dynamic, Eigen::Dynamic> QuantizedCoords;
+    typedef std::shared_ptr<const Eigen::MatrixXf> Payload;
+
     LayerGeometry(uint32_t modelId, uint32_t buildStyleId );
     LayerGeometry();
+    LayerGeometry(const LayerGeometry &other);
     virtual ~LayerGeometry();
 
+    LayerGeometry & operator=(const LayerGeometry &other);
+
 public:
     enum TYPE {
         INVALID = 0,
@@ -38,12 +88,110 @@ public:
         PNTS    = 3
     };
 
+    /**
+     * Owned float storage. This is only populated for geometry in the owned storage mode - arena backed (view),
+     * quantized and instanced geometry leave it empty. Readers must therefore access coordinates through resolve(),
+     * floatCoords() or coordinates(), rather than reading coords directly.
+     */
     Eigen::MatrixXf coords;
 
+    /**
+     * Coordinate access independent of the underlying float storage. Geometries backed by a GeometryArena are views
+     * into the arena's buffer and leave coords empty, hence these should be preferred over accessing coords directly.
+     * Quantized and instanced geometry have no float storage of their own and return an empty map - use resolve()
+     * or floatCoords() instead.
+     */
+    ConstCoordsMap coordinates() const;
+    CoordsMap mutableCoordinates();
+    Eigen::Index numPoints() const;
+
+    void setCoords(const Eigen::MatrixXf &val);
+
+    /**
+     * Returns the floating point coordinates irrespective of the storage mode. Float storage is mapped directly
+     * without copying, whilst other storage is converted into the scratch matrix provided.
+     */
+    ConstCoordsMap resolve(Eigen::MatrixXf &scratch) const;
+    Eigen::MatrixXf floatCoords() const;
+
+    /**
+     * Quantized storage mode - coordinates are held as integers alongside their quantization, which permits
+     * machine formats storing scaled integer coordinates to be passed through without conversion or loss.
+     * quantize() clamps coordinates to the range of int32_t, and fails (leaving the geometry unchanged) if the
+     * coordinates or quantization are not finite.
+     */
+    bool isQuantized() const { return mExt && mExt->isQuantized; }
+    const QuantizedCoords & quantizedCoords() const;
+    QuantizedCoords & quantizedCoordsRef();
+    const Quantization & quantization() const;
+
+    void setQuantizedCoords(const QuantizedCoords &val, const Quantization &quant);
+    int quantize(const Quantization &quant);
+    void dequantize();
+
+    /**
+     * Instanced storage mode - the geometry references an immutable coordinate payload shared between identical
+     * geometries (e.g. repeated parts across a build plate), placed by a per-instance rotation (radians) about the
+     * payload origin followed by a translation. The placed coordinates are obtained via resolve(). Rotations by a
+     * multiple of a quarter turn (see quarterTurns()) are applied exactly, by swapping and negating coordinates.
+     */
+    bool isInstanced() const { return mExt && mExt->payload; }
+    const Payload & payload() const;
+    const Eigen::Vector2f & translation() const;
+    float rotation() const { return mExt ? mExt->rotation : 0.f; }
+
+    void setInstance(const Payload &payload, const Eigen::Vector2f &translation, float rotation = 0.f);
+
+    static float quarterTurns(int turns);
+
+    /**
+     * Lazily computed metrics, cached until the coordinates are changed via the setters or mutable accessors.
+     * invalidateMetrics() must be called after modifying coords directly. A geometry does not refer to its layer,
+     * hence the layer's metrics are not invalidated by either (see Layer::markModified).
+     */
+    const GeometryMetrics & metrics() const;
+    void invalidateMetrics() { mMetricsValid = false; }
+
+    /**
+     * The geometry refers to an (N x 2) column-major block of external storage. The shared pointer keeps the owner
+     * of the storage (e.g. the GeometryArena) alive for the lifetime of the geometry, unless it has no owner, in which
+     * case the storage (e.g. a layer's MemoryArena) must outlive the geometry. detach() copies view or instanced
+     * coordinates into the geometry's own storage.
+     */
+    bool isView() const { return mView != nullptr; }
+    void setView(const std::shared_ptr<float> &data, Eigen::Index numPoints);
+    void detach();
+
 protected:
     uint32_t modelId = 0;
     uint32_t buildId = 0;
 
+    /*
+     * Storage of the quantized and instanced modes, which is only allocated for geometry in either mode, so that
+     * geometry in the owned and view modes remains small
+     */
+    struct Extension
+    {
+        QuantizedCoords qcoords;
+        Quantization quantization;
+        bool isQuantized = false;
+
+        Payload payload;
+        Eigen::Vector2f translation = Eigen::Vector2f::Zero();
+        float rotation = 0.f;
+    };
+
+    Extension & extension();
+
+    std::shared_ptr<float> mView;
+    Eigen::Index mViewRows = 0;
+
+    std::unique_ptr<Extension> mExt;
+
+    // Allocated upon the first request for the metrics
+    mutable std::unique_ptr<GeometryMetrics> mMetrics;
+    mutable bool mMetricsValid = false;
+
 public:
     uint32_t mid = 0;
     uint32_t bid = 0;
@@ -71,6 +219,65 @@ public:
     virtual TYPE getType() const { return type; }
 };
 
+/**
+ * @brief The GeometryView class is a non-owning and non-allocating range over a subset of a layer's geometry,
+ * described by a list of indices into the layer's geometry. Elements are returned by reference, avoiding any
+ * reference count traffic. A view is invalidated by any subsequent modification of the layer.
+ */
+class SLM_EXPORT GeometryView
+{
+public:
+
+    class const_iterator
+    {
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef LayerGeometry::Ptr value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const LayerGeometry::Ptr * pointer;
+        typedef const LayerGeometry::Ptr & reference;
+
+        const_iterator(const LayerGeometry::Ptr *geoms, const uint32_t *idx) : mGeoms(geoms), mIdx(idx) {}
+
+        reference operator*() const { return mGeoms[*mIdx]; }
+        pointer operator->() const { return &mGeoms[*mIdx]; }
+
+        const_iterator & operator++() { ++mIdx; return *this; }
+        const_iterator operator++(int) { const_iterator tmp(*this); ++mIdx; return tmp; }
+
+        bool operator==(const const_iterator &other) const { return mIdx == other.mIdx; }
+        bool operator!=(const const_iterator &other) const { return mIdx != other.mIdx; }
+
+        uint32_t index() const { return *mIdx; }
+
+    private:
+        const LayerGeometry::Ptr *mGeoms;
+        const uint32_t *mIdx;
+    };
+
+    GeometryView() : mGeoms(nullptr), mBegin(nullptr), mEnd(nullptr) {}
+    GeometryView(const LayerGeometry::Ptr *geoms, const uint32_t *begin, const uint32_t *end) : mGeoms(geoms),
+                                                                                                  mBegin(begin),
+                                                                                                  mEnd(end) {}
+
+    const_iterator begin() const { return const_iterator(mGeoms, mBegin); }
+    const_iterator end()   const { return const_iterator(mGeoms, mEnd); }
+
+    size_t size() const { return mEnd - mBegin; }
+    bool empty() const { return mBegin == mEnd; }
+
+    const LayerGeometry::Ptr & operator[](size_t i) const { return mGeoms[mBegin[i]]; }
+
+    const uint32_t * indices() const { return mBegin; }
+
+    std::vector<LayerGeometry::Ptr> toVector() const { return std::vector<LayerGeometry::Ptr>(begin(), end()); }
+
+private:
+    const LayerGeometry::Ptr *mGeoms;
+    const uint32_t *mBegin;
+    const uint32_t *mEnd;
+};
+
 class SLM_EXPORT Layer
 {
 public:
@@ -99,11 +306,29 @@ public:
         if(!geom)
             return -1;
 
-        mGeometry.push_back(geom);
+        ensureResident();
+        mGeometry.push_back(std::move(geom));
+        indexGeometry(mGeometry.size() - 1);
 
         return mGeometry.size();
     }
 
+    /**
+     * Constructs the geometry in place (within the layer's MemoryArena when assigned) and appends it to the layer
+     */
+    template <class T, class... Args>
+    typename T::Ptr emplaceGeometry(Args&&... args) {
+
+        typename T::Ptr geom = mMemoryArena ? std::allocate_shared<T>(ArenaAllocator<T>(mMemoryArena.get()), std::forward<Args>(args)...)
+                                            : std::make_shared<T>(std::forward<Args>(args)...);
+
+        ensureResident();
+        mGeometry.push_back(geom);
+        indexGeometry(mGeometry.size() - 1);
+
+        return geom;
+    }
+
     void appendGeometry(LayerGeometry::Ptr geom);
 
     int64_t addContourGeometry(LayerGeometry::Ptr geom);
@@ -111,21 +336,162 @@ public:
     int64_t addPntsGeometry(LayerGeometry::Ptr geom);
 
 
-    const std::vector<LayerGeometry::Ptr> & geometry() const { return mGeometry; }
+    /**
+     * With a LayerCache assigned, accessing the geometry of any other layer of the cache may evict this layer,
+     * which releases its geometry. The returned reference, and any GeometryView or coordinates obtained from the
+     * layer, are then invalidated. References to the geometry of a layer held whilst accessing other layers of the
+     * same cache therefore require the layer to be pinned (see pin()).
+     */
+    const std::vector<LayerGeometry::Ptr> & geometry() const { ensureResident(); return mGeometry; }
 
-    std::vector<LayerGeometry::Ptr> & geometryRef()  { return mGeometry; }
+    // Modification through the returned reference requires the cached indices to be regenerated on next access
+    std::vector<LayerGeometry::Ptr> & geometryRef();
 
     void setGeometry(const std::vector<LayerGeometry::Ptr> &geoms);
+    void setGeometry(std::vector<LayerGeometry::Ptr> &&geoms);
+
+    /**
+     * Quantization used by the layer's integer coordinates. quantize() converts the layer's float geometry
+     * to the quantized storage mode (failing for any geometry which cannot be quantized) and dequantize() reverts
+     * all geometry back to float storage.
+     */
+    void setQuantization(const Quantization &quant) { mQuantization = quant; }
+    const Quantization & quantization() const { return mQuantization; }
+    int quantize();
+    void dequantize();
+
+    /**
+     * Contiguous storage mode - the coordinates of the layer are stored within a single arena and the layer's
+     * geometry is replaced by lightweight views into the arena. compact() packs the existing geometry into an arena.
+     */
+    void setGeometryArena(std::shared_ptr<GeometryArena> arena);
+    std::shared_ptr<GeometryArena> geometryArena() const { return mArena; }
+    bool isArenaBacked() const { return mArena != nullptr; }
+    void compact();
+
+    /**
+     * Build-scoped allocation - when a MemoryArena is assigned, geometry and coordinates created via createGeometry
+     * are allocated from the layer's arena and released in a single step when the layer is destroyed or unloaded.
+     * The layer holds the only reference to its arena - the geometry refers to the arena without reference
+     * counting, so arena allocated geometry must not be retained beyond the layer's release of it (copy it
+     * instead). Coordinates of arena allocated geometries must be populated via LayerGeometry::mutableCoordinates().
+     */
+    void setMemoryArena(const MemoryArena::Ptr &arena) { mMemoryArena = arena; }
+    const MemoryArena::Ptr & memoryArena() const { return mMemoryArena; }
+
+    /**
+     * Compression mode - the coordinates of a compressed layer are held delta/varint encoded in memory and are
+     * transparently expanded upon the next access to the layer's geometry. Float coordinates on the grid of the
+     * layer's quantization (the scan resolution) compress considerably better than arbitrary floats. When a
+     * LayerCache is assigned, the number of expanded layers is bounded by the cache, which evicts the least
+     * recently used layers. If the compressed data is corrupt, expand() and load() fail and the layer remains
+     * compressed, with its geometry left empty.
+     */
+    void compress();
+    int expand() { return makeResident(); }
+    void evict();
+    bool isCompressed() const { return mIsCompressed; }
+    size_t compressedSize() const { return mCompressed.size(); }
+
+    void setCache(const std::shared_ptr<LayerCache> &cache);
+    const std::shared_ptr<LayerCache> & cache() const { return mCache; }
+
+    /**
+     * Pins the layer resident, so that it is not evicted by its LayerCache whilst pinned, which may exceed the
+     * cache's budget. Pins are counted, and each must be released by unpin(). pin() fails (returning -1, without
+     * pinning the layer) if the layer cannot be made resident. As with accessing the layers of a cache, pinning is
+     * not synchronised between threads.
+     */
+    int pin() const;
+    void unpin() const;
+    bool isPinned() const { return mNumPins > 0; }
+
+    /**
+     * Deferred loading mode - the geometry of a layer with a loader (e.g. assigned by a Reader which has only indexed
+     * the layer's file position) is loaded by the loader upon the first access to the layer's geometry, or via
+     * load(). If the loader fails, the layer remains deferred, so that it is loaded again on next access.
+     * unload() releases the geometry of a loaded layer, which is loaded again on next access, and is used to evict
+     * the layer from a LayerCache instead of compressing it. Layers modified since being loaded (see markModified)
+     * cannot be unloaded without losing the modifications, so are compressed when evicted and unload() fails. The
+     * cached metrics of the layer remain available whilst unloaded.
+     */
+    typedef std::function<int (Layer &)> Loader;
+
+    void setLoader(const Loader &loader);
+    const Loader & loader() const { return mLoader; }
+    bool isDeferred() const { return mIsDeferred; }
+    bool isModified() const { return mIsModified; }
+    int load();
+    int unload();
+
+    /**
+     * Approximate memory (bytes) used by the layer's geometry whilst resident, cached until the layer is modified
+     */
+    size_t residentBytes() const;
 
     template <class T>
-    std::vector<LayerGeometry::Ptr> getGeometryByType () {
-        std::vector<LayerGeometry::Ptr> geoms;
-        for(LayerGeometry::Ptr geom : mGeometry) {
-            if(geom->getType() == T::type){geoms.push_back(geom);}
+    typename T::Ptr createGeometry(uint32_t mid, uint32_t bid, Eigen::Index numPoints = 0) const {
+
+        if(!mMemoryArena) {
+            typename T::Ptr geom = std::make_shared<T>(mid, bid);
+            geom->coords.resize(numPoints, 2);
+            return geom;
         }
-        return geoms;
+
+        typename T::Ptr geom = std::allocate_shared<T>(ArenaAllocator<T>(mMemoryArena.get()), mid, bid);
+
+        if(numPoints > 0) {
+            // The view does not share ownership of the arena, which is held by the layer alone
+            float *data = static_cast<float *>(mMemoryArena->allocate(2 * numPoints * sizeof(float), 16));
+            geom->setView(std::shared_ptr<float>(std::shared_ptr<float>(), data), numPoints);
+        }
+
+        return geom;
     }
 
+    template <class T>
+    std::vector<LayerGeometry::Ptr> getGeometryByType () const {
+        return geometryOfType(T::type).toVector();
+    }
+
+    /**
+     * Non-allocating typed views over the layer's geometry, served from the per-type index lists
+     */
+    GeometryView geometryOfType(LayerGeometry::TYPE type) const;
+    GeometryView hatchGeometry()   const { return geometryOfType(LayerGeometry::HATCH); }
+    GeometryView contourGeometry() const { return geometryOfType(LayerGeometry::POLYGON); }
+    GeometryView pntsGeometry()    const { return geometryOfType(LayerGeometry::PNTS); }
+
+    template <class T>
+    GeometryView geometryByType() const { return geometryOfType(T::type); }
+
+    /**
+     * Spatial index over the segments of the layer's geometry, built lazily upon first access and discarded when
+     * the layer is modified. See buildSpatialIndices for building the indices of many layers in parallel.
+     */
+    const SpatialIndex & spatialIndex() const;
+    std::vector<uint32_t> queryGeometry(float minX, float minY, float maxX, float maxY) const;
+
+    /**
+     * Aggregated metrics of the layer's geometry, cached until the layer is modified. The cached metrics remain
+     * available without expanding the layer whilst it is compressed. Changing the coordinates of a geometry held
+     * by the layer (e.g. via LayerGeometry::setCoords or mutableCoordinates) leaves these stale until
+     * markModified() is called.
+     */
+    const LayerMetrics & metrics() const;
+
+    /**
+     * Invalidates the cached indices and derived data of the layer, and marks a loaded layer as modified. This must
+     * be called after modifying the coordinates of the layer's geometry in place.
+     */
+    void markModified();
+
+    /**
+     * Non-allocating view of the geometry in scan order. The permutation for each ScanMode is computed once
+     * and cached until the layer is modified.
+     */
+    GeometryView orderedGeometry(ScanMode mode = NONE) const;
+
     std::vector<LayerGeometry::Ptr> getGeometry(ScanMode mode = NONE) const;
     std::vector<LayerGeometry::Ptr> getContourGeometry() const;
     std::vector<LayerGeometry::Ptr> getHatchGeometry() const;
@@ -139,12 +505,48 @@ public:
     uint64_t getLayerId() const { return lid; }
     bool isLoaded() const { return mIsLoaded; }
 
+protected:
+    int ensureResident() const { return (mIsCompressed || mCache || mIsDeferred) ? makeResident() : 0; }
+    int makeResident() const;
+    void discardCompressed();
+    void releaseGeometry();
+
+    void indexGeometry(size_t idx);
+    void updateTypeIndex() const;
+
 protected:
     uint64_t lid = 0;    // Layer ID
     uint64_t z = 0;      // Z Layer Position
     uint64_t mLayerPos;
     std::vector<LayerGeometry::Ptr> mGeometry;
+    std::shared_ptr<GeometryArena> mArena;
+    MemoryArena::Ptr mMemoryArena;
+    Quantization mQuantization;
+    std::shared_ptr<LayerCache> mCache;
+    Loader mLoader;
+    mutable bool mIsDeferred;
+    mutable bool mIsLoading;
+    mutable std::vector<uint8_t> mCompressed;
+    mutable bool mIsCompressed;
     bool mIsLoaded;
+    bool mIsModified;   // Modified since loaded, so that the geometry differs from the file
+    mutable unsigned int mNumPins;
+
+    // Per-type index lists into mGeometry (indexed by LayerGeometry::TYPE)
+    mutable std::vector<uint32_t> mTypeIndex[4];
+    mutable bool mTypeIndexDirty;
+
+    // Cached geometry permutations (indexed by ScanMode)
+    mutable std::vector<uint32_t> mScanOrder[3];
+    mutable bool mScanOrderValid[3];
+
+    mutable std::shared_ptr<SpatialIndex> mSpatialIndex;
+
+    mutable LayerMetrics mMetrics;
+    mutable bool mMetricsValid;
+
+    mutable size_t mResidentBytes;
+    mutable bool mResidentBytesValid;
 };
 
 using HatchGeometry   = slm::LayerGeometryT<LayerGeometry::HATCH>;
@@ -0,0 +1,138 @@
+#include <algorithm>
+#include <vector>
+
+#include "Layer.h"
+#include "LayerCache.h"
+
+using namespace slm;
+
+LayerCache::LayerCache(size_t maxResidentLayers) : mMaxResidentLayers(maxResidentLayers),
+                                                    mMaxResidentBytes(0),
+                                                    mResidentBytes(0)
+{
+}
+
+LayerCache::~LayerCache()
+{
+}
+
+size_t LayerCache::maxResidentLayers() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mMaxResidentLayers;
+}
+
+size_t LayerCache::maxResidentBytes() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mMaxResidentBytes;
+}
+
+size_t LayerCache::numResidentLayers() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mLru.size();
+}
+
+size_t LayerCache::residentBytes() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mResidentBytes;
+}
+
+void LayerCache::setMaxResidentLayers(size_t val)
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mMaxResidentLayers = val;
+    }
+
+    evictToBudget();
+}
+
+void LayerCache::setMaxResidentBytes(size_t val)
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mMaxResidentBytes = val;
+    }
+
+    evictToBudget();
+}
+
+void LayerCache::touch(Layer *layer)
+{
+    // The size of the layer is updated upon each access, as the layer may have been modified since
+    const size_t bytes = layer->residentBytes();
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        auto it = mEntries.find(layer);
+
+        if(it != mEntries.end()) {
+            // Move to the front without reallocating the list node
+            mLru.splice(mLru.begin(), mLru, it->second.it);
+
+            if(it->second.bytes == bytes)
+                return;
+
+            mResidentBytes = mResidentBytes - it->second.bytes + bytes;
+            it->second.bytes = bytes;
+        } else {
+            mLru.push_front(layer);
+            mEntries[layer] = Entry{mLru.begin(), bytes};
+            mResidentBytes += bytes;
+        }
+    }
+
+    evictToBudget();
+}
+
+void LayerCache::remove(Layer *layer)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    auto it = mEntries.find(layer);
+
+    if(it == mEntries.end())
+        return;
+
+    mLru.erase(it->second.it);
+    mResidentBytes -= it->second.bytes;
+    mEntries.erase(it);
+}
+
+bool LayerCache::isOverBudget() const
+{
+    return mLru.size() > mMaxResidentLayers || (mMaxResidentBytes > 0 && mResidentBytes > mMaxResidentBytes);
+}
+
+void LayerCache::evictToBudget()
+{
+    std::vector<Layer *> victims;
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        // The most recently used layer is always retained, as are pinned layers
+        LruList::iterator it = mLru.end();
+
+        while(isOverBudget() && it != mLru.begin()) {
+
+            Layer *layer = *--it;
+
+            if(it == mLru.begin() || layer->isPinned())
+                continue;
+
+            victims.push_back(layer);
+            mResidentBytes -= mEntries[layer].bytes;
+            mEntries.erase(layer);
+            it = mLru.erase(it);
+        }
+    }
+
+    // Layers are evicted outside of the lock, as eviction may call back into the cache
+    for(Layer *layer : victims)
+        layer->evict();
+}
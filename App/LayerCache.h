@@ -0,0 +1,79 @@
+#ifndef SLM_LAYERCACHE_H_HEADER_HAS_BEEN_INCLUDED
+#define SLM_LAYERCACHE_H_HEADER_HAS_BEEN_INCLUDED
+
+#include "SLM_Export.h"
+
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace slm
+{
+
+class Layer;
+
+/**
+ * @brief The LayerCache class governs how many layers remain expanded in memory. Layers assigned to the cache
+ * (via Layer::setCache) are tracked in least-recently-used order as their geometry is accessed. Once the budget is
+ * exceeded, the least recently used layers are evicted (compressed, or unloaded if loaded by a Layer::Loader) and
+ * transparently expanded or loaded on next access.
+ *
+ * The budget is a maximum number of resident layers and optionally a maximum memory (bytes), estimated by
+ * Layer::residentBytes each time a layer is accessed. Evicting a layer releases its geometry, so references to it
+ * must not be held whilst accessing other layers of the cache, unless the layer is pinned.
+ */
+class SLM_EXPORT LayerCache
+{
+public:
+
+    typedef std::shared_ptr<LayerCache> Ptr;
+
+    explicit LayerCache(size_t maxResidentLayers = 16);
+    ~LayerCache();
+
+public:
+
+    void setMaxResidentLayers(size_t val);
+    size_t maxResidentLayers() const;
+    size_t numResidentLayers() const;
+
+    /**
+     * Memory budget in bytes, where zero is unlimited
+     */
+    void setMaxResidentBytes(size_t val);
+    size_t maxResidentBytes() const;
+    size_t residentBytes() const;
+
+    void touch(Layer *layer);
+    void remove(Layer *layer);
+
+    /**
+     * Evicts the least recently used layers until within the budget. The most recently used layer and pinned
+     * layers (see Layer::pin) are retained.
+     */
+    void evictToBudget();
+
+private:
+    typedef std::list<Layer *> LruList;
+
+    struct Entry
+    {
+        LruList::iterator it;
+        size_t bytes;
+    };
+
+    bool isOverBudget() const;
+
+    LruList mLru; // Most recently used layer at the front
+    std::unordered_map<Layer *, Entry> mEntries;
+    size_t mMaxResidentLayers;
+    size_t mMaxResidentBytes;
+    size_t mResidentBytes;
+    mutable std::mutex mMutex;
+};
+
+} // End of Namespace slm
+
+#endif // SLM_LAYERCACHE_H_HEADER_HAS_BEEN_INCLUDED
@@ -0,0 +1,434 @@
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#include "LayerCompression.h"
+
+namespace slm
+{
+
+namespace {
+
+enum StorageKind
+{
+    FLOAT_STORAGE     = 0,
+    QUANTIZED_STORAGE = 1,
+    INSTANCED_STORAGE = 2,
+    GRID_STORAGE      = 3   // Float coordinates lying on the grid of the resolution, encoded as integers
+};
+
+inline uint32_t toBits(float val)
+{
+    uint32_t bits;
+    std::memcpy(&bits, &val, sizeof(bits));
+    return bits;
+}
+
+inline void fromBits(uint32_t bits, float &val) { std::memcpy(&val, &bits, sizeof(val)); }
+
+inline uint32_t zigzag(uint32_t delta)
+{
+    return (delta << 1) ^ (0u - (delta >> 31));
+}
+
+inline uint32_t unzigzag(uint32_t val)
+{
+    return (val >> 1) ^ (0u - (val & 1u));
+}
+
+inline uint64_t zigzag64(int64_t val)
+{
+    return (uint64_t(val) << 1) ^ (0u - (uint64_t(val) >> 63));
+}
+
+inline int64_t unzigzag64(uint64_t val)
+{
+    return int64_t((val >> 1) ^ (0u - (val & 1u)));
+}
+
+template <class T>
+inline void putVarint(std::vector<uint8_t> &buffer, T val)
+{
+    while(val >= 0x80) {
+        buffer.push_back(uint8_t(val | 0x80));
+        val >>= 7;
+    }
+
+    buffer.push_back(uint8_t(val));
+}
+
+template <class T>
+inline bool getVarint(const uint8_t *&ptr, const uint8_t *end, T &val)
+{
+    val = 0;
+
+    for(int shift = 0; shift < int(sizeof(T)) * 8 && ptr != end; shift += 7) {
+        const uint8_t byte = *ptr++;
+        val |= T(byte & 0x7f) << shift;
+
+        if(!(byte & 0x80))
+            return true;
+    }
+
+    return false;
+}
+
+/*
+ * Hatch vectors are predicted from the same end of the previous vectors (stride two), whilst contours and
+ * points are predicted from the previous points
+ */
+inline Eigen::Index predictorStride(const LayerGeometry &geom)
+{
+    return geom.getType() == LayerGeometry::HATCH ? 2 : 1;
+}
+
+inline double gridOffset(const Quantization &quant, Eigen::Index col)
+{
+    return (col == 0) ? quant.offsetX : (col == 1) ? quant.offsetY : 0.0;
+}
+
+inline float fromGrid(int32_t q, double scale, double offset)
+{
+    return float(double(q) * scale + offset);
+}
+
+/*
+ * Float coordinates are encoded via the deltas of their bit patterns, which reproduces them exactly
+ */
+template <class Derived>
+void encodeFloatColumns(std::vector<uint8_t> &buffer, const Eigen::MatrixBase<Derived> &mat, Eigen::Index stride)
+{
+    for(Eigen::Index col = 0; col < mat.cols(); col++) {
+        for(Eigen::Index row = 0; row < mat.rows(); row++) {
+            const uint32_t prev = (row >= stride) ? toBits(mat(row - stride, col)) : 0u;
+            putVarint(buffer, zigzag(toBits(mat(row, col)) - prev));
+        }
+    }
+}
+
+bool decodeFloatColumns(const uint8_t *&ptr, const uint8_t *end, Eigen::MatrixXf &mat, Eigen::Index stride)
+{
+    uint32_t delta;
+
+    for(Eigen::Index col = 0; col < mat.cols(); col++) {
+        for(Eigen::Index row = 0; row < mat.rows(); row++) {
+            if(!getVarint(ptr, end, delta))
+                return false;
+
+            const uint32_t prev = (row >= stride) ? toBits(mat(row - stride, col)) : 0u;
+            fromBits(prev + unzigzag(delta), mat(row, col));
+        }
+    }
+
+    return true;
+}
+
+/*
+ * Integer coordinates are predicted by linear extrapolation of the previous two points, as consecutive hatch
+ * vectors are evenly spaced and their ends follow the boundary of the region, leaving residuals near zero.
+ * Residuals are stored as tokens, the lowest bit of which distinguishes a run of zero residuals (the run length)
+ * from a single non-zero residual (zig-zag encoded).
+ */
+inline int64_t predict(const LayerGeometry::QuantizedCoords &mat, Eigen::Index row, Eigen::Index col,
+                       Eigen::Index stride)
+{
+    if(row >= 2 * stride)
+        return 2 * int64_t(mat(row - stride, col)) - int64_t(mat(row - 2 * stride, col));
+
+    return (row >= stride) ? int64_t(mat(row - stride, col)) : 0;
+}
+
+void encodeIntColumns(std::vector<uint8_t> &buffer, const LayerGeometry::QuantizedCoords &mat, Eigen::Index stride)
+{
+    uint64_t zeroRun = 0;
+
+    for(Eigen::Index col = 0; col < mat.cols(); col++) {
+        for(Eigen::Index row = 0; row < mat.rows(); row++) {
+
+            const int64_t residual = int64_t(mat(row, col)) - predict(mat, row, col, stride);
+
+            if(residual == 0) {
+                zeroRun++;
+                continue;
+            }
+
+            if(zeroRun > 0) {
+                putVarint(buffer, (zeroRun << 1) | 1u);
+                zeroRun = 0;
+            }
+
+            putVarint(buffer, zigzag64(residual) << 1);
+        }
+    }
+
+    if(zeroRun > 0)
+        putVarint(buffer, (zeroRun << 1) | 1u);
+}
+
+/*
+ * Checks that the tokens describe exactly the number of values expected, before the coordinates are allocated
+ */
+bool scanIntColumns(const uint8_t *ptr, const uint8_t *end, uint64_t numValues)
+{
+    uint64_t token;
+    uint64_t count = 0;
+
+    while(count < numValues) {
+        if(!getVarint(ptr, end, token))
+            return false;
+
+        const uint64_t num = (token & 1u) ? (token >> 1) : 1u;
+
+        if(num == 0 || num > numValues - count)
+            return false;
+
+        count += num;
+    }
+
+    return true;
+}
+
+bool decodeIntColumns(const uint8_t *&ptr, const uint8_t *end, LayerGeometry::QuantizedCoords &mat,
+                      Eigen::Index stride)
+{
+    uint64_t token;
+    uint64_t zeroRun = 0;
+
+    for(Eigen::Index col = 0; col < mat.cols(); col++) {
+        for(Eigen::Index row = 0; row < mat.rows(); row++) {
+
+            int64_t residual = 0;
+
+            if(zeroRun > 0) {
+                zeroRun--;
+            } else {
+                if(!getVarint(ptr, end, token))
+                    return false;
+
+                if(token & 1u)
+                    zeroRun = (token >> 1) - 1;
+                else
+                    residual = unzigzag64(token >> 1);
+            }
+
+            const int64_t val = predict(mat, row, col, stride) + residual;
+
+            if(val < std::numeric_limits<int32_t>::min() || val > std::numeric_limits<int32_t>::max())
+                return false;
+
+            mat(row, col) = int32_t(val);
+        }
+    }
+
+    return zeroRun == 0;
+}
+
+/*
+ * Converts float coordinates to integers on the grid of the resolution, only if every coordinate is recovered
+ * exactly by the conversion back, so that encoding remains lossless
+ */
+bool toGrid(const LayerGeometry::ConstCoordsMap &fcoords, const Quantization &quant, LayerGeometry::QuantizedCoords &qcoords)
+{
+    if(!(quant.scale > 0.0))
+        return false;
+
+    qcoords.resize(fcoords.rows(), fcoords.cols());
+
+    for(Eigen::Index col = 0; col < fcoords.cols(); col++) {
+
+        const double offset = gridOffset(quant, col);
+
+        for(Eigen::Index row = 0; row < fcoords.rows(); row++) {
+
+            const float val = fcoords(row, col);
+            const double q = std::round((double(val) - offset) / quant.scale);
+
+            if(!(q >= std::numeric_limits<int32_t>::min() && q <= std::numeric_limits<int32_t>::max()))
+                return false;
+
+            qcoords(row, col) = int32_t(q);
+
+            // Compared bitwise, so that signed zeros are also reproduced
+            if(toBits(fromGrid(qcoords(row, col), quant.scale, offset)) != toBits(val))
+                return false;
+        }
+    }
+
+    return true;
+}
+
+// Reads the dimensions of the coordinates, which must be described by the remaining payload
+bool getDimensions(const uint8_t *&ptr, const uint8_t *end, uint8_t kind, uint32_t &rows, uint32_t &cols)
+{
+    if(!getVarint(ptr, end, rows) || !getVarint(ptr, end, cols))
+        return false;
+
+    if(cols > 2 || (cols == 0 && rows != 0))
+        return false;
+
+    const uint64_t numValues = uint64_t(rows) * uint64_t(cols);
+
+    // Float coordinates occupy at least a byte each
+    if(kind == FLOAT_STORAGE)
+        return numValues <= uint64_t(end - ptr);
+
+    return scanIntColumns(ptr, end, numValues);
+}
+
+bool decodeGeometry(const std::vector<uint8_t> &buffer, const std::vector<LayerGeometry::Ptr> &geoms)
+{
+    const uint8_t *ptr = buffer.data();
+    const uint8_t *end = buffer.data() + buffer.size();
+
+    if(ptr == end)
+        return false;
+
+    Quantization resolution;
+    const bool hasResolution = *ptr++ != 0;
+
+    if(hasResolution) {
+        double vals[3];
+
+        if(size_t(end - ptr) < sizeof(vals))
+            return false;
+
+        std::memcpy(vals, ptr, sizeof(vals));
+        ptr += sizeof(vals);
+
+        resolution.scale = vals[0];
+        resolution.offsetX = vals[1];
+        resolution.offsetY = vals[2];
+    }
+
+    LayerGeometry::QuantizedCoords qcoords;
+
+    for(const LayerGeometry::Ptr &geom : geoms) {
+
+        uint32_t rows, cols;
+
+        if(ptr == end)
+            return false;
+
+        const uint8_t kind = *ptr++;
+
+        if(kind == INSTANCED_STORAGE)
+            continue;
+
+        if(kind > GRID_STORAGE || (kind == GRID_STORAGE && !hasResolution))
+            return false;
+
+        if(!getDimensions(ptr, end, kind, rows, cols))
+            return false;
+
+        const Eigen::Index stride = predictorStride(*geom);
+
+        if(kind == QUANTIZED_STORAGE) {
+            LayerGeometry::QuantizedCoords &coords = geom->quantizedCoordsRef();
+            coords.resize(rows, cols);
+
+            if(!decodeIntColumns(ptr, end, coords, stride))
+                return false;
+
+        } else if(kind == GRID_STORAGE) {
+            qcoords.resize(rows, cols);
+
+            if(!decodeIntColumns(ptr, end, qcoords, stride))
+                return false;
+
+            geom->coords.resize(rows, cols);
+
+            for(Eigen::Index col = 0; col < qcoords.cols(); col++) {
+                const double offset = gridOffset(resolution, col);
+
+                for(Eigen::Index row = 0; row < qcoords.rows(); row++)
+                    geom->coords(row, col) = fromGrid(qcoords(row, col), resolution.scale, offset);
+            }
+
+        } else {
+            geom->coords.resize(rows, cols);
+
+            if(!decodeFloatColumns(ptr, end, geom->coords, stride))
+                return false;
+        }
+    }
+
+    return ptr == end;
+}
+
+} // End of anonymous namespace
+
+void encodeLayerGeometry(const std::vector<LayerGeometry::Ptr> &geoms, std::vector<uint8_t> &buffer,
+                         const Quantization *resolution)
+{
+    buffer.clear();
+
+    // The resolution is stored once, for use by the geometry encoded on its grid
+    buffer.push_back(resolution ? 1 : 0);
+
+    if(resolution) {
+        const double vals[3] = {resolution->scale, resolution->offsetX, resolution->offsetY};
+        const uint8_t *bytes = reinterpret_cast<const uint8_t *>(vals);
+        buffer.insert(buffer.end(), bytes, bytes + sizeof(vals));
+    }
+
+    LayerGeometry::QuantizedCoords qcoords;
+
+    for(const LayerGeometry::Ptr &geom : geoms) {
+
+        const Eigen::Index stride = predictorStride(*geom);
+
+        if(geom->isInstanced()) {
+            // Shared payloads remain in place
+            buffer.push_back(INSTANCED_STORAGE);
+
+        } else if(geom->isQuantized()) {
+            const LayerGeometry::QuantizedCoords &coords = geom->quantizedCoords();
+
+            buffer.push_back(QUANTIZED_STORAGE);
+            putVarint(buffer, uint32_t(coords.rows()));
+            putVarint(buffer, uint32_t(coords.cols()));
+            encodeIntColumns(buffer, coords, stride);
+
+            geom->quantizedCoordsRef().resize(0, 0);
+
+        } else {
+            const LayerGeometry::ConstCoordsMap fcoords = geom->coordinates();
+
+            const bool onGrid = resolution && toGrid(fcoords, *resolution, qcoords);
+
+            buffer.push_back(onGrid ? GRID_STORAGE : FLOAT_STORAGE);
+            putVarint(buffer, uint32_t(fcoords.rows()));
+            putVarint(buffer, uint32_t(fcoords.cols()));
+
+            if(onGrid)
+                encodeIntColumns(buffer, qcoords, stride);
+            else
+                encodeFloatColumns(buffer, fcoords, stride);
+
+            geom->setCoords(Eigen::MatrixXf());
+        }
+    }
+
+    buffer.shrink_to_fit();
+}
+
+bool decodeLayerGeometry(const std::vector<uint8_t> &buffer, const std::vector<LayerGeometry::Ptr> &geoms)
+{
+    if(decodeGeometry(buffer, geoms))
+        return true;
+
+    // Partially decoded coordinates are released, so that the geometry remains as it was whilst encoded
+    for(const LayerGeometry::Ptr &geom : geoms) {
+        if(geom->isInstanced())
+            continue;
+
+        if(geom->isQuantized())
+            geom->quantizedCoordsRef().resize(0, 0);
+        else
+            geom->coords.resize(0, 0);
+    }
+
+    return false;
+}
+
+} // End of Namespace slm
@@ -0,0 +1,33 @@
+#ifndef SLM_LAYERCOMPRESSION_H_HEADER_HAS_BEEN_INCLUDED
+#define SLM_LAYERCOMPRESSION_H_HEADER_HAS_BEEN_INCLUDED
+
+#include "SLM_Export.h"
+
+#include <cstdint>
+#include <vector>
+
+#include "Layer.h"
+
+namespace slm {
+
+/**
+ * Lossless in-memory compression of a layer's coordinates. Each coordinate column is predicted from the previous
+ * points (or the previous hatch vectors for hatch geometry) and the residuals stored as zig-zag varints.
+ * Quantized coordinates, and float coordinates which lie exactly on the grid of the resolution provided (e.g. those
+ * read from machine formats storing scaled integers), are encoded as integers predicted by linear extrapolation,
+ * which leaves residuals near zero for evenly spaced hatch vectors. Other float coordinates are delta encoded via
+ * their bit patterns, which compresses less well. Either way decoding reproduces the coordinates exactly. Instanced
+ * geometry shares its payload and is left untouched.
+ *
+ * Encoding releases the coordinate storage of each geometry, whilst the geometry objects (type, model and build
+ * style) remain in place. Decoding restores the coordinates into the same geometry objects as owned storage, and
+ * fails on truncated or corrupt data without allocating beyond the size of the encoded data, leaving the
+ * geometry as it was whilst encoded (the buffer is not modified, so that decoding may be retried).
+ */
+SLM_EXPORT void encodeLayerGeometry(const std::vector<LayerGeometry::Ptr> &geoms, std::vector<uint8_t> &buffer,
+                                    const Quantization *resolution = nullptr);
+SLM_EXPORT bool decodeLayerGeometry(const std::vector<uint8_t> &buffer, const std::vector<LayerGeometry::Ptr> &geoms);
+
+} // End of Namespace slm
+
+#endif // SLM_LAYERCOMPRESSION_H_HEADER_HAS_BEEN_INCLUDED
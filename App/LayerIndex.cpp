@@ -0,0 +1,166 @@
+#include <algorithm>
+#include <iterator>
+
+#include "LayerIndex.h"
+
+using namespace slm;
+
+LayerIndex::LayerIndex() : mLast(nullptr)
+{
+}
+
+LayerIndex::LayerIndex(const std::vector<Layer::Ptr> &layers) : mLast(nullptr)
+{
+    build(layers);
+}
+
+LayerIndex::~LayerIndex()
+{
+}
+
+void LayerIndex::clear()
+{
+    mByZ.clear();
+    mById.clear();
+    mLast = nullptr;
+}
+
+void LayerIndex::build(const std::vector<Layer::Ptr> &layers)
+{
+    clear();
+    update(layers);
+}
+
+void LayerIndex::update(const std::vector<Layer::Ptr> &layers)
+{
+    const size_t numIndexed = mByZ.size();
+
+    if(layers.size() < numIndexed || (numIndexed > 0 && layers[numIndexed - 1].get() != mLast)) {
+        build(layers);
+        return;
+    }
+
+    if(layers.size() == numIndexed)
+        return;
+
+    EntryList addedZ, addedId;
+    addedZ.reserve(layers.size() - numIndexed);
+    addedId.reserve(layers.size() - numIndexed);
+
+    for(size_t i = numIndexed; i < layers.size(); i++) {
+        Entry entry;
+        entry.layer = layers[i];
+
+        entry.key = layers[i]->getZ();
+        addedZ.push_back(entry);
+
+        entry.key = layers[i]->getLayerId();
+        addedId.push_back(entry);
+    }
+
+    append(mByZ, std::move(addedZ));
+    append(mById, std::move(addedId));
+
+    mLast = layers.back().get();
+}
+
+void LayerIndex::append(EntryList &entries, EntryList &&added)
+{
+    auto byKey = [](const Entry &a, const Entry &b) { return a.key < b.key; };
+
+    // Stable sorting and merging keeps equal keys in the order the layers were indexed
+    std::stable_sort(added.begin(), added.end(), byKey);
+
+    const size_t mid = entries.size();
+
+    entries.insert(entries.end(), std::make_move_iterator(added.begin()), std::make_move_iterator(added.end()));
+
+    if(mid > 0 && entries[mid - 1].key > entries[mid].key)
+        std::inplace_merge(entries.begin(), entries.begin() + mid, entries.end(), byKey);
+}
+
+const LayerIndex::Entry * LayerIndex::find(const EntryList &entries, uint64_t key)
+{
+    auto it = std::lower_bound(entries.cbegin(), entries.cend(), key,
+                               [](const Entry &a, uint64_t val) { return a.key < val; });
+
+    return (it != entries.cend() && it->key == key) ? &(*it) : nullptr;
+}
+
+Layer::Ptr LayerIndex::top(const EntryList &entries)
+{
+    if(entries.empty())
+        return Layer::Ptr();
+
+    // First of the layers sharing the largest key
+    return find(entries, entries.back().key)->layer;
+}
+
+Layer::Ptr LayerIndex::findByZ(uint64_t z) const
+{
+    const Entry *entry = find(mByZ, z);
+    return entry ? entry->layer : Layer::Ptr();
+}
+
+Layer::Ptr LayerIndex::findById(uint64_t id) const
+{
+    const Entry *entry = find(mById, id);
+    return entry ? entry->layer : Layer::Ptr();
+}
+
+std::vector<Layer::Ptr> LayerIndex::rangeByZ(uint64_t zMin, uint64_t zMax) const
+{
+    std::vector<Layer::Ptr> range;
+
+    if(zMin > zMax)
+        return range;
+
+    auto first = std::lower_bound(mByZ.cbegin(), mByZ.cend(), zMin,
+                                  [](const Entry &a, uint64_t val) { return a.key < val; });
+
+    auto last = std::upper_bound(first, mByZ.cend(), zMax,
+                                 [](uint64_t val, const Entry &a) { return val < a.key; });
+
+    range.reserve(size_t(last - first));
+
+    for(auto it = first; it != last; ++it)
+        range.push_back(it->layer);
+
+    return range;
+}
+
+Layer::Ptr LayerIndex::topLayerByZ() const
+{
+    return top(mByZ);
+}
+
+Layer::Ptr LayerIndex::topLayerById() const
+{
+    return top(mById);
+}
+
+Layer::Ptr LayerIndex::findTopLayerByZ(const std::vector<Layer::Ptr> &layers)
+{
+    Layer::Ptr fndLayer;
+
+    for(const Layer::Ptr &layer : layers) {
+
+        if(!fndLayer || layer->getZ() > fndLayer->getZ())
+            fndLayer = layer;
+    }
+
+    return fndLayer;
+}
+
+Layer::Ptr LayerIndex::findTopLayerById(const std::vector<Layer::Ptr> &layers)
+{
+    Layer::Ptr fndLayer;
+
+    for(const Layer::Ptr &layer : layers) {
+
+        if(!fndLayer || layer->getLayerId() > fndLayer->getLayerId())
+            fndLayer = layer;
+    }
+
+    return fndLayer;
+}
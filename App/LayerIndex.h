@@ -0,0 +1,79 @@
+#ifndef SLM_LAYERINDEX_H_HEADER_HAS_BEEN_INCLUDED
+#define SLM_LAYERINDEX_H_HEADER_HAS_BEEN_INCLUDED
+
+#include "SLM_Export.h"
+
+#include <cstdint>
+#include <vector>
+
+#include "Layer.h"
+
+namespace slm
+{
+
+/**
+ * @brief The LayerIndex class provides O(log n) lookups of layers by their Z position and layer id. Layers are
+ * kept in two arrays sorted by key, with ties kept in the order the layers were indexed. update() appends only the
+ * layers added since the previous update, by sorting and merging them into the existing index. A full rebuild is
+ * required (via build()) if indexed layers are removed or reordered, or their Z or id are changed.
+ */
+class SLM_EXPORT LayerIndex
+{
+public:
+
+    LayerIndex();
+    explicit LayerIndex(const std::vector<Layer::Ptr> &layers);
+    ~LayerIndex();
+
+public:
+
+    void build(const std::vector<Layer::Ptr> &layers);
+    void update(const std::vector<Layer::Ptr> &layers);
+    void clear();
+
+    size_t size() const { return mByZ.size(); }
+    bool empty() const { return mByZ.empty(); }
+
+    /**
+     * Lookups return the first indexed layer matching the key, or an empty pointer if there is no such layer
+     */
+    Layer::Ptr findByZ(uint64_t z) const;
+    Layer::Ptr findById(uint64_t id) const;
+
+    /**
+     * Layers with a Z position within the closed range [zMin, zMax], in ascending order of Z
+     */
+    std::vector<Layer::Ptr> rangeByZ(uint64_t zMin, uint64_t zMax) const;
+
+    Layer::Ptr topLayerByZ() const;
+    Layer::Ptr topLayerById() const;
+
+    /**
+     * Linear scans for collections of layers which are not indexed
+     */
+    static Layer::Ptr findTopLayerByZ(const std::vector<Layer::Ptr> &layers);
+    static Layer::Ptr findTopLayerById(const std::vector<Layer::Ptr> &layers);
+
+private:
+
+    struct Entry
+    {
+        uint64_t   key;
+        Layer::Ptr layer;
+    };
+
+    typedef std::vector<Entry> EntryList;
+
+    static void append(EntryList &entries, EntryList &&added);
+    static const Entry * find(const EntryList &entries, uint64_t key);
+    static Layer::Ptr top(const EntryList &entries);
+
+    EntryList mByZ;
+    EntryList mById;
+
+    const Layer *mLast; // Last layer indexed, to detect the collection being changed other than by appending
+};
+
+} // End of Namespace slm
+
+#endif // SLM_LAYERINDEX_H_HEADER_HAS_BEEN_INCLUDED
@@ -0,0 +1,213 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define SLM_POSIX_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "MappedFile.h"
+
+using namespace slm;
+
+MappedFile::MappedFile() : mData(nullptr),
+                           mSize(0),
+                           mMapping(nullptr),
+                           mMapLength(0),
+                           mFd(-1),
+                           mWritable(false)
+{
+}
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+bool MappedFile::isSupported()
+{
+#ifdef SLM_POSIX_MMAP
+    return true;
+#else
+    return false;
+#endif
+}
+
+int MappedFile::mapForRead(const std::string &path, Advice advice)
+{
+    close();
+
+#ifdef SLM_POSIX_MMAP
+    mFd = ::open(path.c_str(), O_RDONLY);
+
+    if(mFd < 0) {
+        std::cerr << "Cannot open file '" << path << "' for mapping - " << std::strerror(errno) << std::endl;
+        return -1;
+    }
+
+    struct stat info;
+
+    if(fstat(mFd, &info) != 0) {
+        std::cerr << "Cannot read the size of file '" << path << "' - " << std::strerror(errno) << std::endl;
+        close();
+        return -1;
+    }
+
+    mMapLength = uint64_t(info.st_size);
+
+    if(mMapLength == 0)
+        return 0;
+
+    mMapping = mmap(nullptr, size_t(mMapLength), PROT_READ, MAP_PRIVATE, mFd, 0);
+
+    if(mMapping == MAP_FAILED) {
+        std::cerr << "Cannot map file '" << path << "' - " << std::strerror(errno) << std::endl;
+        mMapping = nullptr;
+        close();
+        return -1;
+    }
+
+    mData = static_cast<uint8_t *>(mMapping);
+    mSize = mMapLength;
+
+    advise(advice);
+
+    return 0;
+#else
+    std::cerr << "Memory mapped files are not supported on this platform" << std::endl;
+    return -1;
+#endif
+}
+
+int MappedFile::advise(Advice advice)
+{
+    return advise(advice, 0, mSize);
+}
+
+int MappedFile::advise(Advice advice, uint64_t offset, uint64_t size)
+{
+    if(!mData || offset >= mSize)
+        return -1;
+
+#ifdef SLM_POSIX_MMAP
+    int flag = MADV_NORMAL;
+
+    switch(advice) {
+        case SEQUENTIAL: flag = MADV_SEQUENTIAL; break;
+        case RANDOM:     flag = MADV_RANDOM;     break;
+        case WILLNEED:   flag = MADV_WILLNEED;   break;
+        default: break;
+    }
+
+    // The advised range must start on a page boundary
+    const uintptr_t pageSize = uintptr_t(sysconf(_SC_PAGESIZE));
+    const uintptr_t start = reinterpret_cast<uintptr_t>(mData + offset);
+    const uintptr_t alignedStart = start - start % pageSize;
+    const uint64_t length = std::min(size, mSize - offset) + (start - alignedStart);
+
+    return madvise(reinterpret_cast<void *>(alignedStart), size_t(length), flag) == 0 ? 0 : -1;
+#else
+    return -1;
+#endif
+}
+
+int MappedFile::mapForWrite(const std::string &path, uint64_t offset, uint64_t size)
+{
+    close();
+
+#ifdef SLM_POSIX_MMAP
+    mFd = ::open(path.c_str(), O_RDWR);
+
+    if(mFd < 0) {
+        std::cerr << "Cannot open file '" << path << "' for mapping - " << std::strerror(errno) << std::endl;
+        return -1;
+    }
+
+    // The blocks of the region are allocated up front, as writing to a hole of the mapping when the device is full
+    // raises SIGBUS rather than failing. Where unsupported, the file is only extended.
+    int error = EOPNOTSUPP;
+
+#if defined(__linux__)
+    if(size > 0)
+        error = posix_fallocate(mFd, off_t(offset), off_t(size));
+#endif
+
+    if(error == EOPNOTSUPP || error == EINVAL) {
+
+        struct stat info;
+
+        error = 0;
+
+        if(fstat(mFd, &info) != 0 || (uint64_t(info.st_size) < offset + size && ftruncate(mFd, off_t(offset + size)) != 0))
+            error = errno;
+    }
+
+    if(error != 0) {
+        std::cerr << "Cannot resize file '" << path << "' - " << std::strerror(error) << std::endl;
+        close();
+        return -1;
+    }
+
+    // Mappings must start on a page boundary
+    const uint64_t pageSize = uint64_t(sysconf(_SC_PAGESIZE));
+    const uint64_t mapOffset = offset - offset % pageSize;
+
+    mMapLength = size + (offset - mapOffset);
+
+    if(mMapLength == 0) {
+        close();
+        return -1;
+    }
+
+    mMapping = mmap(nullptr, size_t(mMapLength), PROT_READ | PROT_WRITE, MAP_SHARED, mFd, off_t(mapOffset));
+
+    if(mMapping == MAP_FAILED) {
+        std::cerr << "Cannot map file '" << path << "' - " << std::strerror(errno) << std::endl;
+        mMapping = nullptr;
+        close();
+        return -1;
+    }
+
+    mData = static_cast<uint8_t *>(mMapping) + (offset - mapOffset);
+    mSize = size;
+    mWritable = true;
+
+    return 0;
+#else
+    std::cerr << "Memory mapped files are not supported on this platform" << std::endl;
+    return -1;
+#endif
+}
+
+int MappedFile::close()
+{
+    int status = 0;
+
+#ifdef SLM_POSIX_MMAP
+    // Errors writing back the data of a writable mapping are only reported by msync
+    if(mMapping && mWritable && msync(mMapping, size_t(mMapLength), MS_SYNC) != 0) {
+        std::cerr << "Cannot write the mapped region to the file - " << std::strerror(errno) << std::endl;
+        status = -1;
+    }
+
+    if(mMapping && munmap(mMapping, size_t(mMapLength)) != 0)
+        status = -1;
+
+    if(mFd >= 0 && ::close(mFd) != 0)
+        status = -1;
+#endif
+
+    mData = nullptr;
+    mSize = 0;
+    mMapping = nullptr;
+    mMapLength = 0;
+    mFd = -1;
+    mWritable = false;
+
+    return status;
+}
@@ -0,0 +1,78 @@
+#ifndef SLM_MAPPEDFILE_H_HEADER_HAS_BEEN_INCLUDED
+#define SLM_MAPPEDFILE_H_HEADER_HAS_BEEN_INCLUDED
+
+#include "SLM_Export.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace slm
+{
+
+/**
+ * @brief The MappedFile class maps a region of a file into memory. For input, the file is mapped read-only and
+ * the kernel may be advised of the expected access pattern (via madvise). For output, the blocks of the region are
+ * allocated (via posix_fallocate on Linux, otherwise the file is extended via ftruncate) and the region mapped
+ * writable and shared, so that data written to the mapping is written to the file. Closing a writable mapping
+ * synchronises it with the file (via msync) and fails if the data could not be written. Memory mapping is only
+ * available on POSIX platforms, otherwise opening the mapping fails and callers should use regular file I/O instead.
+ */
+class SLM_EXPORT MappedFile
+{
+public:
+
+    enum Advice {
+        NORMAL     = 0,
+        SEQUENTIAL = 1,
+        RANDOM     = 2,
+        WILLNEED   = 3
+    };
+
+    MappedFile();
+    ~MappedFile();
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile & operator=(const MappedFile &) = delete;
+
+public:
+
+    static bool isSupported();
+
+    /**
+     * Maps an entire file for reading. An empty file is opened without a mapping.
+     */
+    int mapForRead(const std::string &path, Advice advice = NORMAL);
+
+    /**
+     * Maps the region [offset, offset + size) of an existing file for writing, extending the file if smaller
+     */
+    int mapForWrite(const std::string &path, uint64_t offset, uint64_t size);
+
+    int close();
+
+    /**
+     * Advises the kernel of the access pattern of the mapping or a region of it (e.g. WILLNEED to prefetch)
+     */
+    int advise(Advice advice);
+    int advise(Advice advice, uint64_t offset, uint64_t size);
+
+    bool isOpen() const { return mFd >= 0; }
+
+    uint8_t * data() const { return mData; }
+    const uint8_t * constData() const { return mData; }
+    uint64_t size() const { return mSize; }
+
+private:
+    uint8_t *mData;      // Start of the requested region
+    uint64_t mSize;
+
+    void    *mMapping;   // Start of the page aligned mapping
+    uint64_t mMapLength;
+    int      mFd;
+    bool     mWritable;
+};
+
+} // End of Namespace slm
+
+#endif // SLM_MAPPEDFILE_H_HEADER_HAS_BEEN_INCLUDED
@@ -0,0 +1,68 @@
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+
+#include "MemoryArena.h"
+
+using namespace slm;
+
+MemoryArena::MemoryArena(size_t initialBlockSize, size_t maxBlockSize) : mCur(nullptr),
+                                                                         mRemaining(0),
+                                                                         mNextBlockSize(initialBlockSize),
+                                                                         mMaxBlockSize(std::max(initialBlockSize, maxBlockSize)),
+                                                                         mBytesAllocated(0),
+                                                                         mBytesReserved(0)
+{
+}
+
+MemoryArena::~MemoryArena()
+{
+    release();
+}
+
+void MemoryArena::addBlock(size_t minSize)
+{
+    // Oversized requests are given a dedicated block
+    size_t blockSize = std::max(mNextBlockSize, minSize);
+
+    char *block = static_cast<char *>(std::malloc(blockSize));
+
+    if(!block)
+        throw std::bad_alloc();
+
+    mBlocks.push_back(block);
+    mCur = block;
+    mRemaining = blockSize;
+    mBytesReserved += blockSize;
+
+    mNextBlockSize = std::min(2 * mNextBlockSize, mMaxBlockSize);
+}
+
+void * MemoryArena::allocate(size_t bytes, size_t alignment)
+{
+    size_t padding = (alignment - reinterpret_cast<uintptr_t>(mCur) % alignment) % alignment;
+
+    if(!mCur || padding + bytes > mRemaining) {
+        addBlock(bytes + alignment);
+        padding = (alignment - reinterpret_cast<uintptr_t>(mCur) % alignment) % alignment;
+    }
+
+    char *ptr = mCur + padding;
+    mCur += padding + bytes;
+    mRemaining -= padding + bytes;
+    mBytesAllocated += bytes;
+
+    return ptr;
+}
+
+void MemoryArena::release()
+{
+    for(char *block : mBlocks)
+        std::free(block);
+
+    mBlocks.clear();
+    mCur = nullptr;
+    mRemaining = 0;
+    mBytesAllocated = 0;
+    mBytesReserved = 0;
+}
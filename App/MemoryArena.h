@@ -0,0 +1,91 @@
+#ifndef SLM_MEMORYARENA_H_HEADER_HAS_BEEN_INCLUDED
+#define SLM_MEMORYARENA_H_HEADER_HAS_BEEN_INCLUDED
+
+#include "SLM_Export.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace slm
+{
+
+/**
+ * @brief The MemoryArena class is a monotonic (bump-pointer) memory resource. Allocations are never individually
+ * freed; instead all memory is released in bulk when the arena is destroyed. Blocks grow geometrically so that
+ * arenas used for small layers remain small. The arena is not thread-safe.
+ */
+class SLM_EXPORT MemoryArena
+{
+public:
+
+    typedef std::shared_ptr<MemoryArena> Ptr;
+
+    explicit MemoryArena(size_t initialBlockSize = 4096, size_t maxBlockSize = 1 << 16);
+    ~MemoryArena();
+
+    MemoryArena(const MemoryArena &) = delete;
+    MemoryArena & operator=(const MemoryArena &) = delete;
+
+public:
+
+    void * allocate(size_t bytes, size_t alignment = alignof(std::max_align_t));
+
+    /**
+     * Getters
+     */
+    size_t bytesAllocated() const { return mBytesAllocated; }
+    size_t bytesReserved() const { return mBytesReserved; }
+    size_t numBlocks() const { return mBlocks.size(); }
+
+private:
+    void addBlock(size_t minSize);
+    void release();
+
+    std::vector<char *> mBlocks;
+    char   *mCur;
+    size_t mRemaining;
+    size_t mNextBlockSize;
+    size_t mMaxBlockSize;
+    size_t mBytesAllocated;
+    size_t mBytesReserved;
+};
+
+/**
+ * @brief ArenaAllocator is a minimal standard allocator drawing from a MemoryArena, for use with std::allocate_shared
+ * and the standard containers. The allocator does not own the arena (so that copying it is free), hence the arena
+ * must outlive every object allocated from it. Deallocation is a no-op.
+ */
+template <class T>
+class ArenaAllocator
+{
+public:
+    typedef T value_type;
+
+    template <class U>
+    struct rebind { typedef ArenaAllocator<U> other; };
+
+    ArenaAllocator(MemoryArena *arena) : mArena(arena) {}
+
+    template <class U>
+    ArenaAllocator(const ArenaAllocator<U> &other) : mArena(other.arena()) {}
+
+    T * allocate(size_t n) { return static_cast<T *>(mArena->allocate(n * sizeof(T), alignof(T))); }
+    void deallocate(T *, size_t) {}
+
+    MemoryArena * arena() const { return mArena; }
+
+private:
+    MemoryArena *mArena;
+};
+
+template <class T, class U>
+bool operator==(const ArenaAllocator<T> &a, const ArenaAllocator<U> &b) { return a.arena() == b.arena(); }
+
+template <class T, class U>
+bool operator!=(const ArenaAllocator<T> &a, const ArenaAllocator<U> &b) { return a.arena() != b.arena(); }
+
+} // End of Namespace slm
+
+#endif // SLM_MEMORYARENA_H_HEADER_HAS_BEEN_INCLUDED
@@ -54,15 +54,47 @@ void BuildStyle::setStyle(uint64_t bid,
 
 
 Model::Model() : id(0),
-                 topSliceNum(0)
+                 topSliceNum(0),
+                 mNumIndexedStyles(0),
+                 mBuildStylesShared(false)
 {
 }
 
 Model::Model(uint64_t mid, uint64_t topSliceNum) : id(mid),
-                                                   topSliceNum(topSliceNum)
+                                                   topSliceNum(topSliceNum),
+                                                   mNumIndexedStyles(0),
+                                                   mBuildStylesShared(false)
 {
 }
 
+Model::Model(const Model &other) : id(other.id),
+                                   topSliceNum(other.topSliceNum),
+                                   name(other.name),
+                                   buildStyleName(other.buildStyleName),
+                                   buildStyleDescription(other.buildStyleDescription),
+                                   mBuildStyles(other.mBuildStyles),
+                                   mNumIndexedStyles(0),
+                                   mBuildStylesShared(false)
+{
+    indexBuildStyles();
+}
+
+Model & Model::operator=(const Model &other)
+{
+    if(this == &other)
+        return *this;
+
+    id = other.id;
+    topSliceNum = other.topSliceNum;
+    name = other.name;
+    buildStyleName = other.buildStyleName;
+    buildStyleDescription = other.buildStyleDescription;
+
+    setBuildStyles(other.getBuildStyles());
+
+    return *this;
+}
+
 Model::~Model()
 {
 }
@@ -84,16 +116,82 @@ std::string Model::getBuildStlyeDescriptionAsString() const
 
 void Model::clear()
 {
+    std::lock_guard<std::mutex> lock(mBuildStyleIndexMutex);
+
     this->mBuildStyles.clear();
+    this->mBuildStyleIndex.clear();
+    this->mBuildStylesShared = false;
+    this->mNumIndexedStyles = 0;
+}
+
+void Model::setBuildStyles(const std::vector<BuildStyle::Ptr> &bstyles)
+{
+    std::lock_guard<std::mutex> lock(mBuildStyleIndexMutex);
+
+    mBuildStyles = bstyles;
+    mBuildStylesShared = false;
+    indexBuildStyles();
+}
+
+void Model::setBuildStyles(std::vector<BuildStyle::Ptr> &&bstyles)
+{
+    std::lock_guard<std::mutex> lock(mBuildStyleIndexMutex);
+
+    mBuildStyles = std::move(bstyles);
+    mBuildStylesShared = false;
+    indexBuildStyles();
+}
+
+void Model::indexBuildStyles() const
+{
+    mBuildStyleIndex.clear();
+    mBuildStyleIndex.reserve(mBuildStyles.size());
+
+    // The first build style with a given id takes precedence
+    for(size_t i = 0; i < mBuildStyles.size(); i++) {
+        if(mBuildStyles[i])
+            mBuildStyleIndex.emplace(mBuildStyles[i]->id, i);
+    }
+
+    mNumIndexedStyles = mBuildStyles.size();
 }
 
 BuildStyle::Ptr Model::getBuildStyleById(const uint64_t bid) const
 {
-    auto result = std::find_if(std::begin(mBuildStyles), std::end(mBuildStyles),
-                             [&](BuildStyle::Ptr bstyle){return bstyle->id == bid;});
+    std::lock_guard<std::mutex> lock(mBuildStyleIndexMutex);
+    return findBuildStyle(bid);
+}
+
+BuildStyle::Ptr Model::findBuildStyle(const uint64_t bid) const
+{
+    if(mNumIndexedStyles != mBuildStyles.size())
+        indexBuildStyles();
+
+    auto result = mBuildStyleIndex.find(bid);
+
+    // The index is verified against the build styles, which may have been modified via buildStylesRef()
+    const bool found = (result != mBuildStyleIndex.end()) &&
+                       (result->second < mBuildStyles.size()) &&
+                       mBuildStyles[result->second] &&
+                       (mBuildStyles[result->second]->id == bid);
+
+    if(found)
+        return mBuildStyles[result->second];
+
+    if(result == mBuildStyleIndex.end() && !mBuildStylesShared)
+        return BuildStyle::Ptr(nullptr);
+
+    /*
+     * The rebuilt index reflects any modifications made via buildStylesRef() so far, hence later unsuccessful
+     * lookups (e.g. whilst adding build styles) do not rebuild it again
+     */
+    indexBuildStyles();
+    mBuildStylesShared = false;
+
+    result = mBuildStyleIndex.find(bid);
 
-    if (result != std::end(mBuildStyles)) {
-        return *result;
+    if (result != mBuildStyleIndex.end()) {
+        return mBuildStyles[result->second];
     } else {
         return BuildStyle::Ptr(nullptr);
     }
@@ -105,13 +203,14 @@ int64_t Model::addBuildStyle(BuildStyle::Ptr bstyle)
     if(!bstyle)
         return -1;
 
-    auto result = std::find_if(std::begin(mBuildStyles), std::end(mBuildStyles),
-                             [&](BuildStyle::Ptr b){return bstyle->id == b->id;});
+    std::lock_guard<std::mutex> lock(mBuildStyleIndexMutex);
 
-    if (result != std::end(mBuildStyles))
+    if(findBuildStyle(bstyle->id))
         return -1;
 
-    mBuildStyles.push_back(bstyle);
+    mBuildStyleIndex.emplace(bstyle->id, mBuildStyles.size());
+    mBuildStyles.push_back(std::move(bstyle));
+    mNumIndexedStyles = mBuildStyles.size();
 
     return mBuildStyles.size();
 }
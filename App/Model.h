@@ -6,7 +6,9 @@
 #include <cstdint>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace slm
@@ -67,8 +69,11 @@ class SLM_EXPORT Model
 public:
     Model();
     Model(uint64_t mid, uint64_t topSliceNum);
+    Model(const Model &other);
     ~Model();
 
+    Model & operator=(const Model &other);
+
 public:
     typedef std::shared_ptr<Model> Ptr;
     typedef std::map<uint64_t, BuildStyle::Ptr> BStyleMap;
@@ -120,11 +125,22 @@ public:
     /*
      * Build Style Getters
      */
-     void setBuildStyles(const std::vector<BuildStyle::Ptr> &bstyles) { mBuildStyles = bstyles; }
-
-     std::vector<BuildStyle::Ptr> getBuildStyles() const { return mBuildStyles; }
+     void setBuildStyles(const std::vector<BuildStyle::Ptr> &bstyles);
+     void setBuildStyles(std::vector<BuildStyle::Ptr> &&bstyles);
+
+     /**
+      * Build styles are found via an index by id, which is verified upon each lookup. Once buildStylesRef() has
+      * been taken the build styles may be modified through it, so that the next unsuccessful lookup rebuilds the
+      * index. Build styles replaced in place after that rebuild (without changing their number) require
+      * buildStylesRef() to be taken again. Lookups are safe to call concurrently.
+      */
+     const std::vector<BuildStyle::Ptr> & getBuildStyles() const { return mBuildStyles; }
      BuildStyle::Ptr getBuildStyleById(const uint64_t bid) const;
-     std::vector<BuildStyle::Ptr>  & buildStylesRef() { return mBuildStyles; }
+     std::vector<BuildStyle::Ptr>  & buildStylesRef() {
+         std::lock_guard<std::mutex> lock(mBuildStyleIndexMutex);
+         mBuildStylesShared = true;
+         return mBuildStyles;
+     }
 
     /**
      * Setters
@@ -147,6 +163,17 @@ protected:
     //BStyleMap buildStyles;
 
     std::vector<BuildStyle::Ptr> mBuildStyles;
+
+    void indexBuildStyles() const;
+    BuildStyle::Ptr findBuildStyle(const uint64_t bid) const;
+
+    // Position of each build style by id
+    mutable std::unordered_map<uint64_t, size_t> mBuildStyleIndex;
+    mutable size_t mNumIndexedStyles;
+    mutable std::mutex mBuildStyleIndexMutex;
+
+    // Set once the build styles are exposed by reference via buildStylesRef(), until the index is next rebuilt
+    mutable bool mBuildStylesShared;
 };
 
 } // End of SLM Namespace
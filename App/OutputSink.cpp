@@ -0,0 +1,305 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define SLM_POSIX_IO
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include "OutputSink.h"
+
+using namespace slm;
+
+namespace {
+
+// Alignment and size granularity of buffers for direct I/O
+const size_t BlockSize = 4096;
+
+char * alignedBuffer(std::unique_ptr<char[]> &storage, size_t size)
+{
+    storage.reset(new char[size + BlockSize]);
+
+    const uintptr_t addr = reinterpret_cast<uintptr_t>(storage.get());
+    return storage.get() + (BlockSize - addr % BlockSize) % BlockSize;
+}
+
+} // End of anonymous namespace
+
+OutputSink::OutputSink(size_t bufferSize) : mFront(nullptr),
+                                            mBack(nullptr),
+                                            mFrontSize(0),
+                                            mBackSize(0),
+                                            mBufferSize(std::max<size_t>((bufferSize + BlockSize - 1) / BlockSize, 1) * BlockSize),
+                                            mFileOffset(0),
+                                            mBackOffset(0),
+                                            mIsOpen(false),
+                                            mDirectIO(false),
+                                            mBackPending(false),
+                                            mStop(false),
+                                            mError(false),
+                                            mFd(-1),
+                                            mFile(nullptr)
+{
+}
+
+OutputSink::~OutputSink()
+{
+    if(mIsOpen)
+        close();
+}
+
+int OutputSink::open(const std::string &path, bool directIO)
+{
+    if(mIsOpen)
+        close();
+
+    mFileOffset = 0;
+    mFrontSize = 0;
+    mBackSize = 0;
+    mBackPending = false;
+    mStop = false;
+    mError = false;
+    mDirectIO = false;
+
+#ifdef SLM_POSIX_IO
+    const int flags = O_WRONLY | O_CREAT | O_TRUNC;
+
+#ifdef O_DIRECT
+    if(directIO) {
+        mFd = ::open(path.c_str(), flags | O_DIRECT, 0644);
+        mDirectIO = (mFd >= 0);
+    }
+#endif
+
+    // Direct I/O is not supported by every file system (e.g. tmpfs)
+    if(mFd < 0)
+        mFd = ::open(path.c_str(), flags, 0644);
+
+    if(mFd < 0) {
+        std::cerr << "Cannot open file '" << path << "' for writing - " << std::strerror(errno) << std::endl;
+        return -1;
+    }
+#else
+    mFile = std::fopen(path.c_str(), "wb");
+
+    if(!mFile) {
+        std::cerr << "Cannot open file '" << path << "' for writing" << std::endl;
+        return -1;
+    }
+#endif
+
+    if(!mFront) {
+        mFront = alignedBuffer(mFrontStorage, mBufferSize);
+        mBack = alignedBuffer(mBackStorage, mBufferSize);
+    }
+
+    mIsOpen = true;
+    mThread = std::thread(&OutputSink::run, this);
+
+    return 0;
+}
+
+int OutputSink::close()
+{
+    if(!mIsOpen)
+        return -1;
+
+    const int status = flush();
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStop = true;
+    }
+
+    mCondition.notify_all();
+    mThread.join();
+
+#ifdef SLM_POSIX_IO
+    if(::close(mFd) != 0)
+        setError(std::string("Cannot close file - ") + std::strerror(errno));
+
+    mFd = -1;
+#else
+    if(std::fclose(mFile) != 0)
+        setError("Cannot close file");
+
+    mFile = nullptr;
+#endif
+
+    mIsOpen = false;
+
+    return (status == 0 && !hasError()) ? 0 : -1;
+}
+
+bool OutputSink::hasError() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mError;
+}
+
+void OutputSink::setError(const std::string &msg)
+{
+    std::cerr << "Output error - " << msg << std::endl;
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    mError = true;
+}
+
+int OutputSink::write(const void *data, size_t size)
+{
+    if(!mIsOpen)
+        return -1;
+
+    const char *src = static_cast<const char *>(data);
+
+    while(size > 0) {
+
+        const size_t num = std::min(size, mBufferSize - mFrontSize);
+
+        std::memcpy(mFront + mFrontSize, src, num);
+        mFrontSize += num;
+        src += num;
+        size -= num;
+
+        if(mFrontSize == mBufferSize && submit(false) != 0)
+            return -1;
+    }
+
+    return 0;
+}
+
+int OutputSink::submit(bool wait)
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+
+    // Backpressure: the back buffer must have been written before it can be reused
+    mCondition.wait(lock, [this]() { return !mBackPending; });
+
+    if(mError)
+        return -1;
+
+    std::swap(mFront, mBack);
+    std::swap(mFrontStorage, mBackStorage);
+
+    mBackSize = mFrontSize;
+    mBackOffset = mFileOffset;
+    mFileOffset += mFrontSize;
+    mFrontSize = 0;
+    mBackPending = true;
+
+    mCondition.notify_all();
+
+    if(wait)
+        mCondition.wait(lock, [this]() { return !mBackPending; });
+
+    return mError ? -1 : 0;
+}
+
+int OutputSink::flush()
+{
+    if(!mIsOpen)
+        return -1;
+
+    if(mFrontSize > 0)
+        return submit(true);
+
+    std::unique_lock<std::mutex> lock(mMutex);
+    mCondition.wait(lock, [this]() { return !mBackPending; });
+
+    return mError ? -1 : 0;
+}
+
+int OutputSink::writeAt(uint64_t offset, const void *data, size_t size)
+{
+    if(offset + size > position()) {
+        std::cerr << "Output error - cannot overwrite beyond the data written" << std::endl;
+        return -1;
+    }
+
+    // Once flushed, the background thread is idle and the file may be written directly
+    if(flush() != 0)
+        return -1;
+
+    return writeFile(offset, static_cast<const char *>(data), size);
+}
+
+int OutputSink::reserve(uint64_t size)
+{
+    if(flush() != 0)
+        return -1;
+
+    // The front buffer is empty once flushed
+    mFileOffset += size;
+
+    return 0;
+}
+
+void OutputSink::run()
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+
+    for(;;) {
+        mCondition.wait(lock, [this]() { return mBackPending || mStop; });
+
+        if(!mBackPending)
+            return;
+
+        const char *data = mBack;
+        const size_t size = mBackSize;
+        const uint64_t offset = mBackOffset;
+
+        lock.unlock();
+        writeFile(offset, data, size);
+        lock.lock();
+
+        mBackPending = false;
+        mCondition.notify_all();
+    }
+}
+
+int OutputSink::writeFile(uint64_t offset, const char *data, size_t size)
+{
+#ifdef SLM_POSIX_IO
+
+#ifdef O_DIRECT
+    // Direct I/O requires whole blocks, so it is disabled for the remaining partial writes (e.g. the final block)
+    if(mDirectIO && (offset % BlockSize != 0 || size % BlockSize != 0)) {
+        fcntl(mFd, F_SETFL, fcntl(mFd, F_GETFL) & ~O_DIRECT);
+        mDirectIO = false;
+    }
+#endif
+
+    while(size > 0) {
+        const ssize_t num = ::pwrite(mFd, data, size, off_t(offset));
+
+        if(num < 0) {
+            if(errno == EINTR)
+                continue;
+
+            setError(std::strerror(errno));
+            return -1;
+        }
+
+        data += num;
+        offset += uint64_t(num);
+        size -= size_t(num);
+    }
+#else
+
+#ifdef _MSC_VER
+    const int seekStatus = _fseeki64(mFile, int64_t(offset), SEEK_SET);
+#else
+    const int seekStatus = std::fseek(mFile, long(offset), SEEK_SET);
+#endif
+
+    if(seekStatus != 0 || std::fwrite(data, 1, size, mFile) != size) {
+        setError("Cannot write to file");
+        return -1;
+    }
+#endif
+
+    return 0;
+}
@@ -0,0 +1,112 @@
+#ifndef SLM_OUTPUTSINK_H_HEADER_HAS_BEEN_INCLUDED
+#define SLM_OUTPUTSINK_H_HEADER_HAS_BEEN_INCLUDED
+
+#include "SLM_Export.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace slm
+{
+
+/**
+ * @brief The OutputSink class is a double-buffered asynchronous file output. Data is appended to the front buffer
+ * on the calling thread, whilst a background thread writes the back buffer to the file. Once the front buffer is
+ * full, the buffers are exchanged when the background thread has finished writing the previous buffer, which
+ * applies backpressure to the caller. An error writing to the file is retained and reported by subsequent calls.
+ *
+ * On Linux, the file may optionally be opened with O_DIRECT to bypass the page cache, in which case the buffers
+ * are aligned and written in whole blocks.
+ */
+class SLM_EXPORT OutputSink
+{
+public:
+
+    explicit OutputSink(size_t bufferSize = 4 << 20);
+    ~OutputSink();
+
+    OutputSink(const OutputSink &) = delete;
+    OutputSink & operator=(const OutputSink &) = delete;
+
+public:
+
+    int open(const std::string &path, bool directIO = false);
+    int close();
+
+    /**
+     * Appends data to the file. Returns zero or -1 if an error has occurred.
+     */
+    int write(const void *data, size_t size);
+
+    template <class T>
+    int writeValue(const T &val) { return write(&val, sizeof(T)); }
+
+    /**
+     * Overwrites data previously written at the offset (e.g. to patch offset tables), after waiting for the
+     * buffered data to be written
+     */
+    int writeAt(uint64_t offset, const void *data, size_t size);
+
+    /**
+     * Reserves a region of the given size at the current position, after waiting for the buffered data to be
+     * written, so that it may be filled separately (e.g. via writeAt() or a MappedFile). Subsequent data is
+     * appended after the region.
+     */
+    int reserve(uint64_t size);
+
+    /**
+     * Waits until all data appended has been written to the file
+     */
+    int flush();
+
+    bool isOpen() const { return mIsOpen; }
+    bool isDirectIO() const { return mDirectIO.load(); }
+    bool hasError() const;
+
+    /**
+     * Number of bytes appended to the file
+     */
+    uint64_t position() const { return mFileOffset + mFrontSize; }
+
+private:
+
+    void run();
+    int submit(bool wait);
+    int writeFile(uint64_t offset, const char *data, size_t size);
+    void setError(const std::string &msg);
+
+    std::unique_ptr<char[]> mFrontStorage;
+    std::unique_ptr<char[]> mBackStorage;
+
+    char  *mFront; // Block aligned within the storage
+    char  *mBack;
+    size_t mFrontSize;
+    size_t mBackSize;
+    size_t mBufferSize;
+
+    uint64_t mFileOffset; // Offset of the front buffer within the file
+    uint64_t mBackOffset;
+
+    bool mIsOpen;
+    std::atomic<bool> mDirectIO;
+    bool mBackPending;
+    bool mStop;
+    bool mError;
+
+    int   mFd;
+    FILE *mFile;
+
+    std::thread mThread;
+    mutable std::mutex mMutex;
+    std::condition_variable mCondition;
+};
+
+} // End of Namespace slm
+
+#endif // SLM_OUTPUTSINK_H_HEADER_HAS_BEEN_INCLUDED
@@ -0,0 +1,192 @@
+#ifndef SLM_PARALLEL_H_HEADER_HAS_BEEN_INCLUDED
+#define SLM_PARALLEL_H_HEADER_HAS_BEEN_INCLUDED
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace slm {
+
+inline unsigned int defaultNumThreads()
+{
+    const unsigned int numThreads = std::thread::hardware_concurrency();
+    return numThreads > 0 ? numThreads : 1;
+}
+
+/**
+ * Executes fn(i) for each i in [0, n) across a number of threads (hardware concurrency when zero). Indices are
+ * distributed dynamically in chunks of grainSize, so that uneven layers are balanced across threads. The first
+ * exception thrown by any invocation is rethrown on the calling thread once all threads have completed.
+ */
+template <class Function>
+void parallelFor(size_t n, Function fn, unsigned int numThreads = 0, size_t grainSize = 1)
+{
+    if(n == 0)
+        return;
+
+    if(numThreads == 0)
+        numThreads = defaultNumThreads();
+
+    grainSize = std::max<size_t>(grainSize, 1);
+    numThreads = unsigned(std::min<size_t>(numThreads, (n + grainSize - 1) / grainSize));
+
+    if(numThreads <= 1) {
+        for(size_t i = 0; i < n; i++)
+            fn(i);
+
+        return;
+    }
+
+    std::atomic<size_t> next(0);
+    std::exception_ptr error;
+    std::mutex errorMutex;
+
+    auto worker = [&]() {
+        for(;;) {
+            const size_t start = next.fetch_add(grainSize);
+
+            if(start >= n)
+                return;
+
+            const size_t end = std::min(start + grainSize, n);
+
+            try {
+                for(size_t i = start; i < end; i++)
+                    fn(i);
+            } catch(...) {
+                std::lock_guard<std::mutex> lock(errorMutex);
+
+                if(!error)
+                    error = std::current_exception();
+
+                next = n; // Abandon the remaining work
+                return;
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(numThreads - 1);
+
+    for(unsigned int i = 0; i < numThreads - 1; i++)
+        threads.emplace_back(worker);
+
+    worker();
+
+    for(std::thread &thread : threads)
+        thread.join();
+
+    if(error)
+        std::rethrow_exception(error);
+}
+
+/**
+ * @brief The WorkerPool class holds a number of worker threads (hardware concurrency when zero), which are started
+ * once and fed tasks through a queue bounded to a capacity (four tasks per thread when zero). Unlike parallelFor,
+ * which starts its threads on every call, a pool may be reused across many small rounds of work. Each task's result,
+ * or the exception it threw, is obtained from the future returned by submit(). The threads are joined once the
+ * queued tasks have completed upon destruction.
+ */
+class WorkerPool
+{
+public:
+    explicit WorkerPool(unsigned int numThreads = 0, size_t capacity = 0) : mStop(false)
+    {
+        if(numThreads == 0)
+            numThreads = defaultNumThreads();
+
+        mCapacity = capacity > 0 ? capacity : size_t(numThreads) * 4;
+
+        mThreads.reserve(numThreads);
+
+        for(unsigned int i = 0; i < numThreads; i++)
+            mThreads.emplace_back(&WorkerPool::run, this);
+    }
+
+    ~WorkerPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mStop = true;
+        }
+
+        mWorkReady.notify_all();
+
+        for(std::thread &thread : mThreads)
+            thread.join();
+    }
+
+    WorkerPool(const WorkerPool &) = delete;
+    WorkerPool & operator=(const WorkerPool &) = delete;
+
+    unsigned int numThreads() const { return unsigned(mThreads.size()); }
+    size_t capacity() const { return mCapacity; }
+
+    /**
+     * Queues fn() to be called on a worker thread, blocking whilst the queue is full
+     */
+    template <class Function>
+    std::future<typename std::result_of<Function()>::type> submit(Function fn)
+    {
+        typedef typename std::result_of<Function()>::type Result;
+
+        // std::function requires a copyable target, whereas the packaged task may only be moved
+        std::shared_ptr<std::packaged_task<Result()> > task = std::make_shared<std::packaged_task<Result()> >(fn);
+        std::future<Result> result = task->get_future();
+
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mSpaceReady.wait(lock, [this]() { return mQueue.size() < mCapacity; });
+            mQueue.push_back([task]() { (*task)(); });
+        }
+
+        mWorkReady.notify_one();
+
+        return result;
+    }
+
+private:
+    void run()
+    {
+        for(;;) {
+            std::function<void()> task;
+
+            {
+                std::unique_lock<std::mutex> lock(mMutex);
+                mWorkReady.wait(lock, [this]() { return mStop || !mQueue.empty(); });
+
+                if(mQueue.empty())
+                    return;
+
+                task = std::move(mQueue.front());
+                mQueue.pop_front();
+            }
+
+            mSpaceReady.notify_one();
+            task();
+        }
+    }
+
+    std::vector<std::thread> mThreads;
+    std::deque<std::function<void()> > mQueue;
+    size_t mCapacity;
+    bool mStop;
+
+    std::mutex mMutex;
+    std::condition_variable mWorkReady;
+    std::condition_variable mSpaceReady;
+};
+
+} // End of Namespace slm
+
+#endif // SLM_PARALLEL_H_HEADER_HAS_BEEN_INCLUDED
@@ -1,5 +1,7 @@
 #include <algorithm>
 #include <iostream>
+#include <iterator>
+#include <limits>
 #include <fstream>
 
 #include <filesystem/fwd.h>
@@ -9,6 +11,7 @@
 
 #include "Layer.h"
 #include "Model.h"
+#include "Parallel.h"
 
 #include "Reader.h"
 
@@ -17,17 +20,37 @@ using namespace base;
 
 namespace fs = filesystem;
 
-Reader::Reader(const std::string &fileLoc) : ready(false)
+Reader::Reader(const std::string &fileLoc) : ready(false),
+                                             mArenaAllocation(false),
+                                             mMemoryMapped(true),
+                                             mLazyLoading(false),
+                                             mNumThreads(0),
+                                             mLayerCache(std::make_shared<LayerCache>(std::numeric_limits<size_t>::max())),
+                                             mLoaderHandle(std::make_shared<Reader *>(this)),
+                                             mModelIndexDirty(true),
+                                             mNumIndexedModels(0)
 {
+    mLayerCache->setMaxResidentBytes(size_t(1) << 30);
     setFilePath(fileLoc);
 }
 
-Reader::Reader() : ready(false)
+Reader::Reader() : ready(false),
+                   mArenaAllocation(false),
+                   mMemoryMapped(true),
+                   mLazyLoading(false),
+                   mNumThreads(0),
+                   mLayerCache(std::make_shared<LayerCache>(std::numeric_limits<size_t>::max())),
+                   mLoaderHandle(std::make_shared<Reader *>(this)),
+                   mModelIndexDirty(true),
+                   mNumIndexedModels(0)
 {
+    mLayerCache->setMaxResidentBytes(size_t(1) << 30);
 }
 
 Reader::~Reader()
 {
+    *mLoaderHandle = nullptr;
+
     models.clear();
     layers.clear();
 }
@@ -68,50 +91,226 @@ void Reader::setFilePath(std::string path)
 
 Model::Ptr Reader::getModelById(uint64_t mid) const
 {
-    // Iterate through all buildStyle elements and check if matching id;
-    // Return true if found
+    std::lock_guard<std::mutex> lock(mModelIndexMutex);
+
+    // Models appended without invalidating the index are detected by the number of models
+    if(mModelIndexDirty || mNumIndexedModels != models.size())
+        indexModels();
+
+    auto result = mModelIndex.find(mid);
+
+    if(result == mModelIndex.end())
+        return Model::Ptr();
+
+    // A model replaced in place (or whose id has changed) without invalidating the index is re-indexed
+    if(result->second >= models.size() || !models[result->second] || models[result->second]->getId() != mid) {
+        indexModels();
+        result = mModelIndex.find(mid);
+
+        if(result == mModelIndex.end())
+            return Model::Ptr();
+    }
+
+    return models[result->second];
+}
+
+void Reader::indexModels() const
+{
+    mModelIndex.clear();
+    mModelIndex.reserve(models.size());
 
-    auto result = std::find_if(models.cbegin(), models.cend(),
-                               [&mid](Model::Ptr it){return it->getId() == mid;});
+    // The first model with a given id takes precedence
+    for(size_t i = 0; i < models.size(); i++) {
+        if(models[i])
+            mModelIndex.emplace(models[i]->getId(), i);
+    }
+
+    mNumIndexedModels = models.size();
+    mModelIndexDirty = false;
+}
 
-    return (result != models.cend()) ? *result : Model::Ptr();
+void Reader::invalidateModelIndex()
+{
+    std::lock_guard<std::mutex> lock(mModelIndexMutex);
+    mModelIndexDirty = true;
 }
 
+std::vector<Model::Ptr> Reader::takeModels()
+{
+    std::lock_guard<std::mutex> lock(mModelIndexMutex);
+
+    mModelIndex.clear();
+    mModelIndexDirty = true;
+
+    // A moved from vector is left in a valid but unspecified state, hence it is swapped out
+    std::vector<Model::Ptr> taken;
+    taken.swap(models);
+
+    return taken;
+}
+
+
+Layer::Ptr Reader::createLayer(uint64_t id, uint64_t z) const
+{
+    Layer::Ptr layer = std::make_shared<Layer>(id, z);
+
+    if(mArenaAllocation)
+        layer->setMemoryArena(std::make_shared<MemoryArena>());
+
+    return layer;
+}
+
+std::vector<Layer::Ptr> Reader::takeLayers()
+{
+    mLayerIndex.clear();
+
+    std::vector<Layer::Ptr> taken;
+    taken.swap(layers);
+
+    return taken;
+}
+
+const LayerIndex & Reader::layerIndex() const
+{
+    mLayerIndex.update(layers);
+    return mLayerIndex;
+}
+
+Layer::Ptr Reader::getLayerByZ(uint64_t z) const
+{
+    return layerIndex().findByZ(z);
+}
+
+Layer::Ptr Reader::getLayerById(uint64_t id) const
+{
+    return layerIndex().findById(id);
+}
+
+std::vector<Layer::Ptr> Reader::getLayersByZRange(uint64_t zMin, uint64_t zMax) const
+{
+    return layerIndex().rangeByZ(zMin, zMax);
+}
 
 Layer::Ptr Reader::getTopLayerByPosition(const std::vector<Layer::Ptr> &layers)
 {
-    uint64_t zMax = 0;
+    if(&layers == &this->layers)
+        return layerIndex().topLayerByZ();
 
-    Layer::Ptr fndLayer;
+    return LayerIndex::findTopLayerByZ(layers);
+}
+
+Layer::Ptr Reader::getTopLayerById(const std::vector<Layer::Ptr> &layers)
+{
+    if(&layers == &this->layers)
+        return layerIndex().topLayerById();
 
-    for(auto layer : layers) {
+    return LayerIndex::findTopLayerById(layers);
+}
 
-        if(layer->getZ() > zMax) {
-            fndLayer = layer;
-            zMax = layer->getZ();
-        }
+
+const InputBuffer * Reader::openInput(MappedFile::Advice advice)
+{
+    if(!this->isReady()) {
+        std::cerr << "File is not ready for reading" << std::endl;
+        return nullptr;
+    }
+
+    mInput.reset(new InputBuffer());
+
+    if(mInput->open(filePath, advice, mMemoryMapped) != 0) {
+        mInput.reset();
+        return nullptr;
     }
 
-    return fndLayer;
+    return mInput.get();
 }
 
-Layer::Ptr Reader::getTopLayerById(const std::vector<Layer::Ptr> &layers)
+void Reader::closeInput()
 {
-    uint64_t zId = 0;
+    mInput.reset();
+}
 
-    Layer::Ptr fndLayer;
+void Reader::deferLayer(const Layer::Ptr &layer)
+{
+    std::shared_ptr<Reader *> handle = mLoaderHandle;
 
-    for(auto layer : layers) {
+    layer->setIsLoaded(false);
+    layer->setLoader([handle](Layer &target) -> int {
+        Reader *reader = *handle;
 
-        if(layer->getLayerId() > zId) {
-            fndLayer = layer;
-            zId = layer->getLayerId();
+        if(!reader) {
+            std::cerr << "Layer (" << target.getLayerId() << ") cannot be loaded after its reader is destroyed" << std::endl;
+            return -1;
+        }
+
+        // Geometry of each load is allocated from a new arena, which is released when the layer is unloaded
+        if(reader->isArenaAllocation())
+            target.setMemoryArena(std::make_shared<MemoryArena>());
+
+        return reader->readLayerGeometry(target);
+    });
+
+    layer->setCache(mLayerCache);
+}
+
+int Reader::readLayerGeometry(Layer &)
+{
+    std::cerr << "Reader does not support reading individual layers" << std::endl;
+    return -1;
+}
+
+int Reader::decodeLayers(const std::vector<LayerOffset> &entries)
+{
+    // Each layer is decoded into its own slot, so that the order is independent of scheduling
+    std::vector<Layer::Ptr> decoded(entries.size());
+    std::vector<int> status(entries.size(), 0);
+
+    parallelFor(entries.size(), [&](size_t i) {
+        Layer::Ptr layer = createLayer(entries[i].id, entries[i].z);
+        layer->setLayerFilePosition(entries[i].offset);
+
+        status[i] = readLayerGeometry(*layer);
+
+        if(status[i] == 0)
+            layer->setIsLoaded(true);
+
+        decoded[i] = std::move(layer);
+    }, mNumThreads);
+
+    for(size_t i = 0; i < entries.size(); i++) {
+        if(status[i] != 0) {
+            std::cerr << "Layer (" << entries[i].id << ") at offset (" << entries[i].offset << ") could not be read" << std::endl;
+            return -1;
         }
     }
 
-    return fndLayer;
+    layers.reserve(layers.size() + decoded.size());
+    std::move(decoded.begin(), decoded.end(), std::back_inserter(layers));
+
+    return 0;
 }
 
+int Reader::loadLayer(uint64_t id)
+{
+    Layer::Ptr layer = getLayerById(id);
+
+    if(!layer) {
+        std::cerr << "Layer (" << id << ") not found" << std::endl;
+        return -1;
+    }
+
+    return layer->load();
+}
+
+int Reader::unloadLayer(uint64_t id)
+{
+    Layer::Ptr layer = getLayerById(id);
+
+    if(!layer || !layer->loader())
+        return -1;
+
+    return layer->unload();
+}
 
 int Reader::parse()
 {
@@ -3,9 +3,15 @@
 
 #include "SLM_Export.h"
 
+#include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_map>
 
+#include "InputBuffer.h"
 #include "Layer.h"
+#include "LayerCache.h"
+#include "LayerIndex.h"
 #include "Model.h"
 
 namespace slm
@@ -31,14 +37,111 @@ public:
 
     virtual double getLayerThickness() const = 0;
     
+    /**
+     * Models are found via an index by id, which is rebuilt on demand after invalidateModelIndex() or when the
+     * number of models has changed. Lookups are safe to call concurrently.
+     */
     Model::Ptr getModelById(uint64_t mid) const;
-    std::vector<Model::Ptr> getModels() const { return models;}
-    std::vector<Layer::Ptr> getLayers() const { return layers;}
+    const std::vector<Model::Ptr> & getModels() const { return models;}
+    const std::vector<Layer::Ptr> & getLayers() const { return layers;}
+
+    /**
+     * Transfers ownership of the parsed models and layers to the caller without copying, leaving the reader empty
+     */
+    std::vector<Model::Ptr> takeModels();
+    std::vector<Layer::Ptr> takeLayers();
 
     Layer::Ptr getTopLayerByPosition(const std::vector<Layer::Ptr> &layers);
     Layer::Ptr getTopLayerById(const std::vector<Layer::Ptr> &layers);
 
+    /**
+     * Lookups of the reader's layers via the layer index, which is updated on demand with the layers appended
+     * since the previous lookup
+     */
+    Layer::Ptr getLayerByZ(uint64_t z) const;
+    Layer::Ptr getLayerById(uint64_t id) const;
+    std::vector<Layer::Ptr> getLayersByZRange(uint64_t zMin, uint64_t zMax) const;
+    const LayerIndex & layerIndex() const;
+
+    /**
+     * When enabled, layers created by createLayer are given a per-layer MemoryArena, which their geometry and
+     * coordinates (created via Layer::createGeometry) are allocated from and released in bulk. Such geometry is
+     * only valid whilst held by its layer (see Layer::setMemoryArena).
+     */
+    bool isArenaAllocation() const { return mArenaAllocation; }
+    void setArenaAllocation(bool state) { mArenaAllocation = state; }
+
+    /**
+     * When enabled (default), the input opened via openInput() is memory mapped where supported, otherwise the
+     * file is read into memory
+     */
+    bool isMemoryMapped() const { return mMemoryMapped; }
+    void setMemoryMapped(bool state) { mMemoryMapped = state; }
+
+    /**
+     * Lazy loading mode - translators supporting it only index each layer's file position, id and Z whilst
+     * parsing, and the geometry of each layer is read on demand, either via loadLayer() or upon the first access to
+     * the layer's geometry. Loaded layers are governed by the reader's LayerCache, which unloads the least recently
+     * used layers once its budget is exceeded (by default 1 GiB). Accessing a layer may therefore unload another,
+     * invalidating any references to the other layer's geometry, unless that layer is pinned (see Layer::pin).
+     */
+    bool isLazyLoading() const { return mLazyLoading; }
+    void setLazyLoading(bool state) { mLazyLoading = state; }
+
+    const LayerCache::Ptr & layerCache() const { return mLayerCache; }
+    void setLayerCache(const LayerCache::Ptr &cache) { mLayerCache = cache; }
+
+    int loadLayer(uint64_t id);
+    int unloadLayer(uint64_t id);
+
+    /**
+     * Number of threads used by decodeLayers() (zero uses the hardware concurrency)
+     */
+    unsigned int numThreads() const { return mNumThreads; }
+    void setNumThreads(unsigned int val) { mNumThreads = val; }
+
+    /**
+     * Entry of a layer offset table - the file position of a layer with its id and Z
+     */
+    struct LayerOffset
+    {
+        uint64_t offset;
+        uint64_t id;
+        uint64_t z;
+    };
+
 protected:
+    Layer::Ptr createLayer(uint64_t id, uint64_t z) const;
+
+    /**
+     * Opens the file as an InputBuffer, so that translators may decode directly from its bytes via bounds-checked
+     * spans, rather than copying through a std::ifstream. The buffer remains open until closeInput() is called.
+     */
+    const InputBuffer * openInput(MappedFile::Advice advice = MappedFile::SEQUENTIAL);
+    const InputBuffer * input() const { return mInput.get(); }
+    void closeInput();
+
+    /**
+     * Defers reading the geometry of an indexed layer (with its file position set) until required, via
+     * readLayerGeometry(). Translators supporting lazy loading call this for each layer during parse() instead of
+     * reading its geometry.
+     */
+    void deferLayer(const Layer::Ptr &layer);
+    virtual int readLayerGeometry(Layer &layer);
+
+    /**
+     * Decodes the layers of each entry concurrently, once the layer offset table is known. A layer is created for
+     * each entry (with its id, Z and file position) and read via readLayerGeometry(), which must then be safe to
+     * call concurrently for different layers. The layers are appended in the order of the entries, irrespective of
+     * the number of threads. Returns zero or -1 if any layer could not be read, in which case no layers are appended.
+     */
+    int decodeLayers(const std::vector<LayerOffset> &entries);
+
+    /**
+     * Translators call this after removing, replacing or reordering the models, so that getModelById() re-indexes them
+     */
+    void invalidateModelIndex();
+
     void setReady(bool state) { ready = state; }
     std::string filePath;
     
@@ -48,6 +151,26 @@ protected:
 
 private:
     bool ready;
+    bool mArenaAllocation;
+    bool mMemoryMapped;
+    bool mLazyLoading;
+    unsigned int mNumThreads;
+
+    LayerCache::Ptr mLayerCache;
+
+    // Layers loaded after the reader has been destroyed fail, rather than calling into the reader
+    std::shared_ptr<Reader *> mLoaderHandle;
+
+    std::unique_ptr<InputBuffer> mInput;
+
+    mutable LayerIndex mLayerIndex;
+
+    void indexModels() const;
+
+    mutable std::mutex mModelIndexMutex;
+    mutable std::unordered_map<uint64_t, size_t> mModelIndex;
+    mutable bool mModelIndexDirty;
+    mutable size_t mNumIndexedModels;
 };
 
 }
@@ -0,0 +1,540 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "Parallel.h"
+#include "ScanOptimizer.h"
+
+using namespace slm;
+
+namespace {
+
+struct Item
+{
+    float start[2];
+    float end[2];
+    bool  reversible; // The geometry may be scanned in reverse, or is closed (start == end)
+};
+
+inline double distance(const float *a, const float *b)
+{
+    const double dx = double(b[0]) - double(a[0]);
+    const double dy = double(b[1]) - double(a[1]);
+    return std::sqrt(dx * dx + dy * dy);
+}
+
+// Cell of a coordinate relative to the grid, clamped before conversion as points may lie far outside the grid
+inline int clampCell(double c, int numCells)
+{
+    if(!(c > 0.0))
+        return 0;
+
+    return (c < double(numCells - 1)) ? int(c) : numCells - 1;
+}
+
+/*
+ * Uniform grid over the end points of the remaining items. End point 2i is the start of item i and 2i + 1 its
+ * end, which is only inserted for reversible items.
+ */
+class EndpointGrid
+{
+public:
+
+    EndpointGrid(const std::vector<Item> &items) : mItems(items), mNumBuilt(0), mNumRemaining(0) {}
+
+    void build(const std::vector<uint32_t> &itemIdx)
+    {
+        float minX =  std::numeric_limits<float>::max(), minY =  std::numeric_limits<float>::max();
+        float maxX = -std::numeric_limits<float>::max(), maxY = -std::numeric_limits<float>::max();
+
+        for(uint32_t i : itemIdx) {
+            for(const float *pnt : {mItems[i].start, mItems[i].end}) {
+                minX = std::min(minX, pnt[0]); maxX = std::max(maxX, pnt[0]);
+                minY = std::min(minY, pnt[1]); maxY = std::max(maxY, pnt[1]);
+            }
+        }
+
+        // Approximately two end points per cell
+        const double width  = std::max(double(maxX) - double(minX), 1e-6);
+        const double height = std::max(double(maxY) - double(minY), 1e-6);
+        const double numCells = std::max<double>(double(itemIdx.size()), 1.0);
+
+        mCellSize = std::max(std::sqrt(width * height / numCells), std::max(width, height) / numCells);
+        mOriginX = minX;
+        mOriginY = minY;
+        mNumCellsX = std::min(int(width / mCellSize) + 1, 4096);
+        mNumCellsY = std::min(int(height / mCellSize) + 1, 4096);
+
+        mCells.assign(size_t(mNumCellsX) * size_t(mNumCellsY), std::vector<uint32_t>());
+        mLocation.assign(mItems.size() * 2, Location());
+
+        for(uint32_t i : itemIdx) {
+            insert(2 * i, mItems[i].start);
+
+            if(mItems[i].reversible)
+                insert(2 * i + 1, mItems[i].end);
+        }
+
+        mNumBuilt = mNumRemaining = itemIdx.size();
+    }
+
+    void remove(uint32_t item)
+    {
+        erase(2 * item);
+
+        if(mItems[item].reversible)
+            erase(2 * item + 1);
+
+        mNumRemaining--;
+    }
+
+    /*
+     * Returns the nearest remaining end point, searching rings of cells outwards until no closer point can exist
+     */
+    uint32_t nearest(const float *pnt) const
+    {
+        const int cx = cellX(pnt[0]);
+        const int cy = cellY(pnt[1]);
+        const int maxRing = std::max(mNumCellsX, mNumCellsY);
+
+        uint32_t best = std::numeric_limits<uint32_t>::max();
+        double bestDist = std::numeric_limits<double>::max();
+
+        for(int r = 0; r <= maxRing; r++) {
+
+            // Cells in ring r are at least (r - 1) cells away from the point
+            if(r > 0 && bestDist <= double(r - 1) * mCellSize)
+                break;
+
+            for(int dy = -r; dy <= r; dy++) {
+
+                const int y = cy + dy;
+
+                if(y < 0 || y >= mNumCellsY)
+                    continue;
+
+                const int step = (dy == -r || dy == r) ? 1 : 2 * r;
+
+                for(int dx = -r; dx <= r; dx += step) {
+
+                    const int x = cx + dx;
+
+                    if(x < 0 || x >= mNumCellsX)
+                        continue;
+
+                    for(uint32_t endpoint : mCells[size_t(y) * size_t(mNumCellsX) + size_t(x)]) {
+                        const double dist = distance(pnt, endpointCoords(endpoint));
+
+                        if(dist < bestDist) {
+                            bestDist = dist;
+                            best = endpoint;
+                        }
+                    }
+                }
+            }
+        }
+
+        return best;
+    }
+
+    // The grid is rebuilt over the remaining items once sparse, so that searches do not traverse empty cells
+    bool isSparse() const { return mNumBuilt > 64 && mNumRemaining * 4 < mNumBuilt; }
+
+private:
+
+    struct Location
+    {
+        uint32_t cell = 0;
+        uint32_t pos  = 0;
+    };
+
+    const float * endpointCoords(uint32_t endpoint) const
+    {
+        const Item &item = mItems[endpoint / 2];
+        return (endpoint % 2) ? item.end : item.start;
+    }
+
+    int cellX(float x) const
+    {
+        return clampCell((double(x) - mOriginX) / mCellSize, mNumCellsX);
+    }
+
+    int cellY(float y) const
+    {
+        return clampCell((double(y) - mOriginY) / mCellSize, mNumCellsY);
+    }
+
+    void insert(uint32_t endpoint, const float *pnt)
+    {
+        const uint32_t cell = uint32_t(cellY(pnt[1]) * mNumCellsX + cellX(pnt[0]));
+
+        mLocation[endpoint].cell = cell;
+        mLocation[endpoint].pos = uint32_t(mCells[cell].size());
+        mCells[cell].push_back(endpoint);
+    }
+
+    void erase(uint32_t endpoint)
+    {
+        const Location loc = mLocation[endpoint];
+        std::vector<uint32_t> &cell = mCells[loc.cell];
+
+        cell[loc.pos] = cell.back();
+        mLocation[cell.back()].pos = loc.pos;
+        cell.pop_back();
+    }
+
+    const std::vector<Item> &mItems;
+    std::vector<std::vector<uint32_t>> mCells;
+    std::vector<Location> mLocation;
+
+    double mOriginX, mOriginY;
+    double mCellSize;
+    int    mNumCellsX, mNumCellsY;
+
+    size_t mNumBuilt;
+    size_t mNumRemaining;
+};
+
+/*
+ * Scan order of a partition. The entry and exit points of each item depend upon whether it is reversed.
+ */
+struct Tour
+{
+    const std::vector<Item> &items;
+    std::vector<uint32_t> order;
+    std::vector<uint8_t> &reversed;
+
+    const float * entry(uint32_t i) const { return reversed[i] ? items[i].end : items[i].start; }
+    const float * exit(uint32_t i)  const { return reversed[i] ? items[i].start : items[i].end; }
+
+    double cost(const float *startPnt) const
+    {
+        double total = 0.0;
+        const float *pnt = startPnt;
+
+        for(uint32_t i : order) {
+            if(pnt)
+                total += distance(pnt, entry(i));
+
+            pnt = exit(i);
+        }
+
+        return total;
+    }
+};
+
+void orderGreedy(Tour &tour, const std::vector<uint32_t> &itemIdx, const float *startPnt)
+{
+    EndpointGrid grid(tour.items);
+    grid.build(itemIdx);
+
+    std::vector<uint8_t> visited(tour.items.size(), 0);
+    size_t numRemaining = itemIdx.size();
+
+    const float *pnt = startPnt ? startPnt : tour.items[itemIdx.front()].start;
+
+    tour.order.clear();
+    tour.order.reserve(itemIdx.size());
+
+    while(numRemaining > 0) {
+
+        if(grid.isSparse()) {
+            std::vector<uint32_t> remaining;
+            remaining.reserve(numRemaining);
+
+            for(uint32_t i : itemIdx) {
+                if(!visited[i])
+                    remaining.push_back(i);
+            }
+
+            grid.build(remaining);
+        }
+
+        const uint32_t endpoint = grid.nearest(pnt);
+        const uint32_t i = endpoint / 2;
+
+        grid.remove(i);
+        visited[i] = 1;
+        numRemaining--;
+
+        // Reaching an item at its end point scans it in reverse, unless it is closed
+        const Item &item = tour.items[i];
+        tour.reversed[i] = (endpoint % 2) && !(item.start[0] == item.end[0] && item.start[1] == item.end[1]);
+
+        tour.order.push_back(i);
+        pnt = tour.exit(i);
+    }
+}
+
+/*
+ * 2-opt moves reverse the scan order of a run of items, which requires every item within the run to be
+ * reversible. Moves are limited to runs within the window, so that each pass is linear in the number of items.
+ */
+void refineTwoOpt(Tour &tour, const float *startPnt, unsigned int window, unsigned int numPasses)
+{
+    std::vector<uint32_t> &order = tour.order;
+    const size_t n = order.size();
+
+    for(unsigned int pass = 0; pass < numPasses; pass++) {
+
+        bool improved = false;
+
+        for(size_t i = 0; i < n; i++) {
+
+            const float *prevExit = (i > 0) ? tour.exit(order[i - 1]) : startPnt;
+            const size_t last = std::min(n - 1, i + window);
+
+            for(size_t j = i; j <= last; j++) {
+
+                if(!tour.items[order[j]].reversible)
+                    break;
+
+                const float *nextEntry = (j + 1 < n) ? tour.entry(order[j + 1]) : nullptr;
+
+                double before = 0.0, after = 0.0;
+
+                if(prevExit) {
+                    before += distance(prevExit, tour.entry(order[i]));
+                    after  += distance(prevExit, tour.exit(order[j]));
+                }
+
+                if(nextEntry) {
+                    before += distance(tour.exit(order[j]), nextEntry);
+                    after  += distance(tour.entry(order[i]), nextEntry);
+                }
+
+                if(after < before - 1e-9) {
+                    std::reverse(order.begin() + i, order.begin() + j + 1);
+
+                    for(size_t k = i; k <= j; k++) {
+                        const Item &item = tour.items[order[k]];
+
+                        if(!(item.start[0] == item.end[0] && item.start[1] == item.end[1]))
+                            tour.reversed[order[k]] ^= 1;
+                    }
+
+                    improved = true;
+                }
+            }
+        }
+
+        if(!improved)
+            break;
+    }
+}
+
+/*
+ * Reverses the order of the coordinates of a geometry, so that it is scanned from its end point
+ */
+void reverseGeometry(LayerGeometry &geom)
+{
+    if(geom.isQuantized()) {
+        LayerGeometry::QuantizedCoords &coords = geom.quantizedCoordsRef();
+        coords = coords.colwise().reverse().eval();
+        return;
+    }
+
+    if(geom.isInstanced())
+        geom.detach();
+
+    LayerGeometry::CoordsMap coords = geom.mutableCoordinates();
+    coords = coords.colwise().reverse().eval();
+}
+
+/*
+ * Reverses individual hatch vectors, so that each vector starts at the point nearest the end of the previous vector
+ */
+void flipHatchVectors(LayerGeometry &geom)
+{
+    Eigen::MatrixXf scratch;
+    LayerGeometry::ConstCoordsMap coords = geom.resolve(scratch);
+
+    std::vector<Eigen::Index> flipped;
+    const float *x = coords.data();
+    const float *y = coords.data() + coords.rows();
+
+    float prevX = 0.f, prevY = 0.f;
+
+    for(Eigen::Index k = 0; k + 1 < coords.rows(); k += 2) {
+
+        float endX = x[k + 1], endY = y[k + 1];
+
+        if(k > 0) {
+            const float p0[2] = {prevX, prevY};
+            const float a[2] = {x[k], y[k]};
+            const float b[2] = {x[k + 1], y[k + 1]};
+
+            if(distance(p0, b) < distance(p0, a)) {
+                flipped.push_back(k);
+                endX = x[k];
+                endY = y[k];
+            }
+        }
+
+        prevX = endX;
+        prevY = endY;
+    }
+
+    if(flipped.empty())
+        return;
+
+    if(geom.isQuantized()) {
+        LayerGeometry::QuantizedCoords &qcoords = geom.quantizedCoordsRef();
+
+        for(Eigen::Index k : flipped)
+            qcoords.row(k).swap(qcoords.row(k + 1));
+
+        return;
+    }
+
+    if(geom.isInstanced())
+        geom.detach();
+
+    LayerGeometry::CoordsMap mcoords = geom.mutableCoordinates();
+
+    for(Eigen::Index k : flipped)
+        mcoords.row(k).swap(mcoords.row(k + 1));
+}
+
+} // End of anonymous namespace
+
+ScanOptimizer::ScanOptimizer() : mScanMode(NONE),
+                                 mReversing(false),
+                                 mHatchVectorFlipping(false),
+                                 mTwoOpt(true),
+                                 mTwoOptWindow(32),
+                                 mTwoOptPasses(4),
+                                 mNumThreads(0)
+{
+}
+
+ScanOptimizer::~ScanOptimizer()
+{
+}
+
+ScanOptimizerResult ScanOptimizer::optimize(Layer &layer) const
+{
+    ScanOptimizerResult result;
+    result.layerId = layer.getLayerId();
+    result.jumpLengthBefore = layer.metrics().jumpLength;
+
+    std::vector<LayerGeometry::Ptr> geoms = layer.geometry();
+
+    if(mHatchVectorFlipping) {
+        for(const LayerGeometry::Ptr &geom : geoms) {
+            if(geom->getType() == LayerGeometry::HATCH)
+                flipHatchVectors(*geom);
+        }
+    }
+
+    // Partitions of the geometry, scanned in order
+    std::vector<std::vector<uint32_t>> partitions;
+
+    if(mScanMode == CONTOUR_FIRST || mScanMode == HATCH_FIRST) {
+
+        const LayerGeometry::TYPE first  = (mScanMode == CONTOUR_FIRST) ? LayerGeometry::POLYGON : LayerGeometry::HATCH;
+        const LayerGeometry::TYPE second = (mScanMode == CONTOUR_FIRST) ? LayerGeometry::HATCH : LayerGeometry::POLYGON;
+
+        partitions.resize(4);
+
+        for(uint32_t i = 0; i < geoms.size(); i++) {
+            const LayerGeometry::TYPE type = geoms[i]->getType();
+            partitions[type == first ? 0 : type == second ? 1 : type == LayerGeometry::PNTS ? 2 : 3].push_back(i);
+        }
+
+    } else {
+        partitions.resize(1);
+
+        for(uint32_t i = 0; i < geoms.size(); i++)
+            partitions[0].push_back(i);
+    }
+
+    std::vector<Item> items(geoms.size());
+    std::vector<uint8_t> reversed(geoms.size(), 0);
+
+    for(size_t i = 0; i < geoms.size(); i++) {
+
+        const GeometryMetrics &gm = geoms[i]->metrics();
+        const LayerGeometry::TYPE type = geoms[i]->getType();
+
+        std::copy(gm.start, gm.start + 2, items[i].start);
+        std::copy(gm.end, gm.end + 2, items[i].end);
+
+        const bool closed = (gm.start[0] == gm.end[0] && gm.start[1] == gm.end[1]);
+        items[i].reversible = closed || (mReversing && (type == LayerGeometry::HATCH || type == LayerGeometry::PNTS));
+    }
+
+    std::vector<LayerGeometry::Ptr> ordered;
+    ordered.reserve(geoms.size());
+
+    const float *pnt = nullptr;
+
+    for(const std::vector<uint32_t> &partition : partitions) {
+
+        // Empty geometry has no end points and is placed after the partition
+        std::vector<uint32_t> itemIdx, emptyIdx;
+
+        for(uint32_t i : partition)
+            (geoms[i]->metrics().numPoints > 0 ? itemIdx : emptyIdx).push_back(i);
+
+        if(!itemIdx.empty()) {
+
+            Tour original{items, itemIdx, reversed};
+            const double originalCost = original.cost(pnt);
+
+            std::vector<uint8_t> optReversed(geoms.size(), 0);
+            Tour tour{items, std::vector<uint32_t>(), optReversed};
+
+            orderGreedy(tour, itemIdx, pnt);
+
+            if(mTwoOpt)
+                refineTwoOpt(tour, pnt, mTwoOptWindow, mTwoOptPasses);
+
+            // The original order is retained if already better
+            if(tour.cost(pnt) < originalCost) {
+                for(uint32_t i : tour.order)
+                    reversed[i] = optReversed[i];
+
+                itemIdx = tour.order;
+            }
+
+            pnt = Tour{items, itemIdx, reversed}.exit(itemIdx.back());
+        }
+
+        for(uint32_t i : itemIdx)
+            ordered.push_back(geoms[i]);
+
+        for(uint32_t i : emptyIdx)
+            ordered.push_back(geoms[i]);
+    }
+
+    for(size_t i = 0; i < geoms.size(); i++) {
+        if(reversed[i]) {
+            reverseGeometry(*geoms[i]);
+            result.numReversed++;
+        }
+    }
+
+    layer.setGeometry(std::move(ordered));
+
+    result.jumpLengthAfter = layer.metrics().jumpLength;
+
+    return result;
+}
+
+std::vector<ScanOptimizerResult> ScanOptimizer::optimize(const std::vector<Layer::Ptr> &layers) const
+{
+    std::vector<ScanOptimizerResult> results(layers.size());
+
+    parallelFor(layers.size(), [&](size_t i) {
+        if(!layers[i]->cache())
+            results[i] = optimize(*layers[i]);
+    }, mNumThreads);
+
+    for(size_t i = 0; i < layers.size(); i++) {
+        if(layers[i]->cache())
+            results[i] = optimize(*layers[i]);
+    }
+
+    return results;
+}
@@ -0,0 +1,87 @@
+#ifndef SLM_SCANOPTIMIZER_H_HEADER_HAS_BEEN_INCLUDED
+#define SLM_SCANOPTIMIZER_H_HEADER_HAS_BEEN_INCLUDED
+
+#include "SLM_Export.h"
+
+#include <cstdint>
+#include <vector>
+
+#include "Layer.h"
+
+namespace slm
+{
+
+/**
+ * @brief Jump length of a layer (see LayerMetrics::jumpLength) before and after optimising its scan order
+ */
+struct ScanOptimizerResult
+{
+    uint64_t layerId          = 0;
+    double   jumpLengthBefore = 0.0;
+    double   jumpLengthAfter  = 0.0;
+    uint64_t numReversed      = 0;   // Number of geometries scanned in reverse
+};
+
+/**
+ * @brief The ScanOptimizer class reorders the geometry within each layer to reduce the jumps between geometries,
+ * for use between reading and writing a build. The geometry is first ordered greedily by jumping to the nearest
+ * remaining geometry, found via a uniform grid over the end points, and then optionally refined by 2-opt moves
+ * within a bounded window, so that the cost remains linear for layers with many geometries.
+ *
+ * With a ScanMode other than NONE, the layer's geometry is partitioned by type in the same order as
+ * Layer::orderedGeometry, and each partition is ordered separately. Optionally, hatch and point geometry may be
+ * scanned in reverse, and individual hatch vectors may be reversed to start nearest the end of the previous
+ * vector. Contours always retain their direction. The geometry is reordered, and reversed, in place, hence
+ * geometry should not be shared between layers optimised concurrently.
+ */
+class SLM_EXPORT ScanOptimizer
+{
+public:
+
+    ScanOptimizer();
+    ~ScanOptimizer();
+
+public:
+
+    ScanOptimizerResult optimize(Layer &layer) const;
+
+    /**
+     * Optimises each layer in parallel. Layers assigned to a LayerCache are processed serially, as their
+     * expansion may evict other layers.
+     */
+    std::vector<ScanOptimizerResult> optimize(const std::vector<Layer::Ptr> &layers) const;
+
+    ScanMode scanMode() const { return mScanMode; }
+    void setScanMode(ScanMode mode) { mScanMode = mode; }
+
+    bool isReversing() const { return mReversing; }
+    void setReversing(bool state) { mReversing = state; }
+
+    bool isHatchVectorFlipping() const { return mHatchVectorFlipping; }
+    void setHatchVectorFlipping(bool state) { mHatchVectorFlipping = state; }
+
+    bool isTwoOpt() const { return mTwoOpt; }
+    void setTwoOpt(bool state) { mTwoOpt = state; }
+
+    unsigned int twoOptWindow() const { return mTwoOptWindow; }
+    void setTwoOptWindow(unsigned int val) { mTwoOptWindow = val; }
+
+    unsigned int twoOptPasses() const { return mTwoOptPasses; }
+    void setTwoOptPasses(unsigned int val) { mTwoOptPasses = val; }
+
+    unsigned int numThreads() const { return mNumThreads; }
+    void setNumThreads(unsigned int val) { mNumThreads = val; }
+
+private:
+    ScanMode mScanMode;
+    bool mReversing;
+    bool mHatchVectorFlipping;
+    bool mTwoOpt;
+    unsigned int mTwoOptWindow;
+    unsigned int mTwoOptPasses;
+    unsigned int mNumThreads;
+};
+
+} // End of Namespace slm
+
+#endif // SLM_SCANOPTIMIZER_H_HEADER_HAS_BEEN_INCLUDED
@@ -14,6 +14,12 @@
 
 namespace slm {
 
+// Coordinates are resolved from the geometry irrespective of its storage mode (arena, quantized or instanced)
+static inline QPointF pointAt(const Eigen::MatrixXf &coords, int i)
+{
+    return QPointF(coords(i, 0), coords(i, 1));
+}
+
 // Multithreaded operation for generting the layer index
 struct GenLayerIndex
 {
@@ -191,18 +197,20 @@ double Slm::calcGeomTime(LayerGeometry *lgeom) const
 
     float laserSpeed = bstyle->laserSpeed;
 
+    const Eigen::MatrixXf coords = lgeom->floatCoords();
+
     double pathLen = 0.f;
 
     if(lgeom->getType() == LayerGeometry::HATCH) {
-        for(int i = 0; i < lgeom->coords.length() / 2; i++) {
-            QPointF v = lgeom->coords.at(2*i+1) - lgeom->coords.at(2*i); // Vector between line segment
+        for(int i = 0; i < int(coords.rows()) / 2; i++) {
+            QPointF v = pointAt(coords, 2*i+1) - pointAt(coords, 2*i); // Vector between line segment
             const double &x = v.rx();
             const double &y = v.rx();
             pathLen += sqrt(x*x + y*y);
         }
     } else if(lgeom->getType() == LayerGeometry::POLYGON) {
-        for(int i = 0; i < lgeom->coords.length() -1; i++) {
-            QPointF v = lgeom->coords.at(i+1) - lgeom->coords.at(i); // Vector between line segment
+        for(int i = 0; i < int(coords.rows()) -1; i++) {
+            QPointF v = pointAt(coords, i+1) - pointAt(coords, i); // Vector between line segment
             const double &x = v.rx();
             const double &y = v.rx();
             pathLen += sqrt(x*x + y*y);
@@ -223,13 +231,15 @@ void Slm::getPointsInGeom(const double &offset, LayerGeometry *lgeom, QPointF &p
 
     double distTravelled = bstyle->laserSpeed * offset; // Distance covered for offset of this geometry
 
+    const Eigen::MatrixXf coords = lgeom->floatCoords();
+
     if(lgeom->getType() == LayerGeometry::HATCH) {
 
         double pathPos = 0.f;
 
-        for(int i = 0; i < lgeom->coords.length() / 2; ++i) {
-            const QPointF &p1 = lgeom->coords.at(2*i);
-            const QPointF &p2 = lgeom->coords.at(2*i+i);
+        for(int i = 0; i < int(coords.rows()) / 2; ++i) {
+            const QPointF &p1 = pointAt(coords, 2*i);
+            const QPointF &p2 = pointAt(coords, 2*i+i);
             QPointF v = p2 - p1; // Vector between line segmen
             pathPos += sqrt(pow(v.x(), 2) + pow(v.y(), 2));
 
@@ -245,9 +255,9 @@ void Slm::getPointsInGeom(const double &offset, LayerGeometry *lgeom, QPointF &p
         ContourGeometry *geom = static_cast<ContourGeometry *>(lgeom);
         double pathPos = 0.f;
 
-        for(int i = 0; i < geom->coords.length() -1; ++i) {
-            const QPointF &p1 = geom->coords.at(i);
-            const QPointF &p2 = geom->coords.at(i+1);
+        for(int i = 0; i < int(coords.rows()) -1; ++i) {
+            const QPointF &p1 = pointAt(coords, i);
+            const QPointF &p2 = pointAt(coords, i+1);
             QPointF v = p2 - p1; // Vector between line segmen
             pathPos += sqrt(pow(v.x(), 2) + pow(v.y(), 2));
 
@@ -268,6 +278,8 @@ QPointF Slm::getPointInGeom(const double &offset, LayerGeometry *lgeom) const
 
     double distTravelled = bstyle->laserSpeed * offset; // Distance covered for offset of this geometry
 
+    const Eigen::MatrixXf coords = lgeom->floatCoords();
+
 
     QPointF laserPos;
     if(lgeom->getType() == LayerGeometry::HATCH) {
@@ -278,16 +290,16 @@ QPointF Slm::getPointInGeom(const double &offset, LayerGeometry *lgeom) const
         QPointF v;
         QPointF p1;
 
-        for(int i = 0; i < lgeom->coords.length() / 2; ++i) {
+        for(int i = 0; i < int(coords.rows()) / 2; ++i) {
 
-            v = lgeom->coords.at(2*i+1) -lgeom->coords.at(2*i); // Vector between line segment
+            v = pointAt(coords, 2*i+1) -pointAt(coords, 2*i); // Vector between line segment
 
             pathPos += sqrt(pow(v.x(), 2) + pow(v.y(), 2));
 
             if(distTravelled < pathPos) {
                 onContour = true;
                 // Save p1 for later
-                p1 = lgeom->coords.at(2*i);
+                p1 = pointAt(coords, 2*i);
                 break;
             }
         }
@@ -311,15 +323,15 @@ QPointF Slm::getPointInGeom(const double &offset, LayerGeometry *lgeom) const
         QPointF v;
         QPointF p1;
 
-        for(int i = 0; i < geom->coords.length() -1; ++i) {
+        for(int i = 0; i < int(coords.rows()) -1; ++i) {
 
-            v = geom->coords.at(i+1) - geom->coords.at(i); // Vector between line segment
+            v = pointAt(coords, i+1) - pointAt(coords, i); // Vector between line segment
             pathPos += sqrt(pow(v.x(), 2) + pow(v.y(), 2));
 
             if(distTravelled < pathPos) {
 
                 // Save p1 for later
-                p1 = geom->coords.at(i);
+                p1 = pointAt(coords, i);
                 onContour = true;
                 break;
             }
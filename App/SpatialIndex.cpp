@@ -0,0 +1,232 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "Parallel.h"
+#include "SpatialIndex.h"
+
+using namespace slm;
+
+SpatialIndex::SpatialIndex() : mOriginX(0.f),
+                               mOriginY(0.f),
+                               mInvCellSize(1.f),
+                               mNumCellsX(0),
+                               mNumCellsY(0)
+{
+}
+
+SpatialIndex::~SpatialIndex()
+{
+}
+
+void SpatialIndex::clear()
+{
+    mSegments.clear();
+    mSegBox.clear();
+    mCellStart.clear();
+    mCellItems.clear();
+    mNumCellsX = 0;
+    mNumCellsY = 0;
+}
+
+/*
+ * Clamps a cell coordinate to the grid before converting it to an integer, as the conversion of a value outside
+ * the range of int (e.g. for an unbounded query window) is undefined. Non-finite coordinates map to the first cell.
+ */
+static inline int clampCell(double c, int numCells)
+{
+    if(!(c > 0.0))
+        return 0;
+
+    return (c < double(numCells - 1)) ? int(c) : numCells - 1;
+}
+
+int SpatialIndex::cellX(float x) const
+{
+    return clampCell((double(x) - double(mOriginX)) * double(mInvCellSize), mNumCellsX);
+}
+
+int SpatialIndex::cellY(float y) const
+{
+    return clampCell((double(y) - double(mOriginY)) * double(mInvCellSize), mNumCellsY);
+}
+
+void SpatialIndex::build(const std::vector<LayerGeometry::Ptr> &geoms)
+{
+    clear();
+
+    Eigen::MatrixXf scratch;
+
+    auto addSegment = [this](uint32_t geomIdx, uint32_t segIdx, float x0, float y0, float x1, float y1) {
+        SegmentRef seg;
+        seg.geomIdx = geomIdx;
+        seg.segIdx = segIdx;
+        mSegments.push_back(seg);
+        mSegBox.push_back(std::min(x0, x1));
+        mSegBox.push_back(std::min(y0, y1));
+        mSegBox.push_back(std::max(x0, x1));
+        mSegBox.push_back(std::max(y0, y1));
+    };
+
+    for(size_t i = 0; i < geoms.size(); i++) {
+
+        const LayerGeometry::ConstCoordsMap coords = geoms[i]->resolve(scratch);
+
+        if(coords.cols() < 2)
+            continue;
+
+        const uint32_t geomIdx = uint32_t(i);
+
+        switch(geoms[i]->getType()) {
+            case LayerGeometry::HATCH:
+                for(Eigen::Index j = 0; j + 1 < coords.rows(); j += 2)
+                    addSegment(geomIdx, uint32_t(j / 2), coords(j, 0), coords(j, 1), coords(j + 1, 0), coords(j + 1, 1));
+                break;
+            case LayerGeometry::POLYGON:
+                for(Eigen::Index j = 0; j + 1 < coords.rows(); j++)
+                    addSegment(geomIdx, uint32_t(j), coords(j, 0), coords(j, 1), coords(j + 1, 0), coords(j + 1, 1));
+                break;
+            default:
+                for(Eigen::Index j = 0; j < coords.rows(); j++)
+                    addSegment(geomIdx, uint32_t(j), coords(j, 0), coords(j, 1), coords(j, 0), coords(j, 1));
+                break;
+        }
+    }
+
+    const size_t numSegs = mSegments.size();
+
+    if(numSegs == 0)
+        return;
+
+    // Overall bounds and mean segment extent
+    float minX = std::numeric_limits<float>::max(), minY = std::numeric_limits<float>::max();
+    float maxX = -std::numeric_limits<float>::max(), maxY = -std::numeric_limits<float>::max();
+    double meanExtent = 0.0;
+
+    for(size_t s = 0; s < numSegs; s++) {
+        const float *box = &mSegBox[4 * s];
+        minX = std::min(minX, box[0]);
+        minY = std::min(minY, box[1]);
+        maxX = std::max(maxX, box[2]);
+        maxY = std::max(maxY, box[3]);
+        meanExtent += std::max(box[2] - box[0], box[3] - box[1]);
+    }
+
+    meanExtent /= double(numSegs);
+
+    const double width  = double(maxX) - double(minX);
+    const double height = double(maxY) - double(minY);
+
+    // Target a few segments per cell, whilst keeping cells no smaller than a typical segment
+    double cellSize = std::max(std::sqrt(width * height * 4.0 / double(numSegs)), meanExtent);
+
+    if(!(cellSize > 0.0))
+        cellSize = std::max(std::max(width, height), 1.0);
+
+    while((width / cellSize + 1.0) * (height / cellSize + 1.0) > 4.0 * double(numSegs) + 1.0)
+        cellSize *= 2.0;
+
+    mOriginX = minX;
+    mOriginY = minY;
+    mInvCellSize = float(1.0 / cellSize);
+    mNumCellsX = int(width / cellSize) + 1;
+    mNumCellsY = int(height / cellSize) + 1;
+
+    // Counting pass followed by the fill pass
+    mCellStart.assign(numCells() + 1, 0);
+
+    for(size_t s = 0; s < numSegs; s++) {
+        const float *box = &mSegBox[4 * s];
+
+        for(int cy = cellY(box[1]); cy <= cellY(box[3]); cy++) {
+            for(int cx = cellX(box[0]); cx <= cellX(box[2]); cx++)
+                mCellStart[cy * mNumCellsX + cx + 1]++;
+        }
+    }
+
+    for(size_t c = 0; c < numCells(); c++)
+        mCellStart[c + 1] += mCellStart[c];
+
+    std::vector<uint32_t> fill(mCellStart.begin(), mCellStart.end() - 1);
+    mCellItems.resize(mCellStart.back());
+
+    for(size_t s = 0; s < numSegs; s++) {
+        const float *box = &mSegBox[4 * s];
+
+        for(int cy = cellY(box[1]); cy <= cellY(box[3]); cy++) {
+            for(int cx = cellX(box[0]); cx <= cellX(box[2]); cx++)
+                mCellItems[fill[cy * mNumCellsX + cx]++] = uint32_t(s);
+        }
+    }
+}
+
+template <class Visitor>
+void SpatialIndex::visit(float minX, float minY, float maxX, float maxY, Visitor visitor) const
+{
+    if(mSegments.empty())
+        return;
+
+    const int qx0 = cellX(minX), qx1 = cellX(maxX);
+    const int qy0 = cellY(minY), qy1 = cellY(maxY);
+
+    for(int cy = qy0; cy <= qy1; cy++) {
+        for(int cx = qx0; cx <= qx1; cx++) {
+
+            const size_t cell = size_t(cy) * mNumCellsX + cx;
+
+            for(uint32_t k = mCellStart[cell]; k < mCellStart[cell + 1]; k++) {
+
+                const uint32_t s = mCellItems[k];
+                const float *box = &mSegBox[4 * s];
+
+                // Segments spanning several cells are only reported from the first cell visited by the query
+                if(std::max(cellX(box[0]), qx0) != cx || std::max(cellY(box[1]), qy0) != cy)
+                    continue;
+
+                if(box[0] > maxX || box[2] < minX || box[1] > maxY || box[3] < minY)
+                    continue;
+
+                visitor(s);
+            }
+        }
+    }
+}
+
+std::vector<SpatialIndex::SegmentRef> SpatialIndex::querySegments(float minX, float minY, float maxX, float maxY) const
+{
+    std::vector<SegmentRef> segs;
+
+    visit(minX, minY, maxX, maxY, [&](uint32_t s) { segs.push_back(mSegments[s]); });
+
+    return segs;
+}
+
+std::vector<uint32_t> SpatialIndex::queryGeometry(float minX, float minY, float maxX, float maxY) const
+{
+    std::vector<uint32_t> geomIdx;
+
+    visit(minX, minY, maxX, maxY, [&](uint32_t s) { geomIdx.push_back(mSegments[s].geomIdx); });
+
+    std::sort(geomIdx.begin(), geomIdx.end());
+    geomIdx.erase(std::unique(geomIdx.begin(), geomIdx.end()), geomIdx.end());
+
+    return geomIdx;
+}
+
+namespace slm {
+
+void buildSpatialIndices(const std::vector<Layer::Ptr> &layers, unsigned int numThreads)
+{
+    // Layers assigned to a LayerCache are indexed serially, as their expansion may evict other layers
+    parallelFor(layers.size(), [&layers](size_t i) {
+        if(!layers[i]->cache())
+            layers[i]->spatialIndex();
+    }, numThreads);
+
+    for(const Layer::Ptr &layer : layers) {
+        if(layer->cache())
+            layer->spatialIndex();
+    }
+}
+
+}
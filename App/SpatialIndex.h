@@ -0,0 +1,79 @@
+#ifndef SLM_SPATIALINDEX_H_HEADER_HAS_BEEN_INCLUDED
+#define SLM_SPATIALINDEX_H_HEADER_HAS_BEEN_INCLUDED
+
+#include "SLM_Export.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "Layer.h"
+
+namespace slm
+{
+
+/**
+ * @brief The SpatialIndex class is a bulk-loaded uniform grid over the bounding boxes of the segments within a
+ * layer's geometry. A segment is a hatch vector (pair of points), an edge of a contour or an individual point
+ * for point geometry. The cell size is chosen from the density and the mean extent of the segments, so that each
+ * segment typically overlaps only a few cells.
+ */
+class SLM_EXPORT SpatialIndex
+{
+public:
+
+    typedef std::shared_ptr<SpatialIndex> Ptr;
+
+    struct SegmentRef
+    {
+        uint32_t geomIdx; // Index of the geometry within the layer
+        uint32_t segIdx;  // Index of the segment within the geometry
+    };
+
+    SpatialIndex();
+    ~SpatialIndex();
+
+public:
+
+    void build(const std::vector<LayerGeometry::Ptr> &geoms);
+    void clear();
+
+    /**
+     * Queries return the geometry indices (sorted and unique) or segments whose bounding box intersects the window
+     */
+    std::vector<uint32_t> queryGeometry(float minX, float minY, float maxX, float maxY) const;
+    std::vector<SegmentRef> querySegments(float minX, float minY, float maxX, float maxY) const;
+
+    /**
+     * Getters
+     */
+    size_t numSegments() const { return mSegments.size(); }
+    size_t numCells() const { return size_t(mNumCellsX) * size_t(mNumCellsY); }
+
+private:
+    int cellX(float x) const;
+    int cellY(float y) const;
+
+    template <class Visitor>
+    void visit(float minX, float minY, float maxX, float maxY, Visitor visitor) const;
+
+    std::vector<SegmentRef> mSegments;
+    std::vector<float> mSegBox; // (minX, minY, maxX, maxY) per segment
+
+    // Grid cells stored in compressed row form
+    std::vector<uint32_t> mCellStart;
+    std::vector<uint32_t> mCellItems;
+
+    float mOriginX, mOriginY;
+    float mInvCellSize;
+    int   mNumCellsX, mNumCellsY;
+};
+
+/**
+ * Builds the spatial index of each layer in parallel. Layers assigned to a LayerCache are indexed serially.
+ */
+SLM_EXPORT void buildSpatialIndices(const std::vector<Layer::Ptr> &layers, unsigned int numThreads = 0);
+
+} // End of Namespace slm
+
+#endif // SLM_SPATIALINDEX_H_HEADER_HAS_BEEN_INCLUDED
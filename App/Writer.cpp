@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <iostream>
 #include <fstream>
 
@@ -5,6 +6,10 @@
 #include <filesystem/resolver.h>
 #include <filesystem/path.h>
 
+#include "BuildStatistics.h"
+#include "LayerIndex.h"
+#include "MappedFile.h"
+#include "Parallel.h"
 #include "Writer.h"
 
 namespace fs = filesystem;
@@ -12,19 +17,67 @@ namespace fs = filesystem;
 using namespace slm;
 using namespace base;
 
+namespace {
+
+/*
+ * Calls fn(i, layer) for each layer in parallel. Layers assigned to a LayerCache are processed serially
+ * afterwards, as their expansion may evict other layers.
+ */
+template <class LayerAt, class Fn>
+void forEachLayer(size_t num, const LayerAt &layerAt, const Fn &fn, unsigned int numThreads)
+{
+    parallelFor(num, [&](size_t i) {
+        const Layer &layer = layerAt(i);
+
+        if(!layer.cache())
+            fn(i, layer);
+    }, numThreads);
+
+    for(size_t i = 0; i < num; i++) {
+        const Layer &layer = layerAt(i);
+
+        if(layer.cache())
+            fn(i, layer);
+    }
+}
+
+} // End of anonymous namespace
+
 Writer::Writer(const char * fname) : ready(false),
-                                     mSortLayers(false)
+                                     mSortLayers(false),
+                                     mIsStreaming(false),
+                                     mNumLayersWritten(0),
+                                     mWriteStatus(0),
+                                     mDirectIO(false),
+                                     mOutputBufferSize(4 << 20),
+                                     mMappedOutput(false),
+                                     mNumThreads(0)
 {
     this->setFilePath(std::string(fname));
 }
 
 Writer::Writer(const std::string &fname) : ready(false),
-                                           mSortLayers(false)
+                                           mSortLayers(false),
+                                           mIsStreaming(false),
+                                           mNumLayersWritten(0),
+                                           mWriteStatus(0),
+                                           mDirectIO(false),
+                                           mOutputBufferSize(4 << 20),
+                                           mMappedOutput(false),
+                                           mNumThreads(0)
 {
     this->setFilePath(fname);
 }
 
-Writer::Writer() : ready(false)
+Writer::Writer() : ready(false),
+                   mSortLayers(false),
+                   mIsStreaming(false),
+                   mNumLayersWritten(0),
+                   mWriteStatus(0),
+                   mDirectIO(false),
+                   mOutputBufferSize(4 << 20),
+                   mMappedOutput(false),
+                   mNumThreads(0)
 {
 }
 
@@ -42,113 +95,458 @@ void Writer::getFileHandle(std::fstream &file) const
     }
 }
 
-void Writer::setFilePath(const std::string &path)
+void Writer::write(const Header &header,
+                   const std::vector<Model::Ptr> &models,
+                   const std::vector<Layer::Ptr> &layers)
 {
-    this->setReady(true);
-    this->filePath = path;
-    std::cout << "File '" << path << "' is ready to write" << std::endl;
+    mWriteStatus = -1;
+
+    if(begin(header, models) == 0) {
+
+        // Layers are written through a permutation, unless already sorted
+        std::vector<size_t> order;
+
+        if(mSortLayers && !isSortedByZ(layers))
+            order = sortPermutation(layers);
+
+        if(writeLayers(layers, order.empty() ? nullptr : &order) == 0)
+            mWriteStatus = finish();
+    }
+
+    if(mWriteStatus != 0)
+        std::cerr << "Failed to write '" << filePath << "'" << std::endl;
 }
 
-Layer::Ptr Writer::getTopLayerByPosition(const std::vector<Layer::Ptr> &layers)
+int Writer::begin(const Header &header, const std::vector<Model::Ptr> &models)
+{
+    if(!this->isReady()) {
+        std::cerr << "Writer is not ready - a file path must be set" << std::endl;
+        return -1;
+    }
+
+    if(mIsStreaming) {
+        std::cerr << "Writer has already begun writing '" << filePath << "'" << std::endl;
+        return -1;
+    }
+
+    mNumLayersWritten = 0;
+    mLayerOffsets.clear();
+
+    if(writeHeader(header, models) != 0 || (mOutput && mOutput->hasError())) {
+        closeOutputSink();
+        return -1;
+    }
+
+    mIsStreaming = true;
+
+    return 0;
+}
+
+int Writer::writeLayer(const Layer &layer)
 {
-    uint64_t zMax = 0;
+    if(!mIsStreaming) {
+        std::cerr << "Layer (" << layer.getLayerId() << ") written before begin()" << std::endl;
+        return -1;
+    }
 
-    Layer::Ptr fndLayer;
+    if(writeLayerData(layer) != 0 || (mOutput && mOutput->hasError())) {
+        abandon();
+        return -1;
+    }
+
+    mNumLayersWritten++;
+
+    return 0;
+}
 
-    for(auto layer : layers) {
+int Writer::writeLayers(const std::vector<Layer::Ptr> &layers)
+{
+    return writeLayers(layers, nullptr);
+}
 
-        if(layer->getZ() > zMax) {
-            fndLayer = layer;
-            zMax = layer->getZ();
+int Writer::writeLayers(const std::vector<Layer::Ptr> &layers, const std::vector<size_t> *order)
+{
+    auto layerAt = [&layers, order](size_t i) -> const Layer & { return *layers[order ? (*order)[i] : i]; };
+
+    if(!supportsLayerEncoding()) {
+        for(size_t i = 0; i < layers.size(); i++) {
+            if(writeLayer(layerAt(i)) != 0)
+                return -1;
         }
+
+        return 0;
+    }
+
+    if(!mIsStreaming) {
+        std::cerr << "Layers written before begin()" << std::endl;
+        return -1;
+    }
+
+    const unsigned int numThreads = mNumThreads > 0 ? mNumThreads : defaultNumThreads();
+
+    if(mMappedOutput && supportsLayerSizing() && MappedFile::isSupported() && mOutput && !mOutput->isDirectIO()) {
+
+        std::vector<int64_t> sizes(layers.size());
+
+        forEachLayer(layers.size(), layerAt, [&](size_t i, const Layer &layer) {
+            sizes[i] = layerEncodedSize(layer);
+        }, numThreads);
+
+        // Layers of unknown size are written via the buffered path below
+        if(std::find_if(sizes.begin(), sizes.end(), [](int64_t size) { return size < 0; }) == sizes.end())
+            return writeLayersMapped(layers, order, sizes);
     }
 
-    return fndLayer;
+    if(layers.empty())
+        return 0;
+
+    // Layers are encoded by the workers ahead of those written, up to a window which bounds the memory used
+    WorkerPool *workers = numThreads > 1 ? workerPool(numThreads) : nullptr;
+    const size_t window = std::min<size_t>(workers ? workers->capacity() : 1, layers.size());
+
+    std::vector<std::vector<uint8_t>> buffers(window);
+    std::vector<std::future<int>> encoded(window);
+
+    auto submit = [&](size_t i) {
+        const Layer &layer = layerAt(i);
+        std::vector<uint8_t> &buffer = buffers[i % window];
+
+        // Layers assigned to a LayerCache are encoded serially when written, as their expansion may evict other layers
+        if(workers && !layer.cache()) {
+            encoded[i % window] = workers->submit([this, &layer, &buffer]() {
+                buffer.clear();
+                return encodeLayer(layer, buffer);
+            });
+        }
+    };
+
+    // Layers still being encoded refer to the buffers, hence are awaited before returning
+    auto awaitEncoded = [&encoded]() {
+        for(std::future<int> &result : encoded) {
+            if(result.valid())
+                result.wait();
+        }
+    };
+
+    int status = 0;
+
+    try {
+        for(size_t i = 0; i < window; i++)
+            submit(i);
+
+        for(size_t i = 0; i < layers.size(); i++) {
+
+            const size_t slot = i % window;
+
+            if(encoded[slot].valid()) {
+                status = encoded[slot].get();
+            } else {
+                buffers[slot].clear();
+                status = encodeLayer(layerAt(i), buffers[slot]);
+            }
+
+            if(status != 0 || emitLayer(buffers[slot]) != 0) {
+                status = -1;
+                break;
+            }
+
+            mNumLayersWritten++;
+
+            if(i + window < layers.size())
+                submit(i + window);
+        }
+    } catch(...) {
+        awaitEncoded();
+        abandon();
+        throw;
+    }
+
+    awaitEncoded();
+
+    if(status != 0) {
+        abandon();
+        return -1;
+    }
+
+    return 0;
 }
 
-Layer::Ptr Writer::getTopLayerById(const std::vector<Layer::Ptr> &layers)
+int Writer::writeLayersMapped(const std::vector<Layer::Ptr> &layers,
+                              const std::vector<size_t> *order,
+                              const std::vector<int64_t> &sizes)
 {
-    uint64_t zId = 0;
+    auto layerAt = [&layers, order](size_t i) -> const Layer & { return *layers[order ? (*order)[i] : i]; };
+
+    const unsigned int numThreads = mNumThreads > 0 ? mNumThreads : defaultNumThreads();
 
-    Layer::Ptr fndLayer;
+    // Offsets of each layer relative to the start of the reserved region
+    std::vector<uint64_t> offsets(layers.size());
+    uint64_t total = 0;
 
-    for(auto layer : layers) {
+    for(size_t i = 0; i < layers.size(); i++) {
+        offsets[i] = total;
+        total += uint64_t(sizes[i]);
+    }
+
+    const uint64_t base = mOutput->position();
 
-        if(layer->getLayerId() > zId) {
-            fndLayer = layer;
-            zId = layer->getLayerId();
+    if(mOutput->reserve(total) != 0) {
+        abandon();
+        return -1;
+    }
+
+    std::vector<int> status(layers.size(), 0);
+    MappedFile mapping;
+
+    if(total > 0 && mapping.mapForWrite(filePath, base, total) == 0) {
+
+        uint8_t *data = mapping.data();
+
+        forEachLayer(layers.size(), layerAt, [&](size_t i, const Layer &layer) {
+            status[i] = encodeLayerInto(layer, data + offsets[i], size_t(sizes[i]));
+        }, numThreads);
+
+        if(mapping.close() != 0)
+            std::fill(status.begin(), status.end(), -1);
+
+    } else if(total > 0) {
+
+        // The reserved region is written via the output sink if the file cannot be mapped
+        std::vector<uint8_t> buffer;
+
+        for(size_t i = 0; i < layers.size() && status[i] == 0; i++) {
+            buffer.clear();
+            status[i] = encodeLayer(layerAt(i), buffer);
+
+            if(status[i] == 0 && buffer.size() != uint64_t(sizes[i])) {
+                std::cerr << "Layer (" << layerAt(i).getLayerId() << ") encoded size differs from its computed size" << std::endl;
+                status[i] = -1;
+            }
+
+            if(status[i] == 0)
+                status[i] = mOutput->writeAt(base + offsets[i], buffer.data(), buffer.size());
         }
     }
 
-    return fndLayer;
+    if(std::find_if(status.begin(), status.end(), [](int val) { return val != 0; }) != status.end() || mOutput->hasError()) {
+        abandon();
+        return -1;
+    }
+
+    for(size_t i = 0; i < layers.size(); i++)
+        mLayerOffsets.push_back(base + offsets[i]);
+
+    mNumLayersWritten += layers.size();
+
+    return 0;
 }
 
-std::vector<Layer::Ptr> Writer::sortLayers(const std::vector<Layer::Ptr> &layers)
+int Writer::emitLayer(const std::vector<uint8_t> &buffer)
 {
-    std::vector<Layer::Ptr> layersCpy(layers);
+    if(!mOutput) {
+        std::cerr << "Encoded layers require an output sink - see openOutputSink()" << std::endl;
+        return -1;
+    }
 
-    std::sort(layersCpy.begin(), layersCpy.end(), [](Layer::Ptr a, Layer::Ptr b) {
-        return a->getZ() < b->getZ();
-    });
+    mLayerOffsets.push_back(mOutput->position());
 
-    return layersCpy;
+    return mOutput->write(buffer.data(), buffer.size());
 }
 
-int64_t Writer::getTotalNumHatches(const std::vector<Layer::Ptr> &layers)
+WorkerPool * Writer::workerPool(unsigned int numThreads)
 {
-    return Writer::getTotalGeoms<HatchGeometry>(layers);
+    if(!mWorkers || mWorkers->numThreads() != numThreads)
+        mWorkers.reset(new WorkerPool(numThreads));
+
+    return mWorkers.get();
 }
 
+void Writer::abandon()
+{
+    mIsStreaming = false;
+    mWorkers.reset();
+    closeOutputSink();
+}
 
-int64_t Writer::getTotalNumContours(const std::vector<Layer::Ptr> &layers)
+int Writer::finish()
 {
-    return Writer::getTotalGeoms<ContourGeometry>(layers);
+    if(!mIsStreaming) {
+        std::cerr << "Writer finished before begin()" << std::endl;
+        return -1;
+    }
+
+    mIsStreaming = false;
+    mWorkers.reset();
+
+    const int status = writeFooter();
+
+    // Any data buffered by the output sink is written before completing
+    if(mOutput && closeOutputSink() != 0)
+        return -1;
+
+    return status;
 }
 
-void Writer::getLayerBoundingBox(float *bbox, Layer::Ptr layer)
+OutputSink * Writer::openOutputSink()
 {
-    float minX = 1e9, minY = 1e9 , maxX = -1e9, maxY = -1e9;
+    mOutput.reset(new OutputSink(mOutputBufferSize));
+
+    if(mOutput->open(filePath, mDirectIO) != 0) {
+        mOutput.reset();
+        return nullptr;
+    }
 
-    for(auto geom : layer->geometry()) {
-        auto minCols = geom->coords.colwise().minCoeff();
-        auto maxCols = geom->coords.colwise().maxCoeff();
+    return mOutput.get();
+}
 
-        if(minCols[0, 0] < minX)
-            minX = minCols[0,0];
+int Writer::closeOutputSink()
+{
+    if(!mOutput)
+        return 0;
 
-        if(minCols[0,1] < minY)
-            minY = minCols[0,1];
+    const int status = mOutput->close();
+    mOutput.reset();
 
-        if(maxCols[0,0] > maxX)
-            maxX = maxCols[0,0];
+    return status;
+}
 
-        if(maxCols[0,1] > maxY)
-            maxY = maxCols[0,1];
+int Writer::writeHeader(const Header &, const std::vector<Model::Ptr> &)
+{
+    return 0;
+}
+
+int Writer::writeLayerData(const Layer &layer)
+{
+    if(!supportsLayerEncoding()) {
+        std::cerr << "Writer does not support writing individual layers" << std::endl;
+        return -1;
     }
+
+    std::vector<uint8_t> buffer;
+
+    if(encodeLayer(layer, buffer) != 0)
+        return -1;
+
+    return emitLayer(buffer);
 }
 
-void Writer::getBoundingBox(float *bbox, const std::vector<Layer::Ptr> &layers)
+int Writer::encodeLayer(const Layer &, std::vector<uint8_t> &) const
 {
-    float minX = 1e9, minY = 1e9 , maxX = -1e9, maxY = -1e9;
+    return -1;
+}
 
-    for (auto layer: layers) {
-        for(auto geom : layer->geometry()) {
-            auto minCols = geom->coords.colwise().minCoeff();
-            auto maxCols = geom->coords.colwise().maxCoeff();
+int64_t Writer::layerEncodedSize(const Layer &) const
+{
+    return -1;
+}
 
-            if(minCols[0, 0] < minX)
-                minX = minCols[0,0];
+int Writer::encodeLayerInto(const Layer &layer, uint8_t *dst, size_t size) const
+{
+    std::vector<uint8_t> buffer;
 
-            if(minCols[0,1] < minY)
-                minY = minCols[0,1];
+    if(encodeLayer(layer, buffer) != 0)
+        return -1;
 
-            if(maxCols[0,0] > maxX)
-                maxX = maxCols[0,0];
+    if(buffer.size() != size) {
+        std::cerr << "Layer (" << layer.getLayerId() << ") encoded size differs from its computed size" << std::endl;
+        return -1;
+    }
 
-            if(maxCols[0,1] > maxY)
-                maxY = maxCols[0,1];
+    std::copy(buffer.begin(), buffer.end(), dst);
 
-        }
+    return 0;
+}
+
+int Writer::writeFooter()
+{
+    return 0;
+}
+
+void Writer::setFilePath(const std::string &path)
+{
+    this->setReady(true);
+    this->filePath = path;
+    std::cout << "File '" << path << "' is ready to write" << std::endl;
+}
+
+Layer::Ptr Writer::getTopLayerByPosition(const std::vector<Layer::Ptr> &layers)
+{
+    return LayerIndex::findTopLayerByZ(layers);
+}
+
+Layer::Ptr Writer::getTopLayerById(const std::vector<Layer::Ptr> &layers)
+{
+    return LayerIndex::findTopLayerById(layers);
+}
+
+namespace {
+
+inline bool layerZLess(const Layer::Ptr &a, const Layer::Ptr &b)
+{
+    return a->getZ() < b->getZ();
+}
+
+} // End of anonymous namespace
+
+std::vector<Layer::Ptr> Writer::sortLayers(const std::vector<Layer::Ptr> &layers)
+{
+    std::vector<Layer::Ptr> layersCpy(layers);
+
+    sortLayersInPlace(layersCpy);
+
+    return layersCpy;
+}
+
+bool Writer::isSortedByZ(const std::vector<Layer::Ptr> &layers)
+{
+    return std::is_sorted(layers.cbegin(), layers.cend(), layerZLess);
+}
+
+std::vector<size_t> Writer::sortPermutation(const std::vector<Layer::Ptr> &layers)
+{
+    std::vector<size_t> order(layers.size());
+
+    for(size_t i = 0; i < order.size(); i++)
+        order[i] = i;
+
+    if(isSortedByZ(layers))
+        return order;
+
+    std::stable_sort(order.begin(), order.end(), [&layers](size_t a, size_t b) {
+        return layers[a]->getZ() < layers[b]->getZ();
+    });
+
+    return order;
+}
+
+void Writer::sortLayersInPlace(std::vector<Layer::Ptr> &layers)
+{
+    if(!isSortedByZ(layers))
+        std::stable_sort(layers.begin(), layers.end(), layerZLess);
+}
+
+int64_t Writer::getTotalNumHatches(const std::vector<Layer::Ptr> &layers)
+{
+    return Writer::getTotalGeoms<HatchGeometry>(layers);
+}
+
+
+int64_t Writer::getTotalNumContours(const std::vector<Layer::Ptr> &layers)
+{
+    return Writer::getTotalGeoms<ContourGeometry>(layers);
+}
+
+void Writer::getLayerBoundingBox(float *bbox, const Layer::Ptr &layer)
+{
+    float minX = 1e9, minY = 1e9 , maxX = -1e9, maxY = -1e9;
+
+    const LayerMetrics &metrics = layer->metrics();
+
+    if(metrics.numPoints > 0) {
+        minX = metrics.bbox[0];
+        maxX = metrics.bbox[1];
+        minY = metrics.bbox[2];
+        maxY = metrics.bbox[3];
     }
 
     bbox[0] = minX;
@@ -157,23 +555,17 @@ void Writer::getBoundingBox(float *bbox, const std::vector<Layer::Ptr> &layers)
     bbox[3] = maxY;
 }
 
-std::tuple<float, float> Writer::getLayerMinMax(const std::vector<slm::Layer::Ptr> &layers)
+void Writer::getBoundingBox(float *bbox, const std::vector<Layer::Ptr> &layers)
 {
-    float zMin = 0.0;
-    float zMax = 0.0;
-    float zPos = 0.0;
+    const BuildStatistics stats = BuildStatistics::compute(layers, 0, false);
 
-    for (auto layer : layers) {
-
-        zPos = layer->getZ();
-
-        if(zPos < zMin)
-            zMin = zPos;
+    std::copy(stats.bbox, stats.bbox + 4, bbox);
+}
 
-        if(zPos > zMax)
-            zMax = zPos;
-    }
+std::tuple<float, float> Writer::getLayerMinMax(const std::vector<slm::Layer::Ptr> &layers)
+{
+    const BuildStatistics stats = BuildStatistics::compute(layers, 0, false);
 
-    return std::make_tuple(zMin, zMax);
+    return std::make_tuple(float(stats.zMin), float(stats.zMax));
 }
 
@@ -3,15 +3,19 @@
 
 #include "SLM_Export.h"
 
+#include <memory>
 #include <string>
 
 #include "Header.h"
 #include "Layer.h"
 #include "Model.h"
+#include "OutputSink.h"
 
 namespace slm
 {
 
+class WorkerPool;
+
 namespace base
 {
 
@@ -30,16 +34,76 @@ public:
     const std::string & getFilePath() { return filePath; }
     void setFilePath( const std::string &path);
 
+    /**
+     * Writes the entire build. The default implementation streams the layers (sorted by Z when sorting is enabled)
+     * through begin(), writeLayer() and finish(). The result is available afterwards via writeStatus(), which is
+     * zero on success or -1 on failure (reported to std::cerr).
+     */
     virtual void write(const Header &header,
                        const std::vector<Model::Ptr> &models,
-                       const std::vector<Layer::Ptr> &layers) = 0;
+                       const std::vector<Layer::Ptr> &layers);
+
+    int writeStatus() const { return mWriteStatus; }
+
+    /**
+     * Streaming interface, so that layers may be written as they are generated and released afterwards.
+     * begin() writes the header and models, writeLayer() is called for each layer in order and finish() completes
+     * the file (e.g. patching offset tables). Each returns zero on success or -1 on failure, after which the stream
+     * is abandoned.
+     */
+    int begin(const Header &header, const std::vector<Model::Ptr> &models);
+    int writeLayer(const Layer &layer);
+    int finish();
+
+    /**
+     * Writes a sequence of layers in order. For writers supporting layer encoding, the layers are encoded in
+     * parallel into separate buffers by a pool of workers, started once per stream, with a bounded number of
+     * encoded layers pending, which are written in order, so that the output is identical regardless of the number
+     * of threads. Otherwise, each layer is written via writeLayer().
+     *
+     * Writers which can also compute the encoded size of each layer up front are instead sized in parallel, the
+     * region for all layers is reserved in the file and memory mapped once, and the layers are encoded directly
+     * into their final position in parallel. This is used when mapped output is enabled and supported by the
+     * platform, and direct I/O is not in use.
+     *
+     * Mapped output is disabled by default: dirtying the mapped pages and the synchronous msync upon closing the
+     * mapping measure slower than appending the encoded layers to the asynchronous OutputSink (see the mappedOutput
+     * benchmark).
+     */
+    int writeLayers(const std::vector<Layer::Ptr> &layers);
+
+    /**
+     * File offset of each layer written via encodeLayer(), in the order written
+     */
+    const std::vector<uint64_t> & layerOffsets() const { return mLayerOffsets; }
+
+    bool isMappedOutput() const { return mMappedOutput; }
+    void setMappedOutput(bool state) { mMappedOutput = state; }
+
+    unsigned int numThreads() const { return mNumThreads; }
+    void setNumThreads(unsigned int val) { mNumThreads = val; }
+
+    bool isStreaming() const { return mIsStreaming; }
+    uint64_t numLayersWritten() const { return mNumLayersWritten; }
+
+    /**
+     * Options for the asynchronous output sink opened by writers via openOutputSink()
+     */
+    bool isDirectIO() const { return mDirectIO; }
+    void setDirectIO(bool state) { mDirectIO = state; }
+    size_t outputBufferSize() const { return mOutputBufferSize; }
+    void setOutputBufferSize(size_t size) { mOutputBufferSize = size; }
 
     bool isSortingLayers() const { return mSortLayers; }
     void setSortLayers(bool state) { mSortLayers = state; }
 
 public:
+     /**
+      * Statistics of the build are computed via BuildStatistics, which caches the metrics within each layer, so
+      * that these can be called repeatedly whilst writing without traversing the geometry again
+      */
      static void getBoundingBox(float *bbox, const std::vector<Layer::Ptr> &layers);
-     static void getLayerBoundingBox(float *bbox, Layer::Ptr layer);
+     static void getLayerBoundingBox(float *bbox, const Layer::Ptr &layer);
      static std::tuple<float, float> getLayerMinMax(const std::vector<slm::Layer::Ptr> &layers);
 
      static Layer::Ptr getTopLayerByPosition(const std::vector<Layer::Ptr> &layers);
@@ -48,27 +112,90 @@ public:
      static int64_t getTotalNumHatches(const std::vector<Layer::Ptr> &layers);
      static int64_t getTotalNumContours(const std::vector<Layer::Ptr> &layers);
      static std::vector<Layer::Ptr> sortLayers(const std::vector<Layer::Ptr> &layers);
+
+     /**
+      * Layers are ordered by ascending Z, with layers of equal Z retaining their order. The permutation holds the
+      * index of each layer in sorted order, without copying the layers, and is the identity if already sorted.
+      */
+     static bool isSortedByZ(const std::vector<Layer::Ptr> &layers);
+     static std::vector<size_t> sortPermutation(const std::vector<Layer::Ptr> &layers);
+     static void sortLayersInPlace(std::vector<Layer::Ptr> &layers);
      template <class T>
      static int64_t getTotalGeoms(const std::vector<slm::Layer::Ptr> &layers)
      {
          int64_t numGeomT = 0;
 
-         for(auto layer : layers)
-             numGeomT += layer->getGeometryByType<T>().size();
+         for(const Layer::Ptr &layer : layers)
+             numGeomT += layer->geometryByType<T>().size();
 
          return numGeomT;
      }
 
 protected:
     void setReady(bool state) { ready = state; }
+    void setWriteStatus(int status) { mWriteStatus = status; }
     void getFileHandle(std::fstream &file) const;
-    
+
+    /**
+     * Format specific implementation of the streaming interface. Writers which only override write() need not
+     * implement these.
+     */
+    virtual int writeHeader(const Header &header, const std::vector<Model::Ptr> &models);
+    virtual int writeLayerData(const Layer &layer);
+    virtual int writeFooter();
+
+    /**
+     * Writers may instead serialise each layer independently into a buffer, which must be safe to call concurrently
+     * for different layers. The default writeLayerData() encodes the layer and appends it to the output sink.
+     */
+    virtual bool supportsLayerEncoding() const { return false; }
+    virtual int encodeLayer(const Layer &layer, std::vector<uint8_t> &buffer) const;
+
+    /**
+     * Writers supporting layer encoding may also provide the exact encoded size of each layer (-1 if unknown)
+     * and encode a layer into memory of that size, so that layers can be written into a memory mapped file.
+     * Both must be safe to call concurrently for different layers. The default encodeLayerInto() copies the
+     * result of encodeLayer().
+     */
+    virtual bool supportsLayerSizing() const { return false; }
+    virtual int64_t layerEncodedSize(const Layer &layer) const;
+    virtual int encodeLayerInto(const Layer &layer, uint8_t *dst, size_t size) const;
+
+    /**
+     * Opens an asynchronous double-buffered OutputSink on the file path, so that encoding overlaps writing to the
+     * file. An error writing to the sink fails the current writeLayer() or finish(), after which the sink is closed.
+     */
+    OutputSink * openOutputSink();
+    OutputSink * outputSink() const { return mOutput.get(); }
+    int closeOutputSink();
+
+private:
+    int writeLayers(const std::vector<Layer::Ptr> &layers, const std::vector<size_t> *order);
+    int writeLayersMapped(const std::vector<Layer::Ptr> &layers,
+                          const std::vector<size_t> *order,
+                          const std::vector<int64_t> &sizes);
+    int emitLayer(const std::vector<uint8_t> &buffer);
+    WorkerPool * workerPool(unsigned int numThreads);
+    void abandon();
+
 protected:
     std::string filePath;
 
 private:
     bool ready;
     bool mSortLayers;
+    bool mIsStreaming;
+    uint64_t mNumLayersWritten;
+    int mWriteStatus;
+
+    std::unique_ptr<OutputSink> mOutput;
+    bool mDirectIO;
+    size_t mOutputBufferSize;
+
+    std::vector<uint64_t> mLayerOffsets;
+    bool mMappedOutput;
+    unsigned int mNumThreads;
+    std::unique_ptr<WorkerPool> mWorkers;
 };
 
 } // End of Namespace Base
@@ -0,0 +1,87 @@
+#include <memory>
+
+#include <App/Reader.h>
+
+#include "Bench.h"
+
+using namespace slm;
+
+namespace
+{
+
+/**
+ * Reader generating a synthetic build, which allocates its layers and geometry as a translator would whilst parsing
+ */
+class SyntheticReader : public base::Reader
+{
+public:
+    SyntheticReader(size_t numLayers, size_t numGeoms, size_t numPoints) : mNumLayers(numLayers),
+                                                                           mNumGeoms(numGeoms),
+                                                                           mNumPoints(numPoints) {}
+
+    int parse() override
+    {
+        for(size_t i = 0; i < mNumLayers; i++) {
+
+            Layer::Ptr layer = createLayer(i, i * 30);
+
+            for(size_t j = 0; j < mNumGeoms; j++) {
+
+                HatchGeometry::Ptr geom = layer->createGeometry<HatchGeometry>(1, 1, Eigen::Index(mNumPoints));
+                LayerGeometry::CoordsMap coords = geom->mutableCoordinates();
+
+                for(Eigen::Index k = 0; k < coords.rows(); k++) {
+                    coords(k, 0) = float(k);
+                    coords(k, 1) = float(j);
+                }
+
+                layer->addGeometry<HatchGeometry>(std::move(geom));
+            }
+
+            layers.push_back(std::move(layer));
+        }
+
+        setReady(true);
+        return 0;
+    }
+
+    double getLayerThickness() const override { return 30.0; }
+
+private:
+    size_t mNumLayers;
+    size_t mNumGeoms;
+    size_t mNumPoints;
+};
+
+} // End of Anonymous Namespace
+
+/*
+ * Parse and teardown time of a build of short hatch geometries (2 vectors each), allocated individually or from
+ * a per-layer MemoryArena (base::Reader::setArenaAllocation)
+ */
+SLM_BENCHMARK(arenaParse)
+{
+    const size_t numLayers = opts.scaled(500);
+    const size_t numGeoms = 2000;
+    const size_t numPoints = 4;
+
+    for(int arena = 0; arena < 2; arena++) {
+
+        std::unique_ptr<SyntheticReader> reader(new SyntheticReader(numLayers, numGeoms, numPoints));
+        reader->setArenaAllocation(arena == 1);
+
+        bench::Timer timer;
+        reader->parse();
+        const double parseTime = timer.elapsed();
+
+        timer.restart();
+        reader.reset();
+        const double teardownTime = timer.elapsed();
+
+        const std::string mode = arena ? "arena" : "heap";
+        const std::string note = std::to_string(numLayers * numGeoms * numPoints / 2) + " vectors";
+
+        bench::report("arenaParse", mode + " parse", parseTime, note);
+        bench::report("arenaParse", mode + " teardown", teardownTime);
+    }
+}
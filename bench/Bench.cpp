@@ -0,0 +1,173 @@
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+#include <App/Parallel.h>
+
+#include "Bench.h"
+
+using namespace slm;
+using namespace slm::bench;
+
+std::vector<unsigned int> Options::threadCounts() const
+{
+    const unsigned int numThreads = maxThreads > 0 ? maxThreads : defaultNumThreads();
+
+    std::vector<unsigned int> counts;
+
+    for(unsigned int n = 1; n < numThreads; n *= 2)
+        counts.push_back(n);
+
+    counts.push_back(numThreads);
+
+    return counts;
+}
+
+std::vector<Benchmark> & bench::registry()
+{
+    static std::vector<Benchmark> benchmarks;
+    return benchmarks;
+}
+
+void bench::report(const std::string &benchmark, const std::string &variant, double seconds, const std::string &note)
+{
+    std::cout << std::left << std::setw(20) << benchmark
+              << std::setw(36) << variant
+              << std::right << std::setw(12) << std::fixed << std::setprecision(3) << seconds * 1e3 << " ms"
+              << (note.empty() ? "" : "   ") << note << std::endl;
+}
+
+std::string bench::formatRate(double bytes, double seconds)
+{
+    std::ostringstream str;
+    str << std::fixed << std::setprecision(2) << (seconds > 0.0 ? bytes / seconds / 1e9 : 0.0) << " GB/s";
+    return str.str();
+}
+
+std::string bench::formatRatio(double value)
+{
+    std::ostringstream str;
+    str << std::fixed << std::setprecision(2) << value << "x";
+    return str.str();
+}
+
+Layer::Ptr bench::makeLayer(uint64_t id, size_t numHatches, size_t numContours, size_t pointsPerGeometry, std::mt19937 &rng)
+{
+    std::uniform_real_distribution<float> pos(0.f, 100.f);
+    std::uniform_real_distribution<float> step(-1.f, 1.f);
+
+    Layer::Ptr layer = std::make_shared<Layer>(id, id * 30);
+
+    for(size_t i = 0; i < numHatches; i++) {
+
+        HatchGeometry::Ptr geom = std::make_shared<HatchGeometry>(1, uint32_t(i % 4 + 1));
+        geom->coords.resize(Eigen::Index(pointsPerGeometry & ~size_t(1)), 2);
+
+        // Neighbouring hatch vectors in a region, as produced by slicing software
+        const float x0 = pos(rng), y0 = pos(rng);
+
+        for(Eigen::Index j = 0; j < geom->coords.rows(); j += 2) {
+            const float y = y0 + 0.1f * float(j / 2);
+            geom->coords.row(j) << x0 + step(rng), y;
+            geom->coords.row(j + 1) << x0 + 5.f + step(rng), y;
+        }
+
+        layer->addHatchGeometry(geom);
+    }
+
+    for(size_t i = 0; i < numContours; i++) {
+
+        ContourGeometry::Ptr geom = std::make_shared<ContourGeometry>(1, 5);
+        geom->coords.resize(Eigen::Index(pointsPerGeometry), 2);
+
+        const float cx = pos(rng), cy = pos(rng);
+
+        for(Eigen::Index j = 0; j < geom->coords.rows(); j++) {
+            const float theta = 6.2831853f * float(j) / float(geom->coords.rows() - 1);
+            geom->coords.row(j) << cx + 2.f * std::cos(theta), cy + 2.f * std::sin(theta);
+        }
+
+        layer->addContourGeometry(geom);
+    }
+
+    return layer;
+}
+
+std::vector<Layer::Ptr> bench::makeBuild(size_t numLayers, size_t numHatches, size_t numContours,
+                                         size_t pointsPerGeometry, uint32_t seed)
+{
+    std::mt19937 rng(seed);
+    std::vector<Layer::Ptr> layers;
+    layers.reserve(numLayers);
+
+    for(size_t i = 0; i < numLayers; i++)
+        layers.push_back(makeLayer(i, numHatches, numContours, pointsPerGeometry, rng));
+
+    return layers;
+}
+
+void bench::doNotOptimize(double val)
+{
+    static volatile double sink = 0.0;
+    sink = sink + val;
+}
+
+static void printUsage()
+{
+    std::cout << "Usage: slm_bench [--list] [--scale S] [--threads N] [--tmp DIR] [benchmark ...]" << std::endl
+              << "Runs the selected benchmarks (by default all), whose problem sizes are multiplied by the scale" << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+    Options opts;
+    std::vector<std::string> selected;
+
+    for(int i = 1; i < argc; i++) {
+
+        const std::string arg(argv[i]);
+
+        if(arg == "--list") {
+            for(const Benchmark &b : registry())
+                std::cout << b.name << std::endl;
+            return 0;
+        } else if(arg == "--scale" && i + 1 < argc) {
+            opts.scale = std::atof(argv[++i]);
+        } else if(arg == "--threads" && i + 1 < argc) {
+            opts.maxThreads = unsigned(std::atoi(argv[++i]));
+        } else if(arg == "--tmp" && i + 1 < argc) {
+            opts.tempDir = argv[++i];
+        } else if(arg == "--help" || arg[0] == '-') {
+            printUsage();
+            return arg == "--help" ? 0 : -1;
+        } else {
+            selected.push_back(arg);
+        }
+    }
+
+    int numRun = 0;
+
+    for(const Benchmark &b : registry()) {
+
+        bool run = selected.empty();
+
+        for(const std::string &name : selected)
+            run = run || b.name.find(name) != std::string::npos;
+
+        if(!run)
+            continue;
+
+        b.fn(opts);
+        numRun++;
+    }
+
+    if(numRun == 0) {
+        std::cerr << "No benchmarks were selected" << std::endl;
+        return -1;
+    }
+
+    return 0;
+}
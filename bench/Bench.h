@@ -0,0 +1,99 @@
+#ifndef SLM_BENCH_H_HEADER_HAS_BEEN_INCLUDED
+#define SLM_BENCH_H_HEADER_HAS_BEEN_INCLUDED
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <App/Layer.h>
+
+namespace slm
+{
+
+namespace bench
+{
+
+/**
+ * Options passed to every benchmark. The size of each benchmark's problem is multiplied by the scale, so that
+ * the defaults run quickly whilst production sized builds (e.g. 10M+ vectors) may be requested explicitly.
+ */
+struct Options
+{
+    double scale = 1.0;
+    unsigned int maxThreads = 0;   // Upper bound of thread scaling benchmarks (zero uses the hardware concurrency)
+    std::string tempDir = ".";     // Directory for the files written and read by I/O benchmarks
+
+    size_t scaled(size_t n) const { return std::max<size_t>(1, size_t(double(n) * scale)); }
+
+    // Thread counts of scaling benchmarks: powers of two up to, and including, the maximum number of threads
+    std::vector<unsigned int> threadCounts() const;
+};
+
+typedef void (*Function)(const Options &opts);
+
+struct Benchmark
+{
+    std::string name;
+    Function fn;
+};
+
+std::vector<Benchmark> & registry();
+
+struct Registrar
+{
+    Registrar(const char *name, Function fn) { registry().push_back(Benchmark{name, fn}); }
+};
+
+/**
+ * Defines a benchmark function, which is registered with the executable and run when selected on the command line
+ */
+#define SLM_BENCHMARK(name) \
+    static void name(const slm::bench::Options &opts); \
+    static slm::bench::Registrar name##Registrar(#name, &name); \
+    static void name(const slm::bench::Options &opts)
+
+class Timer
+{
+public:
+    Timer() : mStart(std::chrono::steady_clock::now()) {}
+
+    void restart() { mStart = std::chrono::steady_clock::now(); }
+
+    // Elapsed time in seconds
+    double elapsed() const {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - mStart).count();
+    }
+
+private:
+    std::chrono::steady_clock::time_point mStart;
+};
+
+/**
+ * Prints a single result line in the form: benchmark  variant  time (ms)  [note]
+ */
+void report(const std::string &benchmark, const std::string &variant, double seconds, const std::string &note = "");
+
+std::string formatRate(double bytes, double seconds);
+std::string formatRatio(double value);
+
+/**
+ * Synthetic build data - each layer consists of hatch geometries of random segments and closed contours within
+ * a 100 x 100 mm region.
+ */
+Layer::Ptr makeLayer(uint64_t id, size_t numHatches, size_t numContours, size_t pointsPerGeometry, std::mt19937 &rng);
+
+std::vector<Layer::Ptr> makeBuild(size_t numLayers, size_t numHatches, size_t numContours, size_t pointsPerGeometry,
+                                  uint32_t seed = 1);
+
+// Prevents the compiler from discarding the computation of a value
+void doNotOptimize(double val);
+
+} // End of Namespace bench
+
+} // End of Namespace slm
+
+#endif // SLM_BENCH_H_HEADER_HAS_BEEN_INCLUDED
@@ -0,0 +1,121 @@
+#include <cmath>
+
+#include <App/LayerCompression.h>
+
+#include "Bench.h"
+
+using namespace slm;
+
+namespace
+{
+
+/*
+ * Hatch-dense layer as produced by slicing software: parallel hatch vectors, rotated by 67 degrees each layer and
+ * clipped to circular islands, with coordinates on a 1 um grid (as read from machine formats)
+ */
+Layer::Ptr makeHatchedLayer(uint64_t id, size_t numIslands, std::mt19937 &rng)
+{
+    std::uniform_real_distribution<double> pos(20.0, 230.0);
+
+    const double resolution = 1e-3;
+    const double spacing = 0.08;
+    const double radius = 10.0;
+    const double angle = double(id % 360) * 67.0 * 3.14159265358979 / 180.0;
+
+    Layer::Ptr layer = std::make_shared<Layer>(id, id * 30);
+
+    Quantization quant;
+    quant.scale = resolution;
+    layer->setQuantization(quant);
+
+    const double c = std::cos(angle), s = std::sin(angle);
+
+    for(size_t i = 0; i < numIslands; i++) {
+
+        const double cx = pos(rng), cy = pos(rng);
+        const int numVectors = int(2.0 * radius / spacing);
+
+        HatchGeometry::Ptr geom = std::make_shared<HatchGeometry>(1, 1);
+        geom->coords.resize(2 * numVectors, 2);
+
+        for(int j = 0; j < numVectors; j++) {
+
+            const double v = -radius + (j + 0.5) * spacing;
+            const double u = std::sqrt(radius * radius - v * v);
+
+            for(int end = 0; end < 2; end++) {
+                const double uu = end ? u : -u;
+                const double x = cx + uu * c - v * s;
+                const double y = cy + uu * s + v * c;
+
+                geom->coords(2 * j + end, 0) = float(double(int32_t(std::round(x / resolution))) * resolution);
+                geom->coords(2 * j + end, 1) = float(double(int32_t(std::round(y / resolution))) * resolution);
+            }
+        }
+
+        layer->addHatchGeometry(geom);
+    }
+
+    return layer;
+}
+
+void run(const std::string &variant, const std::vector<Layer::Ptr> &layers)
+{
+    size_t expandedBytes = 0;
+
+    for(const Layer::Ptr &layer : layers) {
+        for(const LayerGeometry::Ptr &geom : layer->geometry())
+            expandedBytes += size_t(geom->numPoints()) * 2 * sizeof(float);
+    }
+
+    bench::Timer timer;
+
+    size_t compressedBytes = 0;
+
+    for(const Layer::Ptr &layer : layers) {
+        layer->compress();
+        compressedBytes += layer->compressedSize();
+    }
+
+    const double encodeTime = timer.elapsed();
+
+    timer.restart();
+
+    for(const Layer::Ptr &layer : layers)
+        layer->expand();
+
+    const double decodeTime = timer.elapsed();
+
+    const double ratio = double(expandedBytes) / double(compressedBytes);
+
+    bench::report("compression", variant + " encode", encodeTime, bench::formatRate(double(expandedBytes), encodeTime));
+    bench::report("compression", variant + " decode", decodeTime, bench::formatRate(double(expandedBytes), decodeTime)
+                                                                    + "  ratio " + bench::formatRatio(ratio));
+}
+
+} // End of Anonymous Namespace
+
+/*
+ * Compression ratio and encode/decode throughput (of the expanded coordinates) of a hatch-dense build, on the
+ * grid of the layers' quantization and as arbitrary floats
+ */
+SLM_BENCHMARK(compression)
+{
+    const size_t numLayers = opts.scaled(200);
+
+    std::mt19937 rng(1);
+    std::vector<Layer::Ptr> layers;
+
+    for(size_t i = 0; i < numLayers; i++)
+        layers.push_back(makeHatchedLayer(i, 20, rng));
+
+    run("hatched (1 um grid)", layers);
+
+    // The same coordinates without the quantization of the layer are encoded via their bit patterns
+    for(const Layer::Ptr &layer : layers)
+        layer->setQuantization(Quantization());
+
+    run("hatched (float bits)", layers);
+
+    run("random hatches (float bits)", bench::makeBuild(numLayers, 500, 0, 40));
+}
@@ -0,0 +1,142 @@
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+#include <App/InputBuffer.h>
+#include <App/Reader.h>
+
+#include "Bench.h"
+
+using namespace slm;
+
+namespace
+{
+
+/*
+ * Reader of a file of layer records, each holding the number of geometries followed by the number of points and
+ * coordinates of each geometry. The layer offset table is provided separately, as translators read it from the
+ * file's header.
+ */
+class DecodeReader : public base::Reader
+{
+public:
+    DecodeReader(const std::string &path, const std::vector<LayerOffset> &entries) : base::Reader(path),
+                                                                                    mEntries(entries) {}
+
+    int parse() override
+    {
+        if(!openInput(MappedFile::WILLNEED))
+            return -1;
+
+        const int status = decodeLayers(mEntries);
+        closeInput();
+
+        return status;
+    }
+
+    double getLayerThickness() const override { return 30.0; }
+
+protected:
+    int readLayerGeometry(Layer &layer) override
+    {
+        ByteCursor cursor(input()->span(), layer.layerFilePosition());
+
+        uint32_t numGeoms = 0;
+
+        if(cursor.read(numGeoms) != 0)
+            return -1;
+
+        for(uint32_t i = 0; i < numGeoms; i++) {
+
+            uint32_t numPoints = 0;
+
+            if(cursor.read(numPoints) != 0)
+                return -1;
+
+            const ByteSpan coords = cursor.take(uint64_t(numPoints) * 2 * sizeof(float));
+
+            if(coords.size() != size_t(numPoints) * 2 * sizeof(float))
+                return -1;
+
+            HatchGeometry::Ptr hatch = layer.createGeometry<HatchGeometry>(1, 1, numPoints);
+            LayerGeometry::CoordsMap dst = hatch->mutableCoordinates();
+
+            for(uint32_t j = 0; j < numPoints; j++) {
+                dst(j, 0) = ByteSpan::decode<float>(coords.data() + (2 * j) * sizeof(float));
+                dst(j, 1) = ByteSpan::decode<float>(coords.data() + (2 * j + 1) * sizeof(float));
+            }
+
+            layer.addHatchGeometry(hatch);
+        }
+
+        return 0;
+    }
+
+private:
+    std::vector<base::Reader::LayerOffset> mEntries;
+};
+
+} // End of Anonymous Namespace
+
+/*
+ * Speedup of base::Reader::decodeLayers with the number of threads decoding a 1,000 layer file (~80 MB) from its
+ * layer offset table
+ */
+SLM_BENCHMARK(decodeThreads)
+{
+    const std::vector<Layer::Ptr> build = bench::makeBuild(opts.scaled(1000), 500, 50, 16);
+    const std::string path = opts.tempDir + "/slm_bench_decode.bin";
+
+    std::vector<base::Reader::LayerOffset> entries;
+
+    {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+
+        for(const Layer::Ptr &layer : build) {
+
+            entries.push_back(base::Reader::LayerOffset{uint64_t(file.tellp()), layer->getLayerId(), layer->getZ()});
+
+            const uint32_t numGeoms = uint32_t(layer->geometry().size());
+            file.write(reinterpret_cast<const char *>(&numGeoms), sizeof(numGeoms));
+
+            for(const LayerGeometry::Ptr &geom : layer->geometry()) {
+
+                const uint32_t numPoints = uint32_t(geom->coords.rows());
+                file.write(reinterpret_cast<const char *>(&numPoints), sizeof(numPoints));
+
+                for(Eigen::Index i = 0; i < geom->coords.rows(); i++) {
+                    const float pnt[2] = {geom->coords(i, 0), geom->coords(i, 1)};
+                    file.write(reinterpret_cast<const char *>(pnt), sizeof(pnt));
+                }
+            }
+        }
+
+        if(!file) {
+            std::cerr << "decodeThreads: cannot write '" << path << "'" << std::endl;
+            return;
+        }
+    }
+
+    double serial = 0.0;
+
+    for(unsigned int numThreads : opts.threadCounts()) {
+
+        DecodeReader reader(path, entries);
+        reader.setNumThreads(numThreads);
+
+        bench::Timer timer;
+        const int status = reader.parse();
+        const double elapsed = timer.elapsed();
+
+        if(numThreads == 1)
+            serial = elapsed;
+
+        const bool valid = status == 0 && reader.getLayers().size() == build.size() &&
+                           reader.getLayers().back()->getZ() == build.back()->getZ();
+
+        bench::report("decodeThreads", std::to_string(numThreads) + " threads", elapsed,
+                      valid ? bench::formatRatio(serial / elapsed) + " speedup" : "failed");
+    }
+
+    std::remove(path.c_str());
+}
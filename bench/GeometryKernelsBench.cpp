@@ -0,0 +1,124 @@
+#include <cmath>
+#include <limits>
+
+#include <App/GeometryKernels.h>
+
+#include "Bench.h"
+
+using namespace slm;
+
+namespace
+{
+
+// Scalar references, accumulating sequentially as the metrics were computed before the kernels
+
+double scalarHatchLength(const float *x, const float *y, size_t numPoints)
+{
+    double length = 0.0;
+
+    for(size_t i = 0; i + 1 < numPoints; i += 2)
+        length += std::sqrt(double(x[i + 1] - x[i]) * double(x[i + 1] - x[i]) +
+                            double(y[i + 1] - y[i]) * double(y[i + 1] - y[i]));
+
+    return length;
+}
+
+double scalarPolylineLength(const float *x, const float *y, size_t numPoints)
+{
+    double length = 0.0;
+
+    for(size_t i = 0; i + 1 < numPoints; i++)
+        length += std::sqrt(double(x[i + 1] - x[i]) * double(x[i + 1] - x[i]) +
+                            double(y[i + 1] - y[i]) * double(y[i + 1] - y[i]));
+
+    return length;
+}
+
+void scalarBoundingBox(const float *x, const float *y, size_t numPoints, float *bbox)
+{
+    bbox[0] = bbox[2] =  std::numeric_limits<float>::max();
+    bbox[1] = bbox[3] = -std::numeric_limits<float>::max();
+
+    for(size_t i = 0; i < numPoints; i++) {
+        bbox[0] = std::min(bbox[0], x[i]);
+        bbox[1] = std::max(bbox[1], x[i]);
+        bbox[2] = std::min(bbox[2], y[i]);
+        bbox[3] = std::max(bbox[3], y[i]);
+    }
+}
+
+} // End of Anonymous Namespace
+
+/*
+ * The geometry kernels against sequential scalar loops over 10M hatch vectors (20M points) held in contiguous
+ * x and y arrays. The relative difference between the kernels' and scalar lengths is reported as a note.
+ */
+SLM_BENCHMARK(geometryKernels)
+{
+    const size_t numPoints = 2 * opts.scaled(10000000);
+    const int numPasses = 5;
+
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> dist(-100.f, 100.f);
+
+    std::vector<float> x(numPoints), y(numPoints);
+
+    for(size_t i = 0; i < numPoints; i++) {
+        x[i] = dist(rng);
+        y[i] = dist(rng);
+    }
+
+    double scalar = 0.0, vectorized = 0.0;
+    bench::Timer timer;
+
+    for(int pass = 0; pass < numPasses; pass++)
+        scalar += scalarHatchLength(x.data(), y.data(), numPoints);
+
+    bench::report("geometryKernels", "hatch length (scalar)", timer.elapsed(), std::to_string(numPasses) + " passes");
+
+    timer.restart();
+
+    for(int pass = 0; pass < numPasses; pass++)
+        vectorized += kernels::hatchLength(x.data(), y.data(), numPoints);
+
+    bench::report("geometryKernels", "hatch length (kernel)", timer.elapsed(),
+                  "rel. diff " + std::to_string(std::fabs(vectorized - scalar) / scalar));
+
+    scalar = vectorized = 0.0;
+    timer.restart();
+
+    for(int pass = 0; pass < numPasses; pass++)
+        scalar += scalarPolylineLength(x.data(), y.data(), numPoints);
+
+    bench::report("geometryKernels", "polyline length (scalar)", timer.elapsed());
+
+    timer.restart();
+
+    for(int pass = 0; pass < numPasses; pass++)
+        vectorized += kernels::polylineLength(x.data(), y.data(), numPoints);
+
+    bench::report("geometryKernels", "polyline length (kernel)", timer.elapsed(),
+                  "rel. diff " + std::to_string(std::fabs(vectorized - scalar) / scalar));
+
+    float bbox[4];
+    double sum = 0.0;
+    timer.restart();
+
+    for(int pass = 0; pass < numPasses; pass++) {
+        scalarBoundingBox(x.data(), y.data(), numPoints, bbox);
+        sum += bbox[0];
+    }
+
+    bench::report("geometryKernels", "bounding box (scalar)", timer.elapsed());
+
+    timer.restart();
+
+    for(int pass = 0; pass < numPasses; pass++) {
+        kernels::boundingBox(x.data(), y.data(), numPoints, bbox);
+        sum += bbox[0];
+    }
+
+    bench::report("geometryKernels", "bounding box (kernel)", timer.elapsed());
+
+    bench::doNotOptimize(sum + scalar + vectorized);
+}
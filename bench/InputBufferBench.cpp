@@ -0,0 +1,111 @@
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+#include <App/InputBuffer.h>
+
+#include "Bench.h"
+
+using namespace slm;
+
+namespace
+{
+
+// Each record holds the number of points followed by their coordinates, as geometry is stored by the translators
+const uint32_t PointsPerRecord = 64;
+
+double scanStream(const std::string &path)
+{
+    std::ifstream file(path, std::ios::binary);
+
+    double sum = 0.0;
+    uint32_t numPoints = 0;
+
+    while(file.read(reinterpret_cast<char *>(&numPoints), sizeof(numPoints))) {
+        for(uint32_t i = 0; i < 2 * numPoints; i++) {
+            float val;
+            file.read(reinterpret_cast<char *>(&val), sizeof(val));
+            sum += val;
+        }
+    }
+
+    return sum;
+}
+
+double scanBuffer(const InputBuffer &buffer)
+{
+    ByteCursor cursor(buffer.span());
+
+    double sum = 0.0;
+    uint32_t numPoints = 0;
+
+    while(cursor.read(numPoints) == 0) {
+
+        const ByteSpan coords = cursor.take(uint64_t(2) * numPoints * sizeof(float));
+
+        for(uint32_t i = 0; i < 2 * numPoints && !coords.empty(); i++)
+            sum += ByteSpan::decode<float>(coords.data() + i * sizeof(float));
+    }
+
+    return sum;
+}
+
+} // End of Anonymous Namespace
+
+/*
+ * Sequential scan of an ~100 MB file of coordinate records (already within the page cache after writing) through a
+ * std::ifstream a value at a time, against decoding from an InputBuffer read into memory and memory mapped
+ */
+SLM_BENCHMARK(inputScan)
+{
+    const size_t numRecords = opts.scaled(200000);
+    const std::string path = opts.tempDir + "/slm_bench_input.bin";
+
+    {
+        std::mt19937 rng(1);
+        std::uniform_real_distribution<float> dist(0.f, 100.f);
+        std::vector<float> coords(2 * PointsPerRecord);
+
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+
+        for(size_t i = 0; i < numRecords; i++) {
+            for(float &val : coords)
+                val = dist(rng);
+
+            file.write(reinterpret_cast<const char *>(&PointsPerRecord), sizeof(PointsPerRecord));
+            file.write(reinterpret_cast<const char *>(coords.data()), coords.size() * sizeof(float));
+        }
+
+        if(!file) {
+            std::cerr << "inputScan: cannot write '" << path << "'" << std::endl;
+            return;
+        }
+    }
+
+    const double fileSize = double(numRecords) * (sizeof(uint32_t) + 2 * PointsPerRecord * sizeof(float));
+
+    bench::Timer timer;
+    const double expected = scanStream(path);
+    double elapsed = timer.elapsed();
+
+    bench::report("inputScan", "std::ifstream", elapsed, bench::formatRate(fileSize, elapsed));
+
+    for(int mapped = 0; mapped < 2; mapped++) {
+
+        timer.restart();
+
+        InputBuffer buffer;
+        double sum = 0.0;
+
+        if(buffer.open(path, MappedFile::SEQUENTIAL, mapped != 0) == 0)
+            sum = scanBuffer(buffer);
+
+        buffer.close();
+        elapsed = timer.elapsed();
+
+        bench::report("inputScan", mapped ? "InputBuffer (mapped)" : "InputBuffer (read)", elapsed,
+                      sum == expected ? bench::formatRate(fileSize, elapsed) : "mismatch");
+    }
+
+    std::remove(path.c_str());
+}
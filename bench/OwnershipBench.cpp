@@ -0,0 +1,112 @@
+#include <App/Reader.h>
+
+#include "Bench.h"
+
+using namespace slm;
+
+namespace
+{
+
+// Reader holding a prebuilt build, for measuring the transfer of its layers
+class BuildReader : public base::Reader
+{
+public:
+    explicit BuildReader(std::vector<Layer::Ptr> build) : mBuild(std::move(build)) {}
+
+    int parse() override
+    {
+        layers = std::move(mBuild);
+        setReady(true);
+        return 0;
+    }
+
+    double getLayerThickness() const override { return 30.0; }
+
+private:
+    std::vector<Layer::Ptr> mBuild;
+};
+
+} // End of Anonymous Namespace
+
+/*
+ * Reference count traffic and copying on a 1M geometry build: traversal by value (a shared_ptr copy per element)
+ * against traversal by reference, copying against moving the geometry into a layer, and copying the layers out of
+ * a reader against base::Reader::takeLayers
+ */
+SLM_BENCHMARK(ownership)
+{
+    const size_t numLayers = opts.scaled(1000);
+    const size_t numGeoms = 1000;
+    const size_t numElements = numLayers * numGeoms;
+    const std::string note = std::to_string(numElements) + " shared_ptr copies";
+
+    std::vector<Layer::Ptr> layers;
+
+    for(size_t i = 0; i < numLayers; i++) {
+        Layer::Ptr layer = std::make_shared<Layer>(i, i * 30);
+
+        for(size_t j = 0; j < numGeoms; j++)
+            layer->emplaceGeometry<HatchGeometry>(1, uint32_t(j % 4));
+
+        layers.push_back(layer);
+    }
+
+    double sum = 0.0;
+    bench::Timer timer;
+
+    for(const Layer::Ptr &layer : layers) {
+        for(LayerGeometry::Ptr geom : layer->geometry())
+            sum += geom->bid;
+    }
+
+    bench::report("ownership", "traverse by value", timer.elapsed(), note);
+
+    timer.restart();
+
+    for(const Layer::Ptr &layer : layers) {
+        for(const LayerGeometry::Ptr &geom : layer->geometry())
+            sum += geom->bid;
+    }
+
+    bench::report("ownership", "traverse by reference", timer.elapsed(), "none");
+
+    // Replacement geometry for every layer is prepared beforehand, so that only the transfer is measured
+    std::vector<std::vector<LayerGeometry::Ptr> > replacements;
+
+    for(const Layer::Ptr &layer : layers)
+        replacements.push_back(layer->geometry());
+
+    timer.restart();
+
+    for(size_t i = 0; i < layers.size(); i++) {
+        layers[i]->setGeometry(replacements[i]);
+        std::vector<LayerGeometry::Ptr>().swap(replacements[i]);  // The caller's copy is released
+    }
+
+    bench::report("ownership", "setGeometry (copy)", timer.elapsed(), note);
+
+    for(const Layer::Ptr &layer : layers)
+        replacements.push_back(layer->geometry());
+
+    timer.restart();
+
+    for(size_t i = 0; i < layers.size(); i++)
+        layers[i]->setGeometry(std::move(replacements[numLayers + i]));
+
+    bench::report("ownership", "setGeometry (move)", timer.elapsed(), "none");
+
+    BuildReader reader(std::move(layers));
+    reader.parse();
+
+    timer.restart();
+    std::vector<Layer::Ptr> copied = reader.getLayers();
+    bench::report("ownership", "getLayers (copy)", timer.elapsed(), std::to_string(numLayers) + " shared_ptr copies");
+
+    copied.clear();
+
+    timer.restart();
+    std::vector<Layer::Ptr> taken = reader.takeLayers();
+    bench::report("ownership", "takeLayers (move)", timer.elapsed(), "none");
+
+    bench::doNotOptimize(sum + double(taken.size()));
+}
@@ -0,0 +1,87 @@
+#include "Bench.h"
+
+using namespace slm;
+
+namespace
+{
+
+// Ordering previously performed by Layer::getGeometry(ScanMode) upon every call
+std::vector<LayerGeometry::Ptr> orderPerCall(const Layer &layer, ScanMode mode)
+{
+    std::vector<LayerGeometry::Ptr> hatch;
+    std::vector<LayerGeometry::Ptr> contour;
+    std::vector<LayerGeometry::Ptr> points;
+
+    for(const LayerGeometry::Ptr &geom : layer.geometry()) {
+        if(geom->getType() == LayerGeometry::PNTS)
+            points.push_back(geom);
+        else if(geom->getType() == LayerGeometry::POLYGON)
+            contour.push_back(geom);
+        else if(geom->getType() == LayerGeometry::HATCH)
+            hatch.push_back(geom);
+    }
+
+    std::vector<LayerGeometry::Ptr> list;
+
+    if(mode == HATCH_FIRST) {
+        list.insert(list.end(), hatch.begin(), hatch.end());
+        list.insert(list.end(), contour.begin(), contour.end());
+    } else {
+        list.insert(list.end(), contour.begin(), contour.end());
+        list.insert(list.end(), hatch.begin(), hatch.end());
+    }
+
+    list.insert(list.end(), points.begin(), points.end());
+
+    return list;
+}
+
+} // End of Anonymous Namespace
+
+/*
+ * Repeated HATCH_FIRST traversals of a 1,000 layer build, using the temporary vectors built per call previously,
+ * Layer::getGeometry (a copy of the cached ordering) and the non-allocating Layer::orderedGeometry view
+ */
+SLM_BENCHMARK(scanOrder)
+{
+    const size_t numLayers = opts.scaled(1000);
+    const int numPasses = 10;
+
+    const std::vector<Layer::Ptr> layers = bench::makeBuild(numLayers, 200, 50, 4);
+
+    double sum = 0.0;
+    bench::Timer timer;
+
+    for(int pass = 0; pass < numPasses; pass++) {
+        for(const Layer::Ptr &layer : layers) {
+            for(const LayerGeometry::Ptr &geom : orderPerCall(*layer, HATCH_FIRST))
+                sum += geom->bid;
+        }
+    }
+
+    bench::report("scanOrder", "per call ordering (previous)", timer.elapsed(), std::to_string(numPasses) + " passes");
+
+    timer.restart();
+
+    for(int pass = 0; pass < numPasses; pass++) {
+        for(const Layer::Ptr &layer : layers) {
+            for(const LayerGeometry::Ptr &geom : layer->getGeometry(HATCH_FIRST))
+                sum += geom->bid;
+        }
+    }
+
+    bench::report("scanOrder", "getGeometry (cached copy)", timer.elapsed());
+
+    timer.restart();
+
+    for(int pass = 0; pass < numPasses; pass++) {
+        for(const Layer::Ptr &layer : layers) {
+            for(const LayerGeometry::Ptr &geom : layer->orderedGeometry(HATCH_FIRST))
+                sum += geom->bid;
+        }
+    }
+
+    bench::report("scanOrder", "orderedGeometry (view)", timer.elapsed());
+
+    bench::doNotOptimize(sum);
+}
@@ -0,0 +1,95 @@
+#include <App/SpatialIndex.h>
+
+#include "Bench.h"
+
+using namespace slm;
+
+namespace
+{
+
+// Linear walk over the layer's geometry, as required without the index
+size_t linearQuery(const Layer &layer, float minX, float minY, float maxX, float maxY)
+{
+    size_t num = 0;
+    Eigen::MatrixXf scratch;
+
+    for(const LayerGeometry::Ptr &geom : layer.geometry()) {
+
+        const LayerGeometry::ConstCoordsMap coords = geom->resolve(scratch);
+
+        for(Eigen::Index j = 0; j + 1 < coords.rows(); j += 2) {
+            if(std::min(coords(j, 0), coords(j + 1, 0)) <= maxX && std::max(coords(j, 0), coords(j + 1, 0)) >= minX &&
+               std::min(coords(j, 1), coords(j + 1, 1)) <= maxY && std::max(coords(j, 1), coords(j + 1, 1)) >= minY) {
+                num++;
+                break;
+            }
+        }
+    }
+
+    return num;
+}
+
+} // End of Anonymous Namespace
+
+/*
+ * Build time of the spatial indices of a build (serially and across threads), and the latency of window queries
+ * of several sizes against a linear walk over the layer's geometry
+ */
+SLM_BENCHMARK(spatialIndex)
+{
+    const size_t numLayers = opts.scaled(100);
+    const std::vector<Layer::Ptr> layers = bench::makeBuild(numLayers, 2000, 100, 20);
+
+    bench::Timer timer;
+    buildSpatialIndices(layers, 1);
+    bench::report("spatialIndex", "build (1 thread)", timer.elapsed(), std::to_string(numLayers) + " layers");
+
+    for(const Layer::Ptr &layer : layers)
+        layer->markModified();
+
+    timer.restart();
+    buildSpatialIndices(layers, opts.maxThreads);
+    bench::report("spatialIndex", "build (all threads)", timer.elapsed());
+
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> pos(0.f, 100.f);
+
+    const int numQueries = 1000;
+    const float sizes[] = {1.f, 10.f, 50.f};
+
+    for(float size : sizes) {
+
+        std::vector<float> windows;
+
+        for(int i = 0; i < numQueries; i++) {
+            windows.push_back(pos(rng));
+            windows.push_back(pos(rng));
+        }
+
+        const std::string window = std::to_string(int(size)) + " mm window";
+        size_t num = 0;
+
+        timer.restart();
+
+        for(int i = 0; i < numQueries; i++) {
+            const Layer &layer = *layers[size_t(i) % layers.size()];
+            num += layer.queryGeometry(windows[2 * i], windows[2 * i + 1], windows[2 * i] + size, windows[2 * i + 1] + size).size();
+        }
+
+        const double indexTime = timer.elapsed();
+
+        timer.restart();
+
+        for(int i = 0; i < numQueries; i++) {
+            const Layer &layer = *layers[size_t(i) % layers.size()];
+            num += linearQuery(layer, windows[2 * i], windows[2 * i + 1], windows[2 * i] + size, windows[2 * i + 1] + size);
+        }
+
+        const double linearTime = timer.elapsed();
+
+        bench::report("spatialIndex", "query " + window + " (per query)", indexTime / numQueries);
+        bench::report("spatialIndex", "linear " + window + " (per query)", linearTime / numQueries);
+
+        bench::doNotOptimize(double(num));
+    }
+}
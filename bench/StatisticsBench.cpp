@@ -0,0 +1,63 @@
+#include <App/BuildStatistics.h>
+
+#include "Bench.h"
+
+using namespace slm;
+
+namespace
+{
+
+uint64_t coordinateBytes(const std::vector<Layer::Ptr> &layers)
+{
+    uint64_t bytes = 0;
+
+    for(const Layer::Ptr &layer : layers) {
+        for(const LayerGeometry::Ptr &geom : layer->geometry())
+            bytes += uint64_t(geom->coords.size()) * sizeof(float);
+    }
+
+    return bytes;
+}
+
+} // End of Anonymous Namespace
+
+/*
+ * Computing the statistics of a 1,000 layer build (~80 MB of coordinates) with the number of threads, reported as
+ * the rate over the coordinates. The target of under a second for a 5 GB build requires ~5 GB/s, which may be
+ * checked directly with --scale 64. Each pass is over a newly generated build, as the metrics are cached within
+ * the layers, followed by a repeated pass over the cached metrics.
+ */
+SLM_BENCHMARK(buildStatistics)
+{
+    const std::vector<Layer::Ptr> build = bench::makeBuild(opts.scaled(1000), 500, 50, 16);
+    const double bytes = double(coordinateBytes(build));
+
+    double serial = 0.0;
+
+    for(unsigned int numThreads : opts.threadCounts()) {
+
+        // The geometry's metrics are cached too, hence the build is generated again
+        const std::vector<Layer::Ptr> layers = bench::makeBuild(build.size(), 500, 50, 16);
+
+        bench::Timer timer;
+        BuildStatistics stats = BuildStatistics::compute(layers, numThreads);
+        double elapsed = timer.elapsed();
+
+        if(numThreads == 1)
+            serial = elapsed;
+
+        bench::doNotOptimize(stats.pathLength);
+        bench::report("buildStatistics", std::to_string(numThreads) + " threads", elapsed,
+                      bench::formatRate(bytes, elapsed) + ", " + bench::formatRatio(serial / elapsed) + " speedup");
+
+        if(numThreads != opts.threadCounts().back())
+            continue;
+
+        timer.restart();
+        stats = BuildStatistics::compute(layers, numThreads);
+        elapsed = timer.elapsed();
+
+        bench::doNotOptimize(stats.pathLength);
+        bench::report("buildStatistics", "cached metrics", elapsed);
+    }
+}
@@ -0,0 +1,235 @@
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#include <App/Writer.h>
+
+#include "Bench.h"
+
+using namespace slm;
+
+namespace
+{
+
+/*
+ * Writer of a simple binary format: for each layer its id, Z and number of geometries, followed by the type,
+ * model id, build style id, number of points and coordinates of each geometry
+ */
+class BenchWriter : public base::Writer
+{
+public:
+    explicit BenchWriter(const std::string &path) : base::Writer(path), mSizing(false) {}
+
+    void setLayerSizing(bool state) { mSizing = state; }
+
+    // Writes the build through a std::ofstream, a value at a time, as the translators' writers do
+    static int writeFstream(const std::string &path, const std::vector<Layer::Ptr> &layers)
+    {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+
+        if(!file.is_open())
+            return -1;
+
+        for(const Layer::Ptr &layer : layers) {
+
+            const uint64_t id = layer->getLayerId();
+            const uint64_t z = layer->getZ();
+            const uint32_t numGeoms = uint32_t(layer->geometry().size());
+
+            file.write(reinterpret_cast<const char *>(&id), sizeof(id));
+            file.write(reinterpret_cast<const char *>(&z), sizeof(z));
+            file.write(reinterpret_cast<const char *>(&numGeoms), sizeof(numGeoms));
+
+            for(const LayerGeometry::Ptr &geom : layer->geometry()) {
+
+                const uint8_t type = uint8_t(geom->getType());
+                const uint32_t numPoints = uint32_t(geom->coords.rows());
+
+                file.write(reinterpret_cast<const char *>(&type), sizeof(type));
+                file.write(reinterpret_cast<const char *>(&geom->mid), sizeof(geom->mid));
+                file.write(reinterpret_cast<const char *>(&geom->bid), sizeof(geom->bid));
+                file.write(reinterpret_cast<const char *>(&numPoints), sizeof(numPoints));
+
+                for(Eigen::Index i = 0; i < geom->coords.rows(); i++) {
+                    const float pnt[2] = {geom->coords(i, 0), geom->coords(i, 1)};
+                    file.write(reinterpret_cast<const char *>(pnt), sizeof(pnt));
+                }
+            }
+        }
+
+        file.close();
+
+        return file.fail() ? -1 : 0;
+    }
+
+protected:
+    bool supportsLayerEncoding() const override { return true; }
+    bool supportsLayerSizing() const override { return mSizing; }
+
+    int writeHeader(const Header &, const std::vector<Model::Ptr> &) override
+    {
+        return openOutputSink() ? 0 : -1;
+    }
+
+    int encodeLayer(const Layer &layer, std::vector<uint8_t> &buffer) const override
+    {
+        buffer.resize(size_t(layerEncodedSize(layer)));
+        return encodeLayerInto(layer, buffer.data(), buffer.size());
+    }
+
+    int64_t layerEncodedSize(const Layer &layer) const override
+    {
+        int64_t size = 2 * sizeof(uint64_t) + sizeof(uint32_t);
+
+        for(const LayerGeometry::Ptr &geom : layer.geometry())
+            size += sizeof(uint8_t) + 3 * sizeof(uint32_t) + 2 * sizeof(float) * geom->coords.rows();
+
+        return size;
+    }
+
+    int encodeLayerInto(const Layer &layer, uint8_t *dst, size_t size) const override
+    {
+        uint8_t *ptr = dst;
+
+        auto put = [&ptr](const void *data, size_t n) {
+            std::memcpy(ptr, data, n);
+            ptr += n;
+        };
+
+        const uint64_t id = layer.getLayerId();
+        const uint64_t z = layer.getZ();
+        const uint32_t numGeoms = uint32_t(layer.geometry().size());
+
+        put(&id, sizeof(id));
+        put(&z, sizeof(z));
+        put(&numGeoms, sizeof(numGeoms));
+
+        for(const LayerGeometry::Ptr &geom : layer.geometry()) {
+
+            const uint8_t type = uint8_t(geom->getType());
+            const uint32_t numPoints = uint32_t(geom->coords.rows());
+
+            put(&type, sizeof(type));
+            put(&geom->mid, sizeof(geom->mid));
+            put(&geom->bid, sizeof(geom->bid));
+            put(&numPoints, sizeof(numPoints));
+
+            for(Eigen::Index i = 0; i < geom->coords.rows(); i++) {
+                const float pnt[2] = {geom->coords(i, 0), geom->coords(i, 1)};
+                put(pnt, sizeof(pnt));
+            }
+        }
+
+        return size_t(ptr - dst) == size ? 0 : -1;
+    }
+
+private:
+    bool mSizing;
+};
+
+} // End of Anonymous Namespace
+
+/*
+ * Writing a 1,000 layer build (~80 MB) through a std::ofstream a value at a time, against base::Writer encoding
+ * each layer into a buffer and appending it to the asynchronous double-buffered OutputSink (on a single thread)
+ */
+SLM_BENCHMARK(outputSink)
+{
+    const std::vector<Layer::Ptr> layers = bench::makeBuild(opts.scaled(1000), 500, 50, 16);
+    const std::string path = opts.tempDir + "/slm_bench_writer.bin";
+
+    bench::Timer timer;
+
+    if(BenchWriter::writeFstream(path, layers) != 0) {
+        std::cerr << "outputSink: cannot write '" << path << "'" << std::endl;
+        return;
+    }
+
+    double elapsed = timer.elapsed();
+    const double fileSize = double(std::ifstream(path, std::ios::binary | std::ios::ate).tellg());
+
+    bench::report("outputSink", "std::ofstream", elapsed, bench::formatRate(fileSize, elapsed));
+
+    BenchWriter writer(path);
+    writer.setNumThreads(1);
+
+    timer.restart();
+    writer.write(Header(), std::vector<Model::Ptr>(), layers);
+    elapsed = timer.elapsed();
+
+    bench::report("outputSink", "OutputSink", elapsed,
+                  writer.writeStatus() == 0 ? bench::formatRate(fileSize, elapsed) : "failed");
+
+    std::remove(path.c_str());
+}
+
+/*
+ * Speedup of base::Writer::writeLayers with the number of threads encoding the layers in parallel, writing the
+ * encoded layers in order via the OutputSink
+ */
+SLM_BENCHMARK(writerThreads)
+{
+    const std::vector<Layer::Ptr> layers = bench::makeBuild(opts.scaled(1000), 500, 50, 16);
+    const std::string path = opts.tempDir + "/slm_bench_writer.bin";
+
+    double serial = 0.0;
+
+    for(unsigned int numThreads : opts.threadCounts()) {
+
+        BenchWriter writer(path);
+        writer.setNumThreads(numThreads);
+
+        bench::Timer timer;
+        writer.write(Header(), std::vector<Model::Ptr>(), layers);
+        const double elapsed = timer.elapsed();
+
+        if(numThreads == 1)
+            serial = elapsed;
+
+        bench::report("writerThreads", std::to_string(numThreads) + " threads", elapsed,
+                      writer.writeStatus() == 0 ? bench::formatRatio(serial / elapsed) + " speedup" : "failed");
+    }
+
+    std::remove(path.c_str());
+}
+
+/*
+ * Writing a 1,000 layer build through a std::ofstream, against base::Writer with the encoded layers appended to the
+ * OutputSink, and encoded directly into a memory mapped region of the file sized up front (including the msync
+ * upon closing the mapping)
+ */
+SLM_BENCHMARK(mappedOutput)
+{
+    const std::vector<Layer::Ptr> layers = bench::makeBuild(opts.scaled(1000), 500, 50, 16);
+    const std::string path = opts.tempDir + "/slm_bench_writer.bin";
+
+    bench::Timer timer;
+
+    if(BenchWriter::writeFstream(path, layers) != 0) {
+        std::cerr << "mappedOutput: cannot write '" << path << "'" << std::endl;
+        return;
+    }
+
+    double elapsed = timer.elapsed();
+    const double fileSize = double(std::ifstream(path, std::ios::binary | std::ios::ate).tellg());
+
+    bench::report("mappedOutput", "std::ofstream", elapsed, bench::formatRate(fileSize, elapsed));
+
+    for(int mapped = 0; mapped < 2; mapped++) {
+
+        BenchWriter writer(path);
+        writer.setNumThreads(opts.maxThreads);
+        writer.setMappedOutput(mapped != 0);
+        writer.setLayerSizing(mapped != 0);
+
+        timer.restart();
+        writer.write(Header(), std::vector<Model::Ptr>(), layers);
+        elapsed = timer.elapsed();
+
+        bench::report("mappedOutput", mapped ? "Writer (mapped)" : "Writer (OutputSink)", elapsed,
+                      writer.writeStatus() == 0 ? bench::formatRate(fileSize, elapsed) : "failed");
+    }
+
+    std::remove(path.c_str());
+}
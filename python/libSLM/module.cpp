@@ -11,10 +11,19 @@
 
 #include <tuple>
 
+#include <App/BuildEstimator.h>
+#include <App/BuildStatistics.h>
+#include <App/BuildStyleResolver.h>
+#include <App/GeometryKernels.h>
 #include <App/Header.h>
+#include <App/Instancing.h>
 #include <App/Layer.h>
+#include <App/LayerCache.h>
+#include <App/LayerIndex.h>
 #include <App/Model.h>
 #include <App/Reader.h>
+#include <App/ScanOptimizer.h>
+#include <App/SpatialIndex.h>
 #include <App/Writer.h>
 
 #include "utils.h"
@@ -75,7 +84,7 @@ PYBIND11_MODULE(slm, m) {
         void write(const Header &header,
                    const std::vector<Model::Ptr> &models,
                    const std::vector<Layer::Ptr> &layers) override {
-            PYBIND11_OVERRIDE_PURE(
+            PYBIND11_OVERRIDE(
                 void, /* Return type */
                 Writer,      /* Parent class */
                 write,       /* Name of function in C++ (must match Python name) */
@@ -83,6 +92,18 @@ PYBIND11_MODULE(slm, m) {
             );
         }
 
+        int writeHeader(const Header &header, const std::vector<Model::Ptr> &models) override {
+            PYBIND11_OVERRIDE(int, Writer, writeHeader, header, models);
+        }
+
+        int writeLayerData(const Layer &layer) override {
+            PYBIND11_OVERRIDE(int, Writer, writeLayerData, layer);
+        }
+
+        int writeFooter() override {
+            PYBIND11_OVERRIDE(int, Writer, writeFooter);
+        }
+
     };
 
     py::class_<slm::base::Reader, PyReader>(m, "Reader")
@@ -93,6 +114,16 @@ PYBIND11_MODULE(slm, m) {
         .def("getFileSize", &slm::base::Reader::getFileSize)
         .def("getLayerThickness", &slm::base::Reader::getLayerThickness)
         .def("getModelById", &slm::base::Reader::getModelById, py::arg("mid"))
+        .def("getLayerByZ", &slm::base::Reader::getLayerByZ, py::arg("z"))
+        .def("getLayerById", &slm::base::Reader::getLayerById, py::arg("id"))
+        .def("getLayersByZRange", &slm::base::Reader::getLayersByZRange, py::arg("zMin"), py::arg("zMax"))
+        .def_property("arenaAllocation", &slm::base::Reader::isArenaAllocation, &slm::base::Reader::setArenaAllocation)
+        .def_property("memoryMapped", &slm::base::Reader::isMemoryMapped, &slm::base::Reader::setMemoryMapped)
+        .def_property("lazyLoading", &slm::base::Reader::isLazyLoading, &slm::base::Reader::setLazyLoading)
+        .def_property("numThreads", &slm::base::Reader::numThreads, &slm::base::Reader::setNumThreads)
+        .def_property("layerCache", &slm::base::Reader::layerCache, &slm::base::Reader::setLayerCache)
+        .def("loadLayer", &slm::base::Reader::loadLayer, py::arg("id"))
+        .def("unloadLayer", &slm::base::Reader::unloadLayer, py::arg("id"))
         .def_property_readonly("layers", &slm::base::Reader::getLayers)
         .def_property_readonly("models", &slm::base::Reader::getModels);
 
@@ -105,8 +136,22 @@ PYBIND11_MODULE(slm, m) {
         .def("getTotalNumHatches", &slm::base::Writer::getTotalNumHatches)
         .def("getTotalNumContours", &slm::base::Writer::getTotalNumContours)
         .def("getBoundingBox", &slm::base::Writer::getBoundingBox)
+        .def_static("isSortedByZ", &slm::base::Writer::isSortedByZ, py::arg("layers"))
+        .def_static("sortPermutation", &slm::base::Writer::sortPermutation, py::arg("layers"))
         .def_property("sortLayers", &slm::base::Writer::isSortingLayers, &slm::base::Writer::setSortLayers)
-        .def("write", &slm::base::Writer::write, py::arg("header"), py::arg("models"), py::arg("layers"));
+        .def("write", &slm::base::Writer::write, py::arg("header"), py::arg("models"), py::arg("layers"))
+        .def_property_readonly("writeStatus", &slm::base::Writer::writeStatus)
+        .def("begin", &slm::base::Writer::begin, py::arg("header"), py::arg("models"))
+        .def("writeLayer", &slm::base::Writer::writeLayer, py::arg("layer"))
+        .def("finish", &slm::base::Writer::finish)
+        .def_property_readonly("isStreaming", &slm::base::Writer::isStreaming)
+        .def_property_readonly("numLayersWritten", &slm::base::Writer::numLayersWritten)
+        .def_property("directIO", &slm::base::Writer::isDirectIO, &slm::base::Writer::setDirectIO)
+        .def_property("outputBufferSize", &slm::base::Writer::outputBufferSize, &slm::base::Writer::setOutputBufferSize)
+        .def_property("mappedOutput", &slm::base::Writer::isMappedOutput, &slm::base::Writer::setMappedOutput)
+        .def_property("numThreads", &slm::base::Writer::numThreads, &slm::base::Writer::setNumThreads)
+        .def("writeLayers", &slm::base::Writer::writeLayers, py::arg("layers"))
+        .def_property_readonly("layerOffsets", &slm::base::Writer::layerOffsets);
 
 #endif
 
@@ -122,12 +167,48 @@ PYBIND11_MODULE(slm, m) {
         .value("HatchFirst", ScanMode::HATCH_FIRST)
         .export_values();
 
+    py::class_<slm::GeometryMetrics>(m, "GeometryMetrics")
+        .def_property_readonly("boundingBox", [](const GeometryMetrics &gm) { return std::make_tuple(gm.bbox[0], gm.bbox[1], gm.bbox[2], gm.bbox[3]); })
+        .def_readonly("pathLength",  &GeometryMetrics::pathLength)
+        .def_readonly("jumpLength",  &GeometryMetrics::jumpLength)
+        .def_readonly("numSegments", &GeometryMetrics::numSegments)
+        .def_readonly("numPoints",   &GeometryMetrics::numPoints);
+
+    py::class_<slm::LayerMetrics>(m, "LayerMetrics")
+        .def_property_readonly("boundingBox", [](const LayerMetrics &lm) { return std::make_tuple(lm.bbox[0], lm.bbox[1], lm.bbox[2], lm.bbox[3]); })
+        .def_readonly("pathLength",      &LayerMetrics::pathLength)
+        .def_readonly("jumpLength",      &LayerMetrics::jumpLength)
+        .def_readonly("numSegments",     &LayerMetrics::numSegments)
+        .def_readonly("numPoints",       &LayerMetrics::numPoints)
+        .def_readonly("numHatchGeoms",   &LayerMetrics::numHatchGeoms)
+        .def_readonly("numContourGeoms", &LayerMetrics::numContourGeoms)
+        .def_readonly("numPntsGeoms",    &LayerMetrics::numPntsGeoms);
+
     py::class_<slm::LayerGeometry, std::shared_ptr<slm::LayerGeometry>> layerGeomPyType(m, "LayerGeometry", py::dynamic_attr());
 
     layerGeomPyType.def(py::init())
         .def_readwrite("bid", &LayerGeometry::bid)
         .def_readwrite("mid", &LayerGeometry::mid)
-        .def_readwrite("coords", &LayerGeometry::coords)
+        .def_property("coords", [](py::object self) -> py::object {
+                                    LayerGeometry &g = self.cast<LayerGeometry &>();
+                                    // Quantized and instanced geometry is returned as a resolved copy
+                                    if(g.isQuantized() || g.isInstanced())
+                                        return py::cast(g.floatCoords());
+
+                                    return py::cast(g.mutableCoordinates(), py::return_value_policy::reference_internal, self);
+                                },
+                                &LayerGeometry::setCoords)
+        .def_property_readonly("isQuantized", &LayerGeometry::isQuantized)
+        .def_property_readonly("quantization", &LayerGeometry::quantization)
+        .def("quantize", &LayerGeometry::quantize, py::arg("quantization"))
+        .def("dequantize", &LayerGeometry::dequantize)
+        .def_property_readonly("isInstanced", &LayerGeometry::isInstanced)
+        .def_property_readonly("translation", &LayerGeometry::translation)
+        .def_property_readonly("rotation", &LayerGeometry::rotation)
+        .def_property_readonly("isView", &LayerGeometry::isView)
+        .def("detach", &LayerGeometry::detach)
+        .def_property_readonly("metrics", [](const LayerGeometry &g) { return g.metrics(); })
+        .def("invalidateMetrics", &LayerGeometry::invalidateMetrics)
         .def_property("type", &LayerGeometry::getType, nullptr)
         .def(py::pickle(
                 [](py::object self) { // __getstate__
@@ -250,12 +331,127 @@ PYBIND11_MODULE(slm, m) {
 #endif
 
 
+    py::class_<slm::InstancingResult>(m, "InstancingResult")
+        .def_readonly("numCandidates", &InstancingResult::numCandidates)
+        .def_readonly("numInstanced",  &InstancingResult::numInstanced)
+        .def_readonly("numPayloads",   &InstancingResult::numPayloads)
+        .def_readonly("bytesSaved",    &InstancingResult::bytesSaved);
+
+    py::class_<slm::LayerStatistics>(m, "LayerStatistics")
+        .def_readonly("layerId", &LayerStatistics::layerId)
+        .def_readonly("z",       &LayerStatistics::z)
+        .def_readonly("metrics", &LayerStatistics::metrics);
+
+    py::class_<slm::BuildStatistics>(m, "BuildStatistics")
+        .def_static("compute", &BuildStatistics::compute, py::arg("layers"), py::arg("numThreads") = 0, py::arg("perLayer") = true,
+                    "Computes the statistics of the build in a single parallel pass over the layers")
+        .def_readonly("numLayers",       &BuildStatistics::numLayers)
+        .def_readonly("numHatchGeoms",   &BuildStatistics::numHatchGeoms)
+        .def_readonly("numContourGeoms", &BuildStatistics::numContourGeoms)
+        .def_readonly("numPntsGeoms",    &BuildStatistics::numPntsGeoms)
+        .def_readonly("numPoints",       &BuildStatistics::numPoints)
+        .def_readonly("numSegments",     &BuildStatistics::numSegments)
+        .def_readonly("pathLength",      &BuildStatistics::pathLength)
+        .def_readonly("jumpLength",      &BuildStatistics::jumpLength)
+        .def_property_readonly("boundingBox", [](const BuildStatistics &s) { return std::make_tuple(s.bbox[0], s.bbox[1], s.bbox[2], s.bbox[3]); })
+        .def_readonly("zMin",            &BuildStatistics::zMin)
+        .def_readonly("zMax",            &BuildStatistics::zMax)
+        .def_readonly("layers",          &BuildStatistics::layers);
+
+    py::class_<slm::LayerEstimate>(m, "LayerEstimate")
+        .def_readonly("layerId",       &LayerEstimate::layerId)
+        .def_readonly("z",             &LayerEstimate::z)
+        .def_readonly("scanTime",      &LayerEstimate::scanTime)
+        .def_readonly("jumpTime",      &LayerEstimate::jumpTime)
+        .def_readonly("pointTime",     &LayerEstimate::pointTime)
+        .def_readonly("recoatTime",    &LayerEstimate::recoatTime)
+        .def_readonly("energy",        &LayerEstimate::energy)
+        .def_readonly("numUnresolved", &LayerEstimate::numUnresolved)
+        .def_property_readonly("totalTime", &LayerEstimate::totalTime);
+
+    py::class_<slm::BuildEstimate>(m, "BuildEstimate")
+        .def_readonly("scanTime",      &BuildEstimate::scanTime)
+        .def_readonly("jumpTime",      &BuildEstimate::jumpTime)
+        .def_readonly("pointTime",     &BuildEstimate::pointTime)
+        .def_readonly("recoatTime",    &BuildEstimate::recoatTime)
+        .def_readonly("energy",        &BuildEstimate::energy)
+        .def_readonly("numUnresolved", &BuildEstimate::numUnresolved)
+        .def_readonly("layers",        &BuildEstimate::layers)
+        .def_property_readonly("totalTime", &BuildEstimate::totalTime);
+
+    py::class_<slm::BuildEstimator>(m, "BuildEstimator")
+        .def(py::init())
+        .def("estimate", &BuildEstimator::estimate, py::arg("layers"), py::arg("models"), py::arg("perLayer") = true,
+             "Estimates the build time and energy of the layers in parallel")
+        .def("estimateLayer", &BuildEstimator::estimateLayer, py::arg("layer"), py::arg("resolver"))
+        .def_property("layerAdditionTime", &BuildEstimator::layerAdditionTime, &BuildEstimator::setLayerAdditionTime)
+        .def_property("layerCoolingTime",  &BuildEstimator::layerCoolingTime,  &BuildEstimator::setLayerCoolingTime)
+        .def_property("numThreads",        &BuildEstimator::numThreads,        &BuildEstimator::setNumThreads);
+
+    py::class_<slm::ScanOptimizerResult>(m, "ScanOptimizerResult")
+        .def_readonly("layerId",          &ScanOptimizerResult::layerId)
+        .def_readonly("jumpLengthBefore", &ScanOptimizerResult::jumpLengthBefore)
+        .def_readonly("jumpLengthAfter",  &ScanOptimizerResult::jumpLengthAfter)
+        .def_readonly("numReversed",      &ScanOptimizerResult::numReversed);
+
+    py::class_<slm::ScanOptimizer>(m, "ScanOptimizer")
+        .def(py::init())
+        .def("optimize", static_cast<ScanOptimizerResult (ScanOptimizer::*)(Layer &) const>(&ScanOptimizer::optimize), py::arg("layer"),
+             "Reorders the geometry of the layer to reduce the jumps between geometries")
+        .def("optimize", static_cast<std::vector<ScanOptimizerResult> (ScanOptimizer::*)(const std::vector<Layer::Ptr> &) const>(&ScanOptimizer::optimize), py::arg("layers"),
+             "Reorders the geometry of each layer in parallel")
+        .def_property("scanMode",            &ScanOptimizer::scanMode,              &ScanOptimizer::setScanMode)
+        .def_property("reversing",           &ScanOptimizer::isReversing,           &ScanOptimizer::setReversing)
+        .def_property("hatchVectorFlipping", &ScanOptimizer::isHatchVectorFlipping, &ScanOptimizer::setHatchVectorFlipping)
+        .def_property("twoOpt",              &ScanOptimizer::isTwoOpt,              &ScanOptimizer::setTwoOpt)
+        .def_property("twoOptWindow",        &ScanOptimizer::twoOptWindow,          &ScanOptimizer::setTwoOptWindow)
+        .def_property("twoOptPasses",        &ScanOptimizer::twoOptPasses,          &ScanOptimizer::setTwoOptPasses)
+        .def_property("numThreads",          &ScanOptimizer::numThreads,            &ScanOptimizer::setNumThreads);
+
+    m.def("buildSpatialIndices", &slm::buildSpatialIndices, py::arg("layers"), py::arg("numThreads") = 0,
+          "Builds the spatial index of each layer in parallel");
+
+    m.def("deduplicateGeometry", &slm::deduplicateGeometry, py::arg("layers"),
+          "Folds geometries with identical coordinates up to a translation into shared payloads");
+
+    m.def("hatchLengths", [](const Eigen::MatrixXf &coords) {
+                              if(coords.cols() < 2)
+                                  throw std::runtime_error("Coordinates must be an (N x 2) array");
+
+                              Eigen::VectorXf lengths(coords.rows() / 2);
+                              slm::kernels::hatchLengths(coords.col(0).data(), coords.col(1).data(), coords.rows(), lengths.data());
+                              return lengths;
+                          }, py::arg("coords"), "Lengths of the hatch vectors formed by consecutive pairs of points");
+
+    m.def("polylineLength", [](const Eigen::MatrixXf &coords) {
+                                if(coords.cols() < 2)
+                                    throw std::runtime_error("Coordinates must be an (N x 2) array");
+
+                                return slm::kernels::polylineLength(coords.col(0).data(), coords.col(1).data(), coords.rows());
+                            }, py::arg("coords"), "Total length of the polyline passing through the points");
+
+    m.def("boundingBox", [](const Eigen::MatrixXf &coords) {
+                             if(coords.cols() < 2)
+                                 throw std::runtime_error("Coordinates must be an (N x 2) array");
+
+                             float bbox[4];
+                             slm::kernels::boundingBox(coords.col(0).data(), coords.col(1).data(), coords.rows(), bbox);
+                             return std::make_tuple(bbox[0], bbox[1], bbox[2], bbox[3]);
+                         }, py::arg("coords"), "Bounding box of the points ordered as (minX, maxX, minY, maxY)");
+
+    py::class_<slm::Quantization>(m, "Quantization")
+        .def(py::init())
+        .def_readwrite("scale",   &Quantization::scale)
+        .def_readwrite("offsetX", &Quantization::offsetX)
+        .def_readwrite("offsetY", &Quantization::offsetY);
+
     py::class_<slm::Header>(m, "Header", py::dynamic_attr())
         .def(py::init())
         .def_readwrite("filename", &Header::fileName)
         .def_readwrite("creator",  &Header::creator)
         .def_property("version",   &Header::version, &Header::setVersion)
         .def_readwrite("zUnit",    &Header::zUnit)
+        .def_readwrite("quantization", &Header::quantization)
         .def(py::pickle(
                 [](py::object self) { // __getstate__
                     return py::make_tuple(self.attr("filename"), self.attr("version"), self.attr("zUnit"), self.attr("__dict__"));
@@ -340,13 +536,22 @@ PYBIND11_MODULE(slm, m) {
                 }
             ));
 
+    py::class_<slm::BuildStyleResolver>(m, "BuildStyleResolver")
+        .def(py::init())
+        .def(py::init<const std::vector<Model::Ptr> &>(), py::arg("models"))
+        .def("build", &BuildStyleResolver::build, py::arg("models"))
+        .def("clear", &BuildStyleResolver::clear)
+        .def("__len__", &BuildStyleResolver::size)
+        .def("resolve", static_cast<const BuildStyle * (BuildStyleResolver::*)(uint64_t, uint64_t) const>(&BuildStyleResolver::resolve),
+                        py::arg("mid"), py::arg("bid"), py::return_value_policy::reference_internal);
+
     py::class_<slm::Model, std::shared_ptr<slm::Model>>(m, "Model", py::dynamic_attr())
         .def(py::init())
         .def(py::init<uint64_t, uint64_t>(), py::arg("mid"), py::arg("topSliceNum"))
         .def_property("mid", &Model::getId, &Model::setId)
         .def("__len__", [](const Model &s ) { return s.getBuildStyles().size(); })
         .def_property("buildStyles",py::cpp_function(&slm::Model::buildStylesRef,py::return_value_policy::reference, py::keep_alive<1,0>()),
-                                    py::cpp_function(&slm::Model::setBuildStyles, py::keep_alive<1, 2>()))
+                                    py::cpp_function(static_cast<void (slm::Model::*)(const std::vector<BuildStyle::Ptr> &)>(&slm::Model::setBuildStyles), py::keep_alive<1, 2>()))
         //.def_property("buildStyles", &Model::getBuildStyles, &Model::setBuildStyles)
         .def_property("topLayerId",  &Model::getTopSlice, &Model::setTopSlice)
         .def_property("name", &Model::getName, &Model::setName)
@@ -381,6 +586,13 @@ PYBIND11_MODULE(slm, m) {
                 }
             ));
 
+    py::class_<slm::LayerCache, std::shared_ptr<slm::LayerCache>>(m, "LayerCache")
+        .def(py::init<size_t>(), py::arg("maxResidentLayers") = 16)
+        .def_property("maxResidentLayers", &LayerCache::maxResidentLayers, &LayerCache::setMaxResidentLayers)
+        .def_property("maxResidentBytes", &LayerCache::maxResidentBytes, &LayerCache::setMaxResidentBytes)
+        .def_property_readonly("numResidentLayers", &LayerCache::numResidentLayers)
+        .def_property_readonly("residentBytes", &LayerCache::residentBytes);
+
     py::class_<slm::Layer, std::shared_ptr<slm::Layer>>(m, "Layer", py::dynamic_attr())
         .def(py::init())
         .def(py::init<uint64_t, uint64_t>(), py::arg("id"), py::arg("z"))
@@ -393,10 +605,37 @@ PYBIND11_MODULE(slm, m) {
         .def("appendGeometry", &Layer::appendGeometry,  py::keep_alive<1, 2>())
        // .def("geom", [](Layer &v) { return &(v.geometry()); }, py::keep_alive<1,0>())
         .def_property("geometry",py::cpp_function(&Layer::geometryRef,py::return_value_policy::reference, py::keep_alive<1,0>()),
-                                 py::cpp_function(&Layer::setGeometry, py::keep_alive<1, 2>()))
+                                 py::cpp_function(static_cast<void (slm::Layer::*)(const std::vector<LayerGeometry::Ptr> &)>(&Layer::setGeometry), py::keep_alive<1, 2>()))
         .def_property("z", &Layer::getZ, &Layer::setZ)
         .def_property("layerId", &Layer::getLayerId, &Layer::setLayerId)
         .def("getGeometry", &Layer::getGeometry, py::arg("scanMode") = slm::ScanMode::NONE)
+        .def_property_readonly("isArenaBacked", &Layer::isArenaBacked)
+        .def("compact", &Layer::compact)
+        .def_property("quantization", &Layer::quantization, &Layer::setQuantization)
+        .def("quantize", &Layer::quantize)
+        .def("dequantize", &Layer::dequantize)
+        .def("compress", &Layer::compress)
+        .def("expand", &Layer::expand)
+        .def_property_readonly("isCompressed", &Layer::isCompressed)
+        .def("load", &Layer::load)
+        .def("unload", &Layer::unload)
+        .def_property_readonly("isDeferred", &Layer::isDeferred)
+        .def_property_readonly("isModified", &Layer::isModified)
+        .def_property_readonly("residentBytes", &Layer::residentBytes)
+        .def_property_readonly("compressedSize", &Layer::compressedSize)
+        .def_property("cache", &Layer::cache, &Layer::setCache)
+        .def("pin", &Layer::pin)
+        .def("unpin", &Layer::unpin)
+        .def_property_readonly("isPinned", &Layer::isPinned)
+        .def_property_readonly("metrics", [](const Layer &l) { return l.metrics(); })
+        .def("markModified", &Layer::markModified)
+        .def("queryGeometry", &Layer::queryGeometry, py::arg("minX"), py::arg("minY"), py::arg("maxX"), py::arg("maxY"))
+        .def("querySegments", [](const Layer &l, float minX, float minY, float maxX, float maxY) {
+                                   std::vector<std::tuple<uint32_t, uint32_t>> segs;
+                                   for(const SpatialIndex::SegmentRef &seg : l.spatialIndex().querySegments(minX, minY, maxX, maxY))
+                                       segs.push_back(std::make_tuple(seg.geomIdx, seg.segIdx));
+                                   return segs;
+                               }, py::arg("minX"), py::arg("minY"), py::arg("maxX"), py::arg("maxY"))
         .def(py::pickle(
                 [](py::object self) { // __getstate__
                     /* Return a tuple that fully encodes the state of the object */
@@ -417,6 +656,19 @@ PYBIND11_MODULE(slm, m) {
                 }
             ));
 
+    py::class_<slm::LayerIndex>(m, "LayerIndex")
+        .def(py::init())
+        .def(py::init<const std::vector<Layer::Ptr> &>(), py::arg("layers"))
+        .def("build", &LayerIndex::build, py::arg("layers"))
+        .def("update", &LayerIndex::update, py::arg("layers"))
+        .def("clear", &LayerIndex::clear)
+        .def("__len__", &LayerIndex::size)
+        .def("findByZ", &LayerIndex::findByZ, py::arg("z"))
+        .def("findById", &LayerIndex::findById, py::arg("id"))
+        .def("rangeByZ", &LayerIndex::rangeByZ, py::arg("zMin"), py::arg("zMax"))
+        .def("topLayerByZ", &LayerIndex::topLayerByZ)
+        .def("topLayerById", &LayerIndex::topLayerById);
+
 #ifdef PROJECT_VERSION
     m.attr("__version__") = "PROJECT_VERSION";
 #else
@@ -0,0 +1,137 @@
+#include <App/BuildEstimator.h>
+
+#include "Test.h"
+
+using namespace slm;
+
+namespace
+{
+
+BuildStyle::Ptr makeBuildStyle(uint64_t id, LaserMode mode, float power)
+{
+    BuildStyle::Ptr bstyle = std::make_shared<BuildStyle>();
+    bstyle->id = id;
+    bstyle->laserMode = mode;
+    bstyle->laserPower = power;
+    return bstyle;
+}
+
+/*
+ * Model of a CW style for hatches (id 1), a pulsed style for hatches (id 2) and a pulsed style for points (id 3)
+ */
+std::vector<Model::Ptr> makeModels()
+{
+    Model::Ptr model = std::make_shared<Model>(1, 1);
+
+    BuildStyle::Ptr cw = makeBuildStyle(1, LaserMode::CW, 200.f);
+    cw->laserSpeed = 1000.f;      // mm/s
+    cw->jumpSpeed = 5000;         // mm/s
+    cw->jumpDelay = 100;          // us
+    model->addBuildStyle(cw);
+
+    BuildStyle::Ptr pulse = makeBuildStyle(2, LaserMode::PULSE, 100.f);
+    pulse->pointDistance = 50;    // um
+    pulse->pointExposureTime = 80;
+    pulse->pointDelay = 20;
+    model->addBuildStyle(pulse);
+
+    BuildStyle::Ptr pnts = makeBuildStyle(3, LaserMode::PULSE, 100.f);
+    pnts->pointExposureTime = 50;
+    pnts->pointDelay = 10;
+    pnts->jumpSpeed = 1000;
+    pnts->jumpDelay = 10;
+    model->addBuildStyle(pnts);
+
+    return std::vector<Model::Ptr>(1, model);
+}
+
+HatchGeometry::Ptr makeHatch(uint64_t bid, const Eigen::MatrixXf &coords)
+{
+    HatchGeometry::Ptr hatch = std::make_shared<HatchGeometry>(1, bid);
+    hatch->coords = coords;
+    return hatch;
+}
+
+} // End of Anonymous Namespace
+
+SLM_TEST(buildEstimatorUnits)
+{
+    const BuildStyleResolver resolver(makeModels());
+
+    Layer layer(0, 0);
+
+    // Two 10 mm vectors, 1 mm apart
+    Eigen::MatrixXf coords(4, 2);
+    coords << 0.f, 0.f, 10.f, 0.f, 10.f, 1.f, 0.f, 1.f;
+    layer.addHatchGeometry(makeHatch(1, coords));
+
+    const LayerEstimate est = BuildEstimator().estimateLayer(layer, resolver);
+
+    // 20 mm at 1000 mm/s and 200 W, with one 1 mm jump at 5000 mm/s and a 100 us jump delay
+    SLM_CHECK_NEAR(est.scanTime, 0.02, 1e-9);
+    SLM_CHECK_NEAR(est.energy, 4.0, 1e-6);
+    SLM_CHECK_NEAR(est.jumpTime, 1.0 / 5000.0 + 100e-6, 1e-9);
+    SLM_CHECK(est.pointTime == 0.0 && est.numUnresolved == 0);
+}
+
+SLM_TEST(buildEstimatorPulseExposures)
+{
+    const BuildStyleResolver resolver(makeModels());
+
+    Layer layer(0, 0);
+
+    // A 1 mm vector exposed every 50 um, followed by three points 1 mm apart
+    Eigen::MatrixXf coords(2, 2);
+    coords << 0.f, 0.f, 1.f, 0.f;
+    layer.addHatchGeometry(makeHatch(2, coords));
+
+    PntsGeometry::Ptr pnts = std::make_shared<PntsGeometry>(1, 3);
+    pnts->coords.resize(3, 2);
+    pnts->coords << 2.f, 0.f, 3.f, 0.f, 4.f, 0.f;
+    layer.addPntsGeometry(pnts);
+
+    // Geometry without a build style is excluded
+    layer.addHatchGeometry(makeHatch(99, coords));
+
+    const LayerEstimate est = BuildEstimator().estimateLayer(layer, resolver);
+
+    // 20 exposures along the vector and one at its end, each of 80 us followed by a 20 us delay
+    SLM_CHECK_NEAR(est.scanTime, 21 * 100e-6, 1e-9);
+
+    // Three exposures of 50 us followed by a 10 us delay
+    SLM_CHECK_NEAR(est.pointTime, 3 * 60e-6, 1e-9);
+    SLM_CHECK_NEAR(est.energy, 21 * 80e-6 * 100.0 + 3 * 50e-6 * 100.0, 1e-9);
+
+    // Jumps of 1 mm into the points and between them, at 1000 mm/s with a 10 us delay
+    SLM_CHECK_NEAR(est.jumpTime, 3.0 / 1000.0 + 3 * 10e-6, 1e-9);
+    SLM_CHECK(est.numUnresolved == 1);
+}
+
+SLM_TEST(buildEstimatorRecoat)
+{
+    std::vector<Layer::Ptr> layers;
+
+    for(uint64_t i = 0; i < 3; i++) {
+        Eigen::MatrixXf coords(2, 2);
+        coords << 0.f, 0.f, 10.f, 0.f;
+
+        layers.push_back(std::make_shared<Layer>(i, i * 30));
+        layers.back()->addHatchGeometry(makeHatch(1, coords));
+    }
+
+    BuildEstimator estimator;
+    estimator.setLayerCoolingTime(5.0);
+    estimator.setLayerAdditionTime(10.0);
+    estimator.setNumThreads(2);
+
+    const BuildEstimate build = estimator.estimate(layers, makeModels());
+
+    // Powder is added for every layer except the first
+    SLM_CHECK(build.layers.size() == 3);
+    SLM_CHECK_NEAR(build.layers[0].recoatTime, 5.0, 1e-9);
+    SLM_CHECK_NEAR(build.layers[2].recoatTime, 15.0, 1e-9);
+    SLM_CHECK_NEAR(build.recoatTime, 35.0, 1e-9);
+
+    SLM_CHECK_NEAR(build.scanTime, 3 * 0.01, 1e-9);
+    SLM_CHECK_NEAR(build.totalTime(), build.scanTime + build.jumpTime + 35.0, 1e-9);
+}
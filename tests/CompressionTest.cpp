@@ -0,0 +1,218 @@
+#include <cstring>
+#include <random>
+
+#include <App/Layer.h>
+#include <App/LayerCompression.h>
+
+#include "Test.h"
+
+using namespace slm;
+
+namespace
+{
+
+Eigen::MatrixXf randomCoords(Eigen::Index rows, std::mt19937 &rng)
+{
+    std::uniform_real_distribution<float> pos(-150.f, 150.f);
+
+    Eigen::MatrixXf coords(rows, 2);
+
+    for(Eigen::Index i = 0; i < coords.size(); i++)
+        coords.data()[i] = pos(rng);
+
+    return coords;
+}
+
+// Evenly spaced hatch vectors on a 1 um grid
+Eigen::MatrixXf gridHatches(Eigen::Index numVectors)
+{
+    Eigen::MatrixXf coords(2 * numVectors, 2);
+
+    for(Eigen::Index i = 0; i < numVectors; i++) {
+        coords(2 * i, 0)     = float(double(-20000 + 7 * i) * 1e-3);
+        coords(2 * i, 1)     = float(double(5000 + 100 * i) * 1e-3);
+        coords(2 * i + 1, 0) = float(double(20000 - 3 * i) * 1e-3);
+        coords(2 * i + 1, 1) = float(double(5000 + 100 * i) * 1e-3);
+    }
+
+    return coords;
+}
+
+// Layer whose compressed data can be truncated, as if corrupted whilst held in memory
+class CorruptibleLayer : public Layer
+{
+public:
+    using Layer::Layer;
+
+    void truncateCompressed(size_t n) { mCompressed.resize(mCompressed.size() - n); }
+};
+
+} // End of Anonymous Namespace
+
+SLM_TEST(compressionRoundTrip)
+{
+    std::mt19937 rng(3);
+
+    std::vector<LayerGeometry::Ptr> geoms;
+    std::vector<Eigen::MatrixXf> expected;
+
+    // Arbitrary floats, including values that are not on the grid
+    HatchGeometry::Ptr hatch = std::make_shared<HatchGeometry>(1, 1);
+    hatch->coords = randomCoords(64, rng);
+    hatch->coords(0, 0) = -0.f;
+    geoms.push_back(hatch);
+
+    ContourGeometry::Ptr contour = std::make_shared<ContourGeometry>(1, 2);
+    contour->coords = randomCoords(33, rng);
+    geoms.push_back(contour);
+
+    // Coordinates on the grid of the resolution
+    HatchGeometry::Ptr gridHatch = std::make_shared<HatchGeometry>(1, 3);
+    gridHatch->coords = gridHatches(500);
+    geoms.push_back(gridHatch);
+
+    PntsGeometry::Ptr empty = std::make_shared<PntsGeometry>(1, 4);
+    geoms.push_back(empty);
+
+    for(const LayerGeometry::Ptr &geom : geoms)
+        expected.push_back(geom->coords);
+
+    // Quantized storage
+    Quantization quant;
+    quant.scale = 1e-3;
+
+    LayerGeometry::QuantizedCoords qcoords(4, 2);
+    qcoords << 2147483647, -2147483647 - 1,
+               -2147483647 - 1, 2147483647,
+               0, 1,
+               17, -17;
+
+    HatchGeometry::Ptr quantized = std::make_shared<HatchGeometry>(1, 5);
+    quantized->setQuantizedCoords(qcoords, quant);
+    geoms.push_back(quantized);
+
+    // Instanced storage is left in place
+    LayerGeometry::Payload payload = std::make_shared<const Eigen::MatrixXf>(randomCoords(8, rng));
+    ContourGeometry::Ptr instance = std::make_shared<ContourGeometry>(1, 6);
+    instance->setInstance(payload, Eigen::Vector2f(10.f, 5.f), 0.5f);
+    geoms.push_back(instance);
+
+    const Eigen::MatrixXf instanceCoords = instance->floatCoords();
+
+    std::vector<uint8_t> buffer;
+    encodeLayerGeometry(geoms, buffer, &quant);
+
+    SLM_CHECK(!buffer.empty());
+    SLM_CHECK(hatch->coords.size() == 0 && gridHatch->coords.size() == 0);
+    SLM_CHECK(quantized->quantizedCoords().size() == 0);
+
+    // The grid coordinates (8000 bytes of floats) are encoded in less than a byte per coordinate
+    SLM_CHECK(buffer.size() < 64 * 2 * 5 + 33 * 2 * 5 + 2000 + 200);
+
+    SLM_CHECK(decodeLayerGeometry(buffer, geoms));
+
+    for(size_t i = 0; i < expected.size(); i++) {
+        SLM_CHECK(geoms[i]->coords.rows() == expected[i].rows());
+        SLM_CHECK(std::memcmp(geoms[i]->coords.data(), expected[i].data(), expected[i].size() * sizeof(float)) == 0);
+    }
+
+    SLM_CHECK(std::signbit(hatch->coords(0, 0)));
+    SLM_CHECK(quantized->isQuantized() && quantized->quantizedCoords() == qcoords);
+    SLM_CHECK(instance->isInstanced() && instance->floatCoords() == instanceCoords);
+}
+
+SLM_TEST(compressionCorruptData)
+{
+    HatchGeometry::Ptr geom = std::make_shared<HatchGeometry>(1, 1);
+    geom->coords = gridHatches(100);
+
+    const std::vector<LayerGeometry::Ptr> geoms(1, geom);
+
+    std::vector<uint8_t> buffer;
+    encodeLayerGeometry(geoms, buffer);
+
+    // Truncated data
+    std::vector<uint8_t> truncated(buffer.begin(), buffer.end() - 10);
+    SLM_CHECK(!decodeLayerGeometry(truncated, geoms));
+
+    // Partially decoded coordinates are released
+    SLM_CHECK(geom->numPoints() == 0);
+
+    SLM_CHECK(!decodeLayerGeometry(std::vector<uint8_t>(), geoms));
+
+    // Dimensions exceeding the remaining payload are rejected before allocating
+    std::vector<uint8_t> oversized = {0, 0, 0xff, 0xff, 0xff, 0xff, 0x0f, 2, 1, 2, 3};
+    SLM_CHECK(!decodeLayerGeometry(oversized, geoms));
+
+    // Runs of zero residuals exceeding the dimensions of quantized coordinates
+    std::vector<uint8_t> overrun = {0, 1, 0xff, 0xff, 0xff, 0xff, 0x07, 2, 0x07};
+    SLM_CHECK(!decodeLayerGeometry(overrun, geoms));
+
+    std::vector<uint8_t> badColumns = {0, 0, 1, 7, 1, 2, 3, 4, 5, 6, 7};
+    SLM_CHECK(!decodeLayerGeometry(badColumns, geoms));
+
+    // Trailing data
+    std::vector<uint8_t> trailing = buffer;
+    trailing.push_back(0);
+    SLM_CHECK(!decodeLayerGeometry(trailing, geoms));
+}
+
+SLM_TEST(layerCompressExpand)
+{
+    std::mt19937 rng(5);
+
+    Layer layer(4, 120);
+
+    Quantization quant;
+    quant.scale = 1e-3;
+    layer.setQuantization(quant);
+
+    for(int i = 0; i < 10; i++) {
+        HatchGeometry::Ptr hatch = std::make_shared<HatchGeometry>(1, 1);
+        hatch->coords = (i % 2) ? gridHatches(200) : randomCoords(50, rng);
+        layer.addHatchGeometry(hatch);
+    }
+
+    std::vector<Eigen::MatrixXf> expected;
+
+    for(const LayerGeometry::Ptr &geom : layer.geometry())
+        expected.push_back(geom->coords);
+
+    const LayerMetrics metrics = layer.metrics();
+
+    layer.compress();
+
+    SLM_CHECK(layer.isCompressed());
+    SLM_CHECK(layer.compressedSize() > 0);
+
+    // Metrics remain available without expanding the layer
+    SLM_CHECK(layer.metrics().numPoints == metrics.numPoints);
+    SLM_CHECK(layer.isCompressed());
+
+    const std::vector<LayerGeometry::Ptr> &geoms = layer.geometry();
+
+    SLM_CHECK(!layer.isCompressed());
+    SLM_CHECK(geoms.size() == expected.size());
+
+    for(size_t i = 0; i < geoms.size(); i++)
+        SLM_CHECK(geoms[i]->coords == expected[i]);
+}
+
+SLM_TEST(layerExpandCorruptData)
+{
+    CorruptibleLayer layer(5, 150);
+
+    HatchGeometry::Ptr hatch = std::make_shared<HatchGeometry>(1, 1);
+    hatch->coords = gridHatches(100);
+    layer.addHatchGeometry(hatch);
+
+    layer.compress();
+    layer.truncateCompressed(10);
+
+    const size_t compressedSize = layer.compressedSize();
+
+    // The failure is returned and the layer remains compressed with its geometry empty, rather than partially decoded
+    SLM_CHECK(layer.expand() == -1);
+    SLM_CHECK(layer.isCompressed() && layer.compressedSize() == compressedSize);
+    SLM_CHECK(layer.geometry().size() == 1 && layer.geometry()[0]->numPoints() == 0);
+}
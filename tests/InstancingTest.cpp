@@ -0,0 +1,204 @@
+#include <App/Instancing.h>
+#include <App/Layer.h>
+#include <App/LayerCache.h>
+
+#include "Test.h"
+
+using namespace slm;
+
+namespace
+{
+
+ContourGeometry::Ptr makeSquare(float x, float y, float size)
+{
+    ContourGeometry::Ptr geom = std::make_shared<ContourGeometry>(1, 1);
+    geom->coords.resize(5, 2);
+    geom->coords << x,        y,
+                    x + size, y,
+                    x + size, y + size,
+                    x,        y + size,
+                    x,        y;
+    return geom;
+}
+
+std::vector<Layer::Ptr> makeBuild(int numLayers)
+{
+    std::vector<Layer::Ptr> layers;
+
+    for(int i = 0; i < numLayers; i++) {
+        Layer::Ptr layer = std::make_shared<Layer>(i, i * 30);
+        // Each part is repeated on every layer at an offset
+        layer->addContourGeometry(makeSquare(10.f + i, 10.f, 2.5f));
+        layer->addContourGeometry(makeSquare(50.f, 20.f + i, 3.5f));
+        layer->addContourGeometry(makeSquare(90.f, 30.f, 4.5f));
+        layers.push_back(layer);
+    }
+
+    return layers;
+}
+
+} // End of Anonymous Namespace
+
+SLM_TEST(instancingRoundTrip)
+{
+    std::vector<Layer::Ptr> layers = makeBuild(3);
+
+    std::vector<Eigen::MatrixXf> expected;
+
+    for(const Layer::Ptr &layer : layers) {
+        for(const LayerGeometry::Ptr &geom : layer->geometry())
+            expected.push_back(geom->coords);
+    }
+
+    const InstancingResult result = deduplicateGeometry(layers);
+
+    SLM_CHECK(result.numCandidates == 9);
+    SLM_CHECK(result.numInstanced == 9);
+    SLM_CHECK(result.numPayloads == 3);
+    SLM_CHECK(result.bytesSaved == 3 * 2 * 10 * sizeof(float));
+
+    size_t i = 0;
+
+    for(const Layer::Ptr &layer : layers) {
+        for(size_t j = 0; j < layer->geometry().size(); j++) {
+            const LayerGeometry::Ptr &geom = layer->geometry()[j];
+            SLM_CHECK(geom->isInstanced());
+            SLM_CHECK(geom->payload() == layers[0]->geometry()[j]->payload());
+            SLM_CHECK(geom->coords.size() == 0);
+            SLM_CHECK(geom->floatCoords() == expected[i++]);
+        }
+    }
+
+    // Instances survive compression of the layer, and detach into owned storage
+    layers[1]->compress();
+    const LayerGeometry::Ptr geom = layers[1]->geometry()[2];
+
+    SLM_CHECK(geom->isInstanced() && geom->floatCoords() == expected[5]);
+
+    geom->detach();
+    SLM_CHECK(!geom->isInstanced() && geom->coords == expected[5]);
+}
+
+SLM_TEST(instancingEvictedLayers)
+{
+    std::vector<Layer::Ptr> layers = makeBuild(4);
+
+    std::vector<Eigen::MatrixXf> expected;
+
+    for(const Layer::Ptr &layer : layers) {
+        for(const LayerGeometry::Ptr &geom : layer->geometry())
+            expected.push_back(geom->coords);
+    }
+
+    // Only a single layer remains expanded, so that earlier layers are evicted whilst deduplicating
+    LayerCache::Ptr cache = std::make_shared<LayerCache>(1);
+
+    for(const Layer::Ptr &layer : layers)
+        layer->setCache(cache);
+
+    const InstancingResult result = deduplicateGeometry(layers);
+
+    /*
+     * Layers 0 and 1 are evicted before a duplicate is found - the payloads are compared against the coordinates
+     * of the first layer's geometry whilst resident, and copied from the second layer's once the first is evicted
+     */
+    SLM_CHECK(result.numPayloads == 3);
+    SLM_CHECK(result.numInstanced == 6);
+
+    size_t i = 0;
+
+    for(const Layer::Ptr &layer : layers) {
+        for(const LayerGeometry::Ptr &geom : layer->geometry())
+            SLM_CHECK(geom->floatCoords() == expected[i++]);
+    }
+
+    // Geometry evicted before a duplicate was found retains its own coordinates
+    for(size_t j = 0; j < 2; j++) {
+        for(const LayerGeometry::Ptr &geom : layers[j]->geometry())
+            SLM_CHECK(!geom->isInstanced());
+    }
+
+    SLM_CHECK(layers[2]->geometry()[0]->isInstanced());
+    SLM_CHECK(layers[3]->geometry()[0]->isInstanced());
+}
+
+SLM_TEST(instancingUnloadedLayers)
+{
+    LayerCache::Ptr cache = std::make_shared<LayerCache>(1);
+
+    std::vector<Layer::Ptr> layers;
+
+    for(int i = 0; i < 3; i++) {
+        Layer::Ptr layer = std::make_shared<Layer>(i, i * 30);
+
+        layer->setLoader([i](Layer &target) -> int {
+            target.addContourGeometry(makeSquare(10.f + i, 10.f, 2.5f));
+            return 0;
+        });
+
+        layer->setCache(cache);
+        layers.push_back(layer);
+    }
+
+    /*
+     * Each layer is unloaded when the next is loaded, releasing its geometry, which must not be folded (the layer
+     * is loaded again with new geometry)
+     */
+    const InstancingResult result = deduplicateGeometry(layers);
+
+    SLM_CHECK(result.numPayloads == 1);
+    SLM_CHECK(result.numInstanced == 1);
+
+    SLM_CHECK(layers[2]->geometry()[0]->isInstanced());
+    SLM_CHECK(layers[2]->isModified());
+    SLM_CHECK(layers[2]->geometry()[0]->floatCoords() == makeSquare(12.f, 10.f, 2.5f)->coords);
+
+    SLM_CHECK(!layers[0]->geometry()[0]->isInstanced());
+    SLM_CHECK(!layers[0]->isModified());
+}
+
+SLM_TEST(instancingQuarterTurns)
+{
+    // An asymmetric part, and copies rotated by one and two quarter turns
+    ContourGeometry::Ptr part = std::make_shared<ContourGeometry>(1, 1);
+    part->coords.resize(4, 2);
+    part->coords << 0.f,  0.f,
+                    3.f,  0.f,
+                    3.f,  1.5f,
+                    0.f,  0.f;
+
+    ContourGeometry::Ptr turned = std::make_shared<ContourGeometry>(1, 1);
+    turned->coords.resize(4, 2);
+    turned->coords << 20.f,  20.f,
+                      20.f,  23.f,
+                      18.5f, 23.f,
+                      20.f,  20.f;
+
+    ContourGeometry::Ptr reversed = std::make_shared<ContourGeometry>(1, 1);
+    reversed->coords.resize(4, 2);
+    reversed->coords << -5.25f, 7.5f,
+                        -8.25f, 7.5f,
+                        -8.25f, 6.f,
+                        -5.25f, 7.5f;
+
+    const std::vector<Eigen::MatrixXf> expected = {part->coords, turned->coords, reversed->coords};
+
+    Layer::Ptr layer = std::make_shared<Layer>(0, 0);
+    layer->addContourGeometry(part);
+    layer->addContourGeometry(turned);
+    layer->addContourGeometry(reversed);
+
+    const InstancingResult result = deduplicateGeometry(std::vector<Layer::Ptr>(1, layer));
+
+    SLM_CHECK(result.numPayloads == 1);
+    SLM_CHECK(result.numInstanced == 3);
+
+    for(size_t i = 0; i < expected.size(); i++) {
+        const LayerGeometry::Ptr &geom = layer->geometry()[i];
+        SLM_CHECK(geom->isInstanced() && geom->payload() == part->payload());
+        SLM_CHECK(geom->floatCoords() == expected[i]);
+    }
+
+    SLM_CHECK(turned->rotation() == LayerGeometry::quarterTurns(1));
+    SLM_CHECK(reversed->rotation() == LayerGeometry::quarterTurns(2));
+}
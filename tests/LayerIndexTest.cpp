@@ -0,0 +1,92 @@
+#include <App/LayerIndex.h>
+
+#include "Test.h"
+
+using namespace slm;
+
+namespace
+{
+
+std::vector<Layer::Ptr> makeLayers(const std::vector<uint64_t> &zValues)
+{
+    std::vector<Layer::Ptr> layers;
+
+    for(size_t i = 0; i < zValues.size(); i++)
+        layers.push_back(std::make_shared<Layer>(i, zValues[i]));
+
+    return layers;
+}
+
+} // End of Anonymous Namespace
+
+SLM_TEST(layerIndexLookups)
+{
+    // Out of order, with a repeated Z position
+    std::vector<Layer::Ptr> layers = makeLayers({60, 0, 30, 90, 30});
+
+    LayerIndex index(layers);
+
+    SLM_CHECK(index.size() == layers.size());
+    SLM_CHECK(index.findByZ(60) == layers[0]);
+    SLM_CHECK(index.findById(3) == layers[3]);
+    SLM_CHECK(index.findByZ(45) == nullptr);
+    SLM_CHECK(index.findById(7) == nullptr);
+
+    // Ties return the first layer indexed
+    SLM_CHECK(index.findByZ(30) == layers[2]);
+
+    const std::vector<Layer::Ptr> range = index.rangeByZ(20, 60);
+    SLM_CHECK(range.size() == 3);
+    SLM_CHECK(range[0] == layers[2] && range[1] == layers[4] && range[2] == layers[0]);
+
+    SLM_CHECK(index.rangeByZ(60, 20).empty());
+    SLM_CHECK(index.rangeByZ(100, 200).empty());
+
+    SLM_CHECK(index.topLayerByZ() == layers[3]);
+    SLM_CHECK(index.topLayerById() == layers[4]);
+}
+
+SLM_TEST(layerIndexUpdate)
+{
+    std::vector<Layer::Ptr> layers = makeLayers({0, 30, 60});
+
+    LayerIndex index(layers);
+
+    // Appended layers are merged into the index
+    layers.push_back(std::make_shared<Layer>(3, 15));
+    layers.push_back(std::make_shared<Layer>(4, 120));
+    index.update(layers);
+
+    SLM_CHECK(index.size() == 5);
+    SLM_CHECK(index.findByZ(15) == layers[3]);
+    SLM_CHECK(index.rangeByZ(0, 30).size() == 3);
+    SLM_CHECK(index.topLayerByZ() == layers[4]);
+
+    // Replacing the collection other than by appending rebuilds the index
+    layers = makeLayers({300, 330});
+    index.update(layers);
+
+    SLM_CHECK(index.size() == 2);
+    SLM_CHECK(index.findByZ(15) == nullptr);
+    SLM_CHECK(index.findByZ(330) == layers[1]);
+
+    index.clear();
+    SLM_CHECK(index.empty() && index.topLayerByZ() == nullptr);
+}
+
+SLM_TEST(layerIndexTopLayer)
+{
+    // Layers without Z positions (e.g. formats storing only the layer id) all share Z = 0
+    const std::vector<Layer::Ptr> layers = makeLayers({0, 0, 0});
+
+    LayerIndex index(layers);
+
+    // The first of the layers sharing the largest key is the top layer, consistent with the linear scans
+    SLM_CHECK(index.topLayerByZ() == layers[0]);
+    SLM_CHECK(LayerIndex::findTopLayerByZ(layers) == layers[0]);
+
+    SLM_CHECK(index.topLayerById() == layers[2]);
+    SLM_CHECK(LayerIndex::findTopLayerById(layers) == layers[2]);
+
+    SLM_CHECK(LayerIndex::findTopLayerByZ(std::vector<Layer::Ptr>()) == nullptr);
+}
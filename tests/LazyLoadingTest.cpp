@@ -0,0 +1,216 @@
+#include <App/Layer.h>
+#include <App/LayerCache.h>
+#include <App/Reader.h>
+
+#include "Test.h"
+
+using namespace slm;
+
+namespace
+{
+
+const size_t NumLayers = 8;
+const int HatchesPerLayer = 50;
+
+/*
+ * Reader which defers each layer whilst parsing, and generates the geometry of a layer from its file position
+ * when loaded. Loads of each layer are counted, and may be made to fail.
+ */
+class LazyReader : public base::Reader
+{
+public:
+    LazyReader() : mNumLoads(NumLayers, 0), mFailLoads(false) {}
+
+    int parse() override
+    {
+        for(size_t i = 0; i < NumLayers; i++) {
+            Layer::Ptr layer = createLayer(i, i * 30);
+            layer->setLayerFilePosition(i);
+            deferLayer(layer);
+            layers.push_back(layer);
+        }
+
+        setReady(true);
+        return 0;
+    }
+
+    double getLayerThickness() const override { return 30.0; }
+
+    int numLoads(size_t i) const { return mNumLoads[i]; }
+    void setFailLoads(bool state) { mFailLoads = state; }
+
+    static float expectedX(uint64_t pos, int i) { return float(pos) * 100.f + float(i); }
+
+protected:
+    int readLayerGeometry(Layer &layer) override
+    {
+        const uint64_t pos = layer.layerFilePosition();
+        mNumLoads[pos]++;
+
+        for(int i = 0; i < HatchesPerLayer; i++) {
+
+            // A failing load leaves the layer partially read
+            if(mFailLoads && i == HatchesPerLayer / 2)
+                return -1;
+
+            HatchGeometry::Ptr hatch = layer.createGeometry<HatchGeometry>(1, 1, 2);
+            hatch->coords << expectedX(pos, i), 0.f, expectedX(pos, i) + 1.f, 1.f;
+            layer.addHatchGeometry(hatch);
+        }
+
+        return 0;
+    }
+
+private:
+    std::vector<int> mNumLoads;
+    bool mFailLoads;
+};
+
+bool hasExpectedGeometry(const Layer &layer)
+{
+    const std::vector<LayerGeometry::Ptr> &geoms = layer.geometry();
+
+    if(geoms.size() != size_t(HatchesPerLayer))
+        return false;
+
+    for(int i = 0; i < HatchesPerLayer; i++) {
+        if(geoms[i]->coordinates()(0, 0) != LazyReader::expectedX(layer.layerFilePosition(), i))
+            return false;
+    }
+
+    return true;
+}
+
+} // End of Anonymous Namespace
+
+SLM_TEST(lazyLoadEvictCycle)
+{
+    LazyReader reader;
+    reader.layerCache()->setMaxResidentLayers(2);
+    reader.parse();
+
+    const std::vector<Layer::Ptr> &layers = reader.getLayers();
+
+    for(const Layer::Ptr &layer : layers)
+        SLM_CHECK(layer->isDeferred() && !layer->isLoaded());
+
+    // Loading every layer in turn retains only the most recently used layers
+    for(size_t i = 0; i < NumLayers; i++) {
+        SLM_CHECK(hasExpectedGeometry(*layers[i]));
+        SLM_CHECK(reader.layerCache()->numResidentLayers() <= 2);
+    }
+
+    SLM_CHECK(layers[0]->isDeferred() && !layers[0]->isLoaded());
+    SLM_CHECK(layers[NumLayers - 1]->isLoaded());
+
+    // Unloaded layers are loaded again from the file on access
+    SLM_CHECK(hasExpectedGeometry(*layers[0]));
+    SLM_CHECK(reader.numLoads(0) == 2);
+    SLM_CHECK(reader.numLoads(NumLayers - 1) == 1);
+
+    SLM_CHECK(reader.unloadLayer(0) == 0);
+    SLM_CHECK(layers[0]->isDeferred());
+    SLM_CHECK(reader.loadLayer(0) == 0);
+    SLM_CHECK(reader.numLoads(0) == 3);
+}
+
+SLM_TEST(lazyLoadModifiedLayer)
+{
+    LazyReader reader;
+    reader.layerCache()->setMaxResidentLayers(1);
+    reader.parse();
+
+    const std::vector<Layer::Ptr> &layers = reader.getLayers();
+
+    SLM_CHECK(layers[0]->load() == 0);
+    SLM_CHECK(!layers[0]->isModified());
+
+    layers[0]->geometry()[0]->coords(0, 0) = -1.f;
+    layers[0]->markModified();
+
+    SLM_CHECK(layers[0]->isModified());
+    SLM_CHECK(layers[0]->unload() == -1);
+
+    // The modified layer is compressed rather than unloaded when evicted, so that the modification is retained
+    SLM_CHECK(layers[1]->load() == 0);
+    SLM_CHECK(layers[0]->isCompressed() && !layers[0]->isDeferred());
+
+    SLM_CHECK(layers[0]->geometry()[0]->coordinates()(0, 0) == -1.f);
+    SLM_CHECK(reader.numLoads(0) == 1);
+}
+
+SLM_TEST(lazyLoadPinnedLayer)
+{
+    LazyReader reader;
+    reader.layerCache()->setMaxResidentLayers(1);
+    reader.parse();
+
+    const std::vector<Layer::Ptr> &layers = reader.getLayers();
+
+    SLM_CHECK(layers[0]->pin() == 0);
+    SLM_CHECK(layers[0]->isPinned() && layers[0]->isLoaded());
+
+    const std::vector<LayerGeometry::Ptr> &geoms = layers[0]->geometry();
+
+    // The pinned layer is retained over the budget, so references to its geometry remain valid
+    SLM_CHECK(hasExpectedGeometry(*layers[1]));
+    SLM_CHECK(layers[0]->isLoaded() && reader.layerCache()->numResidentLayers() == 2);
+    SLM_CHECK(geoms.size() == size_t(HatchesPerLayer));
+    SLM_CHECK(geoms[0]->coordinates()(0, 0) == LazyReader::expectedX(0, 0));
+
+    // Once unpinned, the least recently used layer is evicted
+    layers[0]->unpin();
+
+    SLM_CHECK(!layers[0]->isPinned() && layers[0]->isDeferred());
+    SLM_CHECK(reader.layerCache()->numResidentLayers() == 1);
+    SLM_CHECK(reader.numLoads(0) == 1);
+}
+
+SLM_TEST(lazyLoadFailure)
+{
+    LazyReader reader;
+    reader.parse();
+    reader.setFailLoads(true);
+
+    const Layer::Ptr &layer = reader.getLayers()[0];
+
+    SLM_CHECK(layer->load() == -1);
+    SLM_CHECK(layer->isDeferred() && !layer->isLoaded());
+
+    // The partially read geometry is released (accessing it retries the load, which fails again)
+    SLM_CHECK(layer->geometry().empty());
+    SLM_CHECK(reader.layerCache()->numResidentLayers() == 0);
+
+    // A later access retries the load
+    reader.setFailLoads(false);
+
+    SLM_CHECK(hasExpectedGeometry(*layer));
+    SLM_CHECK(layer->isLoaded() && !layer->isDeferred());
+    SLM_CHECK(reader.numLoads(0) == 3);
+}
+
+SLM_TEST(layerCacheResidentBytes)
+{
+    LayerCache::Ptr cache = std::make_shared<LayerCache>(4);
+
+    Layer::Ptr layer = std::make_shared<Layer>(0, 0);
+    layer->setCache(cache);
+
+    const size_t initialBytes = cache->residentBytes();
+
+    HatchGeometry::Ptr hatch = std::make_shared<HatchGeometry>(1, 1);
+    hatch->coords.resize(1000, 2);
+    layer->addHatchGeometry(hatch);
+
+    // The size of the layer is updated when next accessed
+    SLM_CHECK(!layer->geometry().empty());
+    SLM_CHECK(cache->residentBytes() == layer->residentBytes());
+    SLM_CHECK(cache->residentBytes() >= initialBytes + 1000 * 2 * sizeof(float));
+
+    // The most recently used layer is retained, even if over budget
+    cache->setMaxResidentBytes(1);
+    SLM_CHECK(cache->numResidentLayers() == 1 && !layer->isCompressed());
+
+    layer->setCache(LayerCache::Ptr());
+    SLM_CHECK(cache->residentBytes() == 0);
+}
@@ -0,0 +1,74 @@
+#include <thread>
+
+#include <App/Model.h>
+
+#include "Test.h"
+
+using namespace slm;
+
+namespace
+{
+
+BuildStyle::Ptr makeBuildStyle(uint64_t id)
+{
+    BuildStyle::Ptr bstyle = std::make_shared<BuildStyle>();
+    bstyle->id = id;
+    return bstyle;
+}
+
+} // End of Anonymous Namespace
+
+SLM_TEST(modelBuildStyleLookup)
+{
+    Model model(1, 10);
+
+    for(uint64_t id = 1; id <= 100; id++)
+        SLM_CHECK(model.addBuildStyle(makeBuildStyle(id)) == int64_t(id));
+
+    // Duplicate ids are rejected
+    SLM_CHECK(model.addBuildStyle(makeBuildStyle(50)) == -1);
+    SLM_CHECK(model.getBuildStyleById(50) == model.getBuildStyles()[49]);
+    SLM_CHECK(model.getBuildStyleById(101) == nullptr);
+
+    // Build styles modified by reference are found once the index is rebuilt
+    model.buildStylesRef()[0] = makeBuildStyle(1000);
+
+    SLM_CHECK(model.getBuildStyleById(1000) == model.getBuildStyles()[0]);
+    SLM_CHECK(model.getBuildStyleById(1) == nullptr);
+
+    SLM_CHECK(model.addBuildStyle(makeBuildStyle(1)) == 101);
+    SLM_CHECK(model.getBuildStyleById(1) == model.getBuildStyles()[100]);
+
+    // Copies are indexed independently
+    Model copy(model);
+    SLM_CHECK(copy.getBuildStyleById(1000) == model.getBuildStyles()[0]);
+}
+
+SLM_TEST(modelConcurrentLookup)
+{
+    Model model(1, 10);
+
+    for(uint64_t id = 1; id <= 1000; id++)
+        model.addBuildStyle(makeBuildStyle(id));
+
+    // An unsuccessful lookup after taking the build styles by reference rebuilds the index whilst others look up
+    model.buildStylesRef();
+
+    std::vector<int> numFound(4, 0);
+    std::vector<std::thread> threads;
+
+    for(size_t t = 0; t < numFound.size(); t++) {
+        threads.emplace_back([&model, &numFound, t]() {
+            for(uint64_t id = 0; id <= 1000; id++) {
+                if(model.getBuildStyleById(id))
+                    numFound[t]++;
+            }
+        });
+    }
+
+    for(std::thread &thread : threads)
+        thread.join();
+
+    for(int found : numFound)
+        SLM_CHECK(found == 1000);
+}
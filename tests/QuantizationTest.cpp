@@ -0,0 +1,142 @@
+#include <limits>
+
+#include <App/Layer.h>
+
+#include "Test.h"
+
+using namespace slm;
+
+namespace
+{
+
+HatchGeometry::Ptr makeHatch()
+{
+    HatchGeometry::Ptr geom = std::make_shared<HatchGeometry>(1, 2);
+    geom->coords.resize(4, 2);
+    geom->coords << 0.0f,    10.0f,
+                    5.25f,   10.0f,
+                    -3.1f,   10.05f,
+                    12.345f, 10.05f;
+    return geom;
+}
+
+} // End of Anonymous Namespace
+
+SLM_TEST(quantizeRoundTrip)
+{
+    HatchGeometry::Ptr geom = makeHatch();
+    const Eigen::MatrixXf original = geom->coords;
+    const GeometryMetrics before = geom->metrics();
+
+    Quantization quant;
+    quant.scale = 1e-3;
+    quant.offsetX = -50.0;
+    quant.offsetY = 20.0;
+
+    geom->quantize(quant);
+
+    SLM_CHECK(geom->isQuantized());
+    SLM_CHECK(geom->coords.size() == 0);
+    SLM_CHECK(geom->numPoints() == original.rows());
+    SLM_CHECK(geom->quantizedCoords()(1, 0) == 55250); // (5.25 + 50) / 1e-3
+    SLM_CHECK(geom->quantizedCoords()(0, 1) == -10000); // (10 - 20) / 1e-3
+
+    // Coordinates are recovered to within half of the quantization step
+    const Eigen::MatrixXf resolved = geom->floatCoords();
+    SLM_CHECK(resolved.rows() == original.rows() && resolved.cols() == 2);
+    SLM_CHECK((resolved - original).cwiseAbs().maxCoeff() <= 0.5e-3 + 1e-5);
+
+    SLM_CHECK_NEAR(geom->metrics().pathLength, before.pathLength, 1e-3);
+
+    geom->dequantize();
+
+    SLM_CHECK(!geom->isQuantized());
+    SLM_CHECK(geom->coords.rows() == original.rows());
+    SLM_CHECK((geom->coords - original).cwiseAbs().maxCoeff() <= 0.5e-3 + 1e-5);
+}
+
+SLM_TEST(quantizedPassThrough)
+{
+    // Integer coordinates set directly are retained without conversion
+    LayerGeometry::QuantizedCoords qcoords(2, 2);
+    qcoords << 2147483647, -2147483647 - 1,
+               123456789,  -5;
+
+    Quantization quant;
+    quant.scale = 1e-4;
+
+    HatchGeometry::Ptr geom = std::make_shared<HatchGeometry>(1, 1);
+    geom->setQuantizedCoords(qcoords, quant);
+
+    SLM_CHECK(geom->isQuantized());
+    SLM_CHECK(geom->quantizedCoords() == qcoords);
+    SLM_CHECK(geom->quantization() == quant);
+
+    // Re-quantizing with the same quantization leaves the integers untouched
+    geom->quantize(quant);
+    SLM_CHECK(geom->quantizedCoords() == qcoords);
+}
+
+SLM_TEST(layerQuantize)
+{
+    Layer layer(1, 30);
+    layer.addHatchGeometry(makeHatch());
+    layer.addHatchGeometry(makeHatch());
+
+    const double pathLength = layer.metrics().pathLength;
+
+    Quantization quant;
+    quant.scale = 1e-3;
+    layer.setQuantization(quant);
+    SLM_CHECK(layer.quantize() == 0);
+
+    for(const LayerGeometry::Ptr &geom : layer.geometry()) {
+        SLM_CHECK(geom->isQuantized());
+        SLM_CHECK(geom->quantization() == quant);
+    }
+
+    SLM_CHECK_NEAR(layer.metrics().pathLength, pathLength, 2e-3);
+
+    layer.dequantize();
+
+    for(const LayerGeometry::Ptr &geom : layer.geometry())
+        SLM_CHECK(!geom->isQuantized());
+}
+
+SLM_TEST(quantizeOutOfRange)
+{
+    Quantization quant;
+    quant.scale = 1e-3;
+
+    // Coordinates beyond the range of int32_t are clamped
+    HatchGeometry::Ptr geom = makeHatch();
+    geom->coords(0, 0) = 1e7f;
+    geom->coords(1, 0) = -1e7f;
+
+    SLM_CHECK(geom->quantize(quant) == 0);
+    SLM_CHECK(geom->quantizedCoords()(0, 0) == std::numeric_limits<int32_t>::max());
+    SLM_CHECK(geom->quantizedCoords()(1, 0) == std::numeric_limits<int32_t>::min());
+
+    // Non-finite coordinates are rejected, leaving the geometry unchanged
+    const float nonFinite[2] = {std::numeric_limits<float>::quiet_NaN(), std::numeric_limits<float>::infinity()};
+
+    for(float val : nonFinite) {
+        geom = makeHatch();
+        geom->coords(2, 1) = val;
+
+        SLM_CHECK(geom->quantize(quant) == -1);
+        SLM_CHECK(!geom->isQuantized() && geom->coords.rows() == 4);
+    }
+
+    Layer layer(1, 30);
+    layer.addHatchGeometry(makeHatch());
+    layer.addHatchGeometry(geom);
+    layer.setQuantization(quant);
+
+    SLM_CHECK(layer.quantize() == -1);
+    SLM_CHECK(layer.geometry()[0]->isQuantized() && !layer.geometry()[1]->isQuantized());
+
+    // As is an invalid quantization
+    quant.scale = 0.0;
+    SLM_CHECK(makeHatch()->quantize(quant) == -1);
+}
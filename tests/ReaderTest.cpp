@@ -0,0 +1,145 @@
+#include <chrono>
+#include <thread>
+
+#include <App/Reader.h>
+
+#include "Test.h"
+
+using namespace slm;
+
+namespace
+{
+
+// Reader with a model and a layer every 30 um, without geometry
+class BuildReader : public base::Reader
+{
+public:
+    explicit BuildReader(size_t numLayers) : mNumLayers(numLayers) {}
+
+    int parse() override
+    {
+        models.push_back(std::make_shared<Model>(1, mNumLayers));
+
+        for(size_t i = 0; i < mNumLayers; i++)
+            layers.push_back(createLayer(i, i * 30));
+
+        setReady(true);
+        return 0;
+    }
+
+    double getLayerThickness() const override { return 30.0; }
+
+private:
+    size_t mNumLayers;
+};
+
+/*
+ * Reader which decodes layers from a layer offset table, generating a hatch of each layer from its file position.
+ * Earlier layers take longer to decode, so that layers complete out of order across threads, and the layer at a
+ * given offset may be made to fail.
+ */
+class OffsetReader : public base::Reader
+{
+public:
+    explicit OffsetReader(const std::vector<LayerOffset> &entries) : mEntries(entries), mFailOffset(-1) {}
+
+    int parse() override
+    {
+        setReady(true);
+        return decodeLayers(mEntries);
+    }
+
+    double getLayerThickness() const override { return 30.0; }
+
+    void setFailOffset(int64_t offset) { mFailOffset = offset; }
+
+protected:
+    int readLayerGeometry(Layer &layer) override
+    {
+        const uint64_t pos = layer.layerFilePosition();
+
+        if(int64_t(pos) == mFailOffset)
+            return -1;
+
+        std::this_thread::sleep_for(std::chrono::microseconds(100 * (mEntries.size() - pos % mEntries.size())));
+
+        HatchGeometry::Ptr hatch = layer.createGeometry<HatchGeometry>(1, 1, 2);
+        hatch->coords << float(pos), 0.f, float(pos), 1.f;
+        layer.addHatchGeometry(hatch);
+
+        return 0;
+    }
+
+private:
+    std::vector<LayerOffset> mEntries;
+    int64_t mFailOffset;
+};
+
+std::vector<base::Reader::LayerOffset> makeEntries(size_t numLayers)
+{
+    std::vector<base::Reader::LayerOffset> entries;
+
+    // Layers are listed in descending Z, which is retained by the reader
+    for(size_t i = 0; i < numLayers; i++)
+        entries.push_back(base::Reader::LayerOffset{i, 100 + i, (numLayers - i) * 30});
+
+    return entries;
+}
+
+} // End of Anonymous Namespace
+
+SLM_TEST(readerTakeOwnership)
+{
+    BuildReader reader(4);
+    reader.parse();
+
+    SLM_CHECK(reader.getModelById(1) != nullptr);
+    SLM_CHECK(reader.getLayerById(2) != nullptr);
+
+    const std::vector<Model::Ptr> models = reader.takeModels();
+    const std::vector<Layer::Ptr> layers = reader.takeLayers();
+
+    SLM_CHECK(models.size() == 1 && layers.size() == 4);
+
+    // The reader is left empty, including its indices
+    SLM_CHECK(reader.getModels().empty() && reader.getLayers().empty());
+    SLM_CHECK(reader.getModelById(1) == nullptr);
+    SLM_CHECK(reader.getLayerById(2) == nullptr);
+}
+
+SLM_TEST(readerDecodeLayersOrder)
+{
+    const std::vector<base::Reader::LayerOffset> entries = makeEntries(32);
+
+    for(unsigned int numThreads = 1; numThreads <= 4; numThreads *= 2) {
+
+        OffsetReader reader(entries);
+        reader.setNumThreads(numThreads);
+
+        SLM_CHECK(reader.parse() == 0);
+
+        const std::vector<Layer::Ptr> &layers = reader.getLayers();
+
+        SLM_CHECK(layers.size() == entries.size());
+
+        for(size_t i = 0; i < layers.size() && i < entries.size(); i++) {
+            SLM_CHECK(layers[i]->getLayerId() == entries[i].id && layers[i]->getZ() == entries[i].z);
+            SLM_CHECK(layers[i]->isLoaded());
+            SLM_CHECK(layers[i]->geometry().size() == 1);
+            SLM_CHECK(layers[i]->geometry()[0]->coordinates()(0, 0) == float(entries[i].offset));
+        }
+
+        SLM_CHECK(reader.getLayerById(110) == layers[10]);
+    }
+}
+
+SLM_TEST(readerDecodeLayersFailure)
+{
+    OffsetReader reader(makeEntries(16));
+    reader.setNumThreads(4);
+    reader.setFailOffset(7);
+
+    // No layers are appended if any layer cannot be read
+    SLM_CHECK(reader.parse() == -1);
+    SLM_CHECK(reader.getLayers().empty());
+}
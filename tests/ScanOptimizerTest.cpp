@@ -0,0 +1,149 @@
+#include <cmath>
+
+#include <App/ScanOptimizer.h>
+
+#include "Test.h"
+
+using namespace slm;
+
+namespace
+{
+
+void addHatch(Layer &layer, float x0, float y0, float x1, float y1)
+{
+    HatchGeometry::Ptr hatch = std::make_shared<HatchGeometry>(1, 1);
+    hatch->coords.resize(2, 2);
+    hatch->coords << x0, y0, x1, y1;
+    layer.addHatchGeometry(hatch);
+}
+
+void addPoint(Layer &layer, float x, float y)
+{
+    PntsGeometry::Ptr pnts = std::make_shared<PntsGeometry>(1, 1);
+    pnts->coords.resize(1, 2);
+    pnts->coords << x, y;
+    layer.addPntsGeometry(pnts);
+}
+
+} // End of Anonymous Namespace
+
+SLM_TEST(scanOptimizerGreedy)
+{
+    Layer layer(0, 0);
+
+    const float xs[5] = {0.f, 8.f, 2.f, 6.f, 4.f};
+
+    for(float x : xs)
+        addHatch(layer, x, 0.f, x + 1.f, 0.f);
+
+    ScanOptimizer optimizer;
+    optimizer.setTwoOpt(false);
+
+    const ScanOptimizerResult result = optimizer.optimize(layer);
+
+    // The nearest remaining hatch is scanned next, each in its original direction
+    SLM_CHECK_NEAR(result.jumpLengthBefore, 7.0 + 7.0 + 3.0 + 3.0, 1e-6);
+    SLM_CHECK_NEAR(result.jumpLengthAfter, 4.0, 1e-6);
+    SLM_CHECK(result.numReversed == 0);
+
+    const std::vector<LayerGeometry::Ptr> &geoms = layer.geometry();
+
+    SLM_CHECK(geoms.size() == 5);
+
+    for(size_t i = 0; i < geoms.size(); i++)
+        SLM_CHECK(geoms[i]->coordinates()(0, 0) == float(2 * i));
+
+    SLM_CHECK_NEAR(layer.metrics().pathLength, 5.0, 1e-6);
+}
+
+SLM_TEST(scanOptimizerTwoOpt)
+{
+    /*
+     * From (0, 0), the greedy order visits (2, 2) and (1, 4) before jumping back to (4, 0). Reversing the run of
+     * the first three points, so that the scan starts at (1, 4), avoids the longest jump.
+     */
+    const float pnts[4][2] = {{0.f, 0.f}, {2.f, 2.f}, {4.f, 0.f}, {1.f, 4.f}};
+
+    double jumpLength[2];
+
+    for(int twoOpt = 0; twoOpt < 2; twoOpt++) {
+
+        Layer layer(0, 0);
+
+        for(const float *pnt : pnts)
+            addPoint(layer, pnt[0], pnt[1]);
+
+        ScanOptimizer optimizer;
+        optimizer.setTwoOpt(twoOpt != 0);
+
+        jumpLength[twoOpt] = optimizer.optimize(layer).jumpLengthAfter;
+
+        if(twoOpt)
+            SLM_CHECK(layer.geometry()[0]->coordinates()(0, 1) == 4.f);
+    }
+
+    SLM_CHECK_NEAR(jumpLength[0], std::sqrt(8.0) + std::sqrt(5.0) + 5.0, 1e-5);
+    SLM_CHECK_NEAR(jumpLength[1], std::sqrt(5.0) + std::sqrt(8.0) + 4.0, 1e-5);
+}
+
+SLM_TEST(scanOptimizerReversal)
+{
+    // Hatches scanned left to right on alternate rows
+    for(int reversing = 0; reversing < 2; reversing++) {
+
+        Layer layer(0, 0);
+        addHatch(layer, 0.f, 0.f, 10.f, 0.f);
+        addHatch(layer, 0.f, 1.f, 10.f, 1.f);
+
+        ScanOptimizer optimizer;
+        optimizer.setReversing(reversing != 0);
+
+        const ScanOptimizerResult result = optimizer.optimize(layer);
+
+        if(reversing) {
+            // The second hatch is scanned in reverse, starting from the end of the first
+            SLM_CHECK(result.numReversed == 1);
+            SLM_CHECK_NEAR(result.jumpLengthAfter, 1.0, 1e-6);
+            SLM_CHECK(layer.geometry()[1]->coordinates()(0, 0) == 10.f);
+        } else {
+            SLM_CHECK(result.numReversed == 0);
+            SLM_CHECK_NEAR(result.jumpLengthAfter, result.jumpLengthBefore, 1e-6);
+            SLM_CHECK(layer.geometry()[1]->coordinates()(0, 0) == 0.f);
+        }
+    }
+
+    // Individual hatch vectors are flipped to start nearest the end of the previous vector
+    Layer layer(0, 0);
+
+    HatchGeometry::Ptr hatch = std::make_shared<HatchGeometry>(1, 1);
+    hatch->coords.resize(4, 2);
+    hatch->coords << 0.f, 0.f, 10.f, 0.f, 0.f, 1.f, 10.f, 1.f;
+    layer.addHatchGeometry(hatch);
+
+    ScanOptimizer optimizer;
+    optimizer.setHatchVectorFlipping(true);
+    optimizer.optimize(layer);
+
+    SLM_CHECK(hatch->coordinates()(2, 0) == 10.f && hatch->coordinates()(3, 0) == 0.f);
+    SLM_CHECK_NEAR(layer.metrics().jumpLength, 1.0, 1e-6);
+}
+
+SLM_TEST(scanOptimizerContourFirst)
+{
+    Layer layer(0, 0);
+    addHatch(layer, 0.f, 0.f, 1.f, 0.f);
+
+    ContourGeometry::Ptr contour = std::make_shared<ContourGeometry>(1, 1);
+    contour->coords.resize(4, 2);
+    contour->coords << 5.f, 5.f, 6.f, 5.f, 6.f, 6.f, 5.f, 5.f;
+    layer.addContourGeometry(contour);
+
+    ScanOptimizer optimizer;
+    optimizer.setScanMode(CONTOUR_FIRST);
+    optimizer.setReversing(true);
+    optimizer.optimize(layer);
+
+    // Contours are scanned before hatches, and retain their direction
+    SLM_CHECK(layer.geometry()[0] == contour);
+    SLM_CHECK(contour->coordinates()(1, 0) == 6.f && contour->coordinates()(1, 1) == 5.f);
+}
@@ -0,0 +1,144 @@
+#include <algorithm>
+#include <cfloat>
+#include <random>
+
+#include <App/Layer.h>
+#include <App/LayerCache.h>
+#include <App/SpatialIndex.h>
+
+#include "Test.h"
+
+using namespace slm;
+
+namespace
+{
+
+Layer::Ptr makeLayer(uint64_t id, std::mt19937 &rng)
+{
+    std::uniform_real_distribution<float> pos(0.f, 100.f);
+
+    Layer::Ptr layer = std::make_shared<Layer>(id, id * 30);
+
+    for(int i = 0; i < 200; i++) {
+        HatchGeometry::Ptr hatch = std::make_shared<HatchGeometry>(1, 1);
+        hatch->coords.resize(8, 2);
+
+        const float x = pos(rng), y = pos(rng);
+
+        for(int j = 0; j < 4; j++) {
+            hatch->coords.row(2 * j)     << x,        y + 0.1f * j;
+            hatch->coords.row(2 * j + 1) << x + 2.0f, y + 0.1f * j;
+        }
+
+        layer->addHatchGeometry(hatch);
+    }
+
+    for(int i = 0; i < 20; i++) {
+        ContourGeometry::Ptr contour = std::make_shared<ContourGeometry>(1, 2);
+        contour->coords.resize(4, 2);
+
+        const float x = pos(rng), y = pos(rng);
+        contour->coords << x, y, x + 10.f, y, x + 10.f, y + 10.f, x, y;
+
+        layer->addContourGeometry(contour);
+    }
+
+    return layer;
+}
+
+// Geometry with any segment bounding box intersecting the window, found by a linear scan
+std::vector<uint32_t> bruteForce(const Layer &layer, float minX, float minY, float maxX, float maxY)
+{
+    std::vector<uint32_t> result;
+
+    for(size_t i = 0; i < layer.geometry().size(); i++) {
+
+        const LayerGeometry::Ptr &geom = layer.geometry()[i];
+        const Eigen::MatrixXf coords = geom->floatCoords();
+        const Eigen::Index step = geom->getType() == LayerGeometry::HATCH ? 2 : 1;
+
+        for(Eigen::Index j = 0; j + 1 < coords.rows(); j += step) {
+
+            const float x0 = std::min(coords(j, 0), coords(j + 1, 0)), x1 = std::max(coords(j, 0), coords(j + 1, 0));
+            const float y0 = std::min(coords(j, 1), coords(j + 1, 1)), y1 = std::max(coords(j, 1), coords(j + 1, 1));
+
+            if(x0 <= maxX && x1 >= minX && y0 <= maxY && y1 >= minY) {
+                result.push_back(uint32_t(i));
+                break;
+            }
+        }
+    }
+
+    return result;
+}
+
+} // End of Anonymous Namespace
+
+SLM_TEST(spatialIndexQuery)
+{
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<float> pos(-10.f, 110.f);
+    std::uniform_real_distribution<float> size(0.f, 30.f);
+
+    Layer::Ptr layer = makeLayer(1, rng);
+
+    SLM_CHECK(layer->spatialIndex().numSegments() == 200 * 4 + 20 * 3);
+
+    for(int i = 0; i < 200; i++) {
+        const float x = pos(rng), y = pos(rng);
+        const float w = size(rng), h = size(rng);
+
+        SLM_CHECK(layer->queryGeometry(x, y, x + w, y + h) == bruteForce(*layer, x, y, x + w, y + h));
+    }
+
+    // Each segment is reported once
+    const std::vector<SpatialIndex::SegmentRef> segs = layer->spatialIndex().querySegments(20.f, 20.f, 60.f, 60.f);
+    std::vector<uint64_t> keys;
+
+    for(const SpatialIndex::SegmentRef &seg : segs)
+        keys.push_back(uint64_t(seg.geomIdx) << 32 | seg.segIdx);
+
+    std::sort(keys.begin(), keys.end());
+    SLM_CHECK(std::unique(keys.begin(), keys.end()) == keys.end());
+
+    // Windows outside of the grid
+    SLM_CHECK(layer->queryGeometry(200.f, 200.f, 300.f, 300.f).empty());
+    SLM_CHECK(layer->queryGeometry(-300.f, -300.f, -200.f, -200.f).empty());
+}
+
+SLM_TEST(spatialIndexUnboundedWindow)
+{
+    std::mt19937 rng(12);
+    Layer::Ptr layer = makeLayer(1, rng);
+
+    const size_t numGeoms = layer->geometry().size();
+
+    // Windows beyond the range of int in cell coordinates return all geometry
+    SLM_CHECK(layer->queryGeometry(-FLT_MAX, -FLT_MAX, FLT_MAX, FLT_MAX).size() == numGeoms);
+    SLM_CHECK(layer->queryGeometry(-1e30f, -1e30f, 1e30f, 1e30f).size() == numGeoms);
+    SLM_CHECK(layer->spatialIndex().querySegments(-1e30f, -1e30f, 1e30f, 1e30f).size() == layer->spatialIndex().numSegments());
+
+    SLM_CHECK(layer->queryGeometry(1e30f, 1e30f, FLT_MAX, FLT_MAX).empty());
+}
+
+SLM_TEST(spatialIndexCachedLayers)
+{
+    std::mt19937 rng(13);
+
+    LayerCache::Ptr cache = std::make_shared<LayerCache>(2);
+    std::vector<Layer::Ptr> layers;
+
+    for(int i = 0; i < 8; i++) {
+        layers.push_back(makeLayer(i, rng));
+
+        if(i % 2)
+            layers.back()->setCache(cache);
+    }
+
+    buildSpatialIndices(layers, 4);
+
+    SLM_CHECK(cache->numResidentLayers() <= 2);
+
+    for(const Layer::Ptr &layer : layers)
+        SLM_CHECK(layer->queryGeometry(0.f, 0.f, 50.f, 50.f) == bruteForce(*layer, 0.f, 0.f, 50.f, 50.f));
+}
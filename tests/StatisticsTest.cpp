@@ -0,0 +1,102 @@
+#include <algorithm>
+
+#include <App/BuildStatistics.h>
+#include <App/LayerCache.h>
+#include <App/Writer.h>
+
+#include "Test.h"
+
+using namespace slm;
+
+namespace
+{
+
+/*
+ * Layer of a hatch of two vectors 10 long, 5 apart, followed by a 3-4-5 contour, offset in X by the layer index
+ */
+Layer::Ptr makeLayer(uint64_t id, uint64_t z)
+{
+    const float x = float(id);
+
+    Layer::Ptr layer = std::make_shared<Layer>(id, z);
+
+    HatchGeometry::Ptr hatch = std::make_shared<HatchGeometry>(1, 1);
+    hatch->coords.resize(4, 2);
+    hatch->coords << x, 0.f, x + 10.f, 0.f, x + 10.f, 5.f, x, 5.f;
+    layer->addHatchGeometry(hatch);
+
+    ContourGeometry::Ptr contour = std::make_shared<ContourGeometry>(1, 2);
+    contour->coords.resize(3, 2);
+    contour->coords << x, 0.f, x + 3.f, 0.f, x + 3.f, 4.f;
+    layer->addContourGeometry(contour);
+
+    return layer;
+}
+
+} // End of Anonymous Namespace
+
+SLM_TEST(statisticsTotals)
+{
+    std::vector<Layer::Ptr> layers;
+
+    // The build does not start at zero, and is not in order of Z
+    for(uint64_t i = 0; i < 4; i++)
+        layers.push_back(makeLayer(i, 30 + (3 - i) * 30));
+
+    const BuildStatistics stats = BuildStatistics::compute(layers, 2);
+
+    SLM_CHECK(stats.numLayers == 4);
+    SLM_CHECK(stats.numHatchGeoms == 4 && stats.numContourGeoms == 4 && stats.numPntsGeoms == 0);
+    SLM_CHECK(stats.numPoints == 4 * 7);
+    SLM_CHECK(stats.numSegments == 4 * (2 + 2));
+    SLM_CHECK_NEAR(stats.pathLength, 4 * (20.0 + 7.0), 1e-6);
+
+    // The jump within the hatch, and from the end of the hatch to the start of the contour
+    SLM_CHECK_NEAR(stats.jumpLength, 4 * (5.0 + 5.0), 1e-6);
+
+    SLM_CHECK(stats.bbox[0] == 0.f && stats.bbox[1] == 13.f);
+    SLM_CHECK(stats.bbox[2] == 0.f && stats.bbox[3] == 5.f);
+    SLM_CHECK(stats.zMin == 30 && stats.zMax == 120);
+
+    SLM_CHECK(stats.layers.size() == 4);
+    SLM_CHECK(stats.layers[1].layerId == 1 && stats.layers[1].z == 90);
+    SLM_CHECK_NEAR(stats.layers[1].metrics.pathLength, 27.0, 1e-6);
+
+    // The writer's summaries of the build are consistent with the statistics
+    float bbox[4];
+    base::Writer::getBoundingBox(bbox, layers);
+
+    SLM_CHECK(std::equal(bbox, bbox + 4, stats.bbox));
+    SLM_CHECK(std::get<0>(base::Writer::getLayerMinMax(layers)) == 30.f);
+    SLM_CHECK(std::get<1>(base::Writer::getLayerMinMax(layers)) == 120.f);
+}
+
+SLM_TEST(statisticsCachedLayers)
+{
+    LayerCache::Ptr cache = std::make_shared<LayerCache>(1);
+
+    std::vector<Layer::Ptr> layers;
+
+    for(uint64_t i = 0; i < 4; i++) {
+        layers.push_back(makeLayer(i, i * 30));
+        layers.back()->markModified();
+        layers.back()->setCache(cache);
+    }
+
+    // Layers compressed by the cache are expanded in turn, giving the same totals
+    const BuildStatistics stats = BuildStatistics::compute(layers, 2, false);
+
+    SLM_CHECK(stats.numLayers == 4 && stats.layers.empty());
+    SLM_CHECK(stats.numPoints == 4 * 7);
+    SLM_CHECK_NEAR(stats.pathLength, 4 * (20.0 + 7.0), 1e-6);
+    SLM_CHECK(stats.zMin == 0 && stats.zMax == 90);
+    SLM_CHECK(cache->numResidentLayers() <= 1);
+}
+
+SLM_TEST(statisticsEmpty)
+{
+    const BuildStatistics stats = BuildStatistics::compute(std::vector<Layer::Ptr>());
+
+    SLM_CHECK(stats.numLayers == 0 && stats.numPoints == 0);
+    SLM_CHECK(stats.zMin == 0 && stats.zMax == 0);
+}
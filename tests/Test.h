@@ -0,0 +1,52 @@
+#ifndef SLM_TEST_H_HEADER_HAS_BEEN_INCLUDED
+#define SLM_TEST_H_HEADER_HAS_BEEN_INCLUDED
+
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace slm
+{
+
+namespace test
+{
+
+typedef void (*Function)();
+
+struct TestCase
+{
+    std::string name;
+    Function fn;
+};
+
+std::vector<TestCase> & registry();
+
+struct Registrar
+{
+    Registrar(const char *name, Function fn) { registry().push_back(TestCase{name, fn}); }
+};
+
+// Records a failed check of the test currently running
+void fail(const char *file, int line, const std::string &expr);
+
+} // End of Namespace test
+
+} // End of Namespace slm
+
+/**
+ * Defines a test case, which is registered with the test executable. Checks failing within the test are reported
+ * and fail the test, but do not abort it.
+ */
+#define SLM_TEST(name) \
+    static void name(); \
+    static slm::test::Registrar name##Registrar(#name, &name); \
+    static void name()
+
+#define SLM_CHECK(expr) \
+    do { if(!(expr)) slm::test::fail(__FILE__, __LINE__, #expr); } while(0)
+
+#define SLM_CHECK_NEAR(a, b, tol) \
+    do { if(!(std::fabs(double(a) - double(b)) <= double(tol))) slm::test::fail(__FILE__, __LINE__, #a " ~= " #b); } while(0)
+
+#endif // SLM_TEST_H_HEADER_HAS_BEEN_INCLUDED
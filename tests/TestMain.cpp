@@ -0,0 +1,48 @@
+#include "Test.h"
+
+using namespace slm;
+
+static int numFailures = 0;
+
+std::vector<test::TestCase> & test::registry()
+{
+    static std::vector<TestCase> tests;
+    return tests;
+}
+
+void test::fail(const char *file, int line, const std::string &expr)
+{
+    std::cerr << file << ":" << line << ": check failed - " << expr << std::endl;
+    numFailures++;
+}
+
+int main(int argc, char **argv)
+{
+    int numFailedTests = 0;
+    int numRun = 0;
+
+    for(const test::TestCase &tc : test::registry()) {
+
+        // Tests may be selected by name on the command line
+        bool run = argc < 2;
+
+        for(int i = 1; i < argc; i++)
+            run = run || tc.name == argv[i];
+
+        if(!run)
+            continue;
+
+        const int prevFailures = numFailures;
+        tc.fn();
+        numRun++;
+
+        const bool passed = numFailures == prevFailures;
+        numFailedTests += passed ? 0 : 1;
+
+        std::cout << (passed ? "[ PASS ] " : "[ FAIL ] ") << tc.name << std::endl;
+    }
+
+    std::cout << numRun - numFailedTests << " of " << numRun << " tests passed" << std::endl;
+
+    return numFailedTests == 0 && numRun > 0 ? 0 : 1;
+}
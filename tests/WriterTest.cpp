@@ -0,0 +1,230 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+#include <App/Writer.h>
+
+#include "Test.h"
+
+using namespace slm;
+
+namespace
+{
+
+const char *TestPath = "slm_test_writer.bin";
+
+/*
+ * Writer of a simple binary format: for each layer its id, Z and number of geometries, followed by the number of
+ * points and coordinates of each geometry, with the number of layers written as the footer
+ */
+class TestWriter : public base::Writer
+{
+public:
+    TestWriter() : base::Writer(std::string(TestPath)), mSizing(false) {}
+
+    void setLayerSizing(bool state) { mSizing = state; }
+
+protected:
+    bool supportsLayerEncoding() const override { return true; }
+    bool supportsLayerSizing() const override { return mSizing; }
+
+    int writeHeader(const Header &, const std::vector<Model::Ptr> &) override
+    {
+        const char magic[4] = {'T', 'E', 'S', 'T'};
+
+        return (openOutputSink() && outputSink()->write(magic, sizeof(magic)) == 0) ? 0 : -1;
+    }
+
+    int writeFooter() override
+    {
+        const uint64_t numLayers = numLayersWritten();
+        return outputSink()->write(&numLayers, sizeof(numLayers));
+    }
+
+    int encodeLayer(const Layer &layer, std::vector<uint8_t> &buffer) const override
+    {
+        buffer.resize(size_t(layerEncodedSize(layer)));
+        return encodeLayerInto(layer, buffer.data(), buffer.size());
+    }
+
+    int64_t layerEncodedSize(const Layer &layer) const override
+    {
+        int64_t size = 2 * sizeof(uint64_t) + sizeof(uint32_t);
+
+        for(const LayerGeometry::Ptr &geom : layer.geometry())
+            size += sizeof(uint32_t) + 2 * sizeof(float) * geom->coords.rows();
+
+        return size;
+    }
+
+    int encodeLayerInto(const Layer &layer, uint8_t *dst, size_t size) const override
+    {
+        uint8_t *ptr = dst;
+
+        auto put = [&ptr](const void *data, size_t n) {
+            std::memcpy(ptr, data, n);
+            ptr += n;
+        };
+
+        const uint64_t id = layer.getLayerId();
+        const uint64_t z = layer.getZ();
+        const uint32_t numGeoms = uint32_t(layer.geometry().size());
+
+        put(&id, sizeof(id));
+        put(&z, sizeof(z));
+        put(&numGeoms, sizeof(numGeoms));
+
+        for(const LayerGeometry::Ptr &geom : layer.geometry()) {
+
+            const uint32_t numPoints = uint32_t(geom->coords.rows());
+            put(&numPoints, sizeof(numPoints));
+
+            for(Eigen::Index i = 0; i < geom->coords.rows(); i++) {
+                const float pnt[2] = {geom->coords(i, 0), geom->coords(i, 1)};
+                put(pnt, sizeof(pnt));
+            }
+        }
+
+        return size_t(ptr - dst) == size ? 0 : -1;
+    }
+
+private:
+    bool mSizing;
+};
+
+std::vector<Layer::Ptr> makeLayers(size_t numLayers)
+{
+    std::vector<Layer::Ptr> layers;
+
+    for(size_t i = 0; i < numLayers; i++) {
+
+        Layer::Ptr layer = std::make_shared<Layer>(i, i * 30);
+
+        for(size_t j = 0; j <= i % 3; j++) {
+            HatchGeometry::Ptr hatch = std::make_shared<HatchGeometry>(1, 1);
+            hatch->coords.resize(2, 2);
+            hatch->coords << float(i), float(j), float(i) + 1.f, float(j);
+            layer->addHatchGeometry(hatch);
+        }
+
+        layers.push_back(layer);
+    }
+
+    return layers;
+}
+
+std::vector<uint8_t> readFile()
+{
+    std::ifstream file(TestPath, std::ios::binary);
+    return std::vector<uint8_t>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+uint64_t readLayerId(const std::vector<uint8_t> &data, uint64_t offset)
+{
+    uint64_t id = 0;
+
+    if(offset + sizeof(id) <= data.size())
+        std::memcpy(&id, data.data() + offset, sizeof(id));
+
+    return id;
+}
+
+} // End of Anonymous Namespace
+
+SLM_TEST(writerStreaming)
+{
+    const std::vector<Layer::Ptr> layers = makeLayers(10);
+
+    TestWriter writer;
+
+    // Layers are only written between begin() and finish()
+    SLM_CHECK(writer.writeLayer(*layers[0]) == -1);
+    SLM_CHECK(writer.finish() == -1);
+
+    SLM_CHECK(writer.begin(Header(), std::vector<Model::Ptr>()) == 0);
+    SLM_CHECK(writer.isStreaming());
+    SLM_CHECK(writer.begin(Header(), std::vector<Model::Ptr>()) == -1);
+
+    for(const Layer::Ptr &layer : layers)
+        SLM_CHECK(writer.writeLayer(*layer) == 0);
+
+    SLM_CHECK(writer.numLayersWritten() == layers.size());
+    SLM_CHECK(writer.finish() == 0);
+    SLM_CHECK(!writer.isStreaming());
+
+    const std::vector<uint8_t> data = readFile();
+    const std::vector<uint64_t> &offsets = writer.layerOffsets();
+
+    SLM_CHECK(offsets.size() == layers.size());
+    SLM_CHECK(!offsets.empty() && offsets[0] == 4);
+
+    for(size_t i = 0; i < offsets.size(); i++)
+        SLM_CHECK(readLayerId(data, offsets[i]) == layers[i]->getLayerId());
+
+    // The footer follows the last layer
+    SLM_CHECK(data.size() >= sizeof(uint64_t) && readLayerId(data, data.size() - sizeof(uint64_t)) == layers.size());
+
+    std::remove(TestPath);
+}
+
+SLM_TEST(writerLayersIdentical)
+{
+    const std::vector<Layer::Ptr> layers = makeLayers(50);
+
+    std::vector<uint8_t> expected;
+
+    {
+        TestWriter writer;
+        writer.begin(Header(), std::vector<Model::Ptr>());
+
+        for(const Layer::Ptr &layer : layers)
+            writer.writeLayer(*layer);
+
+        SLM_CHECK(writer.finish() == 0);
+        expected = readFile();
+    }
+
+    // The output does not depend on the number of threads encoding the layers, or on mapping the file
+    for(unsigned int numThreads = 1; numThreads <= 4; numThreads *= 2) {
+        for(int mapped = 0; mapped < 2; mapped++) {
+
+            TestWriter writer;
+            writer.setNumThreads(numThreads);
+            writer.setMappedOutput(mapped != 0);
+            writer.setLayerSizing(mapped != 0);
+
+            SLM_CHECK(writer.begin(Header(), std::vector<Model::Ptr>()) == 0);
+            SLM_CHECK(writer.writeLayers(layers) == 0);
+            SLM_CHECK(writer.finish() == 0);
+
+            SLM_CHECK(writer.numLayersWritten() == layers.size());
+            SLM_CHECK(readFile() == expected);
+        }
+    }
+
+    std::remove(TestPath);
+}
+
+SLM_TEST(writerSortLayers)
+{
+    std::vector<Layer::Ptr> layers = makeLayers(10);
+    std::reverse(layers.begin(), layers.end());
+
+    TestWriter writer;
+    writer.setSortLayers(true);
+    writer.write(Header(), std::vector<Model::Ptr>(), layers);
+
+    SLM_CHECK(writer.writeStatus() == 0);
+
+    const std::vector<uint8_t> data = readFile();
+    const std::vector<uint64_t> &offsets = writer.layerOffsets();
+
+    SLM_CHECK(offsets.size() == layers.size());
+
+    for(size_t i = 0; i < offsets.size(); i++)
+        SLM_CHECK(readLayerId(data, offsets[i]) == i);
+
+    std::remove(TestPath);
+}